@@ -0,0 +1,3886 @@
+/*
+ * This file was generated automatically by ExtUtils::ParseXS version 3.45 from the
+ * contents of XS.xs. Do not edit this file, edit XS.xs instead.
+ *
+ *    ANY CHANGES MADE HERE WILL BE LOST!
+ *
+ */
+
+#line 1 "XS.xs"
+
+#define PERL_NO_GET_CONTEXT 1 /* Define at top for more efficiency. */
+
+#include "EXTERN.h"
+#include "perl.h"
+#include "XSUB.h"
+#include "multicall.h"  /* only works in 5.6 and newer */
+#include <stdio.h>      /* For fileno and stdout */
+
+#define NEED_newCONSTSUB
+#define NEED_newRV_noinc
+#define NEED_sv_2pv_flags
+#define NEED_HvNAME_get
+#include "ppport.h"
+
+#include "ptypes.h"
+#include "cache.h"
+#include "sieve.h"
+#define FUNC_gcd_ui 1
+#define FUNC_isqrt 1
+#include "util.h"
+#include "primality.h"
+#include "factor.h"
+#include "lehmer.h"
+#include "lmo.h"
+#include "aks.h"
+#include "primearray.h"
+#include "primegaps.h"
+#include "prime_sums.h"
+#include "pctable.h"
+#include "constants.h"
+
+#if BITS_PER_WORD == 64
+  #if defined(_MSC_VER)
+    #include <stdlib.h>
+    #define strtoull _strtoui64
+    #define strtoll  _strtoi64
+  #endif
+  #define PSTRTOULL(str, end, base) strtoull (str, end, base)
+  #define PSTRTOLL(str, end, base)  strtoll (str, end, base)
+#else
+  #define PSTRTOULL(str, end, base) strtoul (str, end, base)
+  #define PSTRTOLL(str, end, base)  strtol (str, end, base)
+#endif
+#if defined(_MSC_VER) && !defined(strtold)
+  #define strtold strtod
+#endif
+
+#if PERL_REVISION <= 5 && PERL_VERSION <= 6 && BITS_PER_WORD == 64
+ /* Workaround perl 5.6 UVs and bigints */
+ #define my_svuv(sv)  PSTRTOULL(SvPV_nolen(sv), NULL, 10)
+ #define my_sviv(sv)  PSTRTOLL(SvPV_nolen(sv), NULL, 10)
+#elif PERL_REVISION <= 5 && PERL_VERSION < 14 && BITS_PER_WORD == 64
+ /* Workaround RT 49569 in Math::BigInt::FastCalc (pre 5.14.0) */
+ /* TODO: Math::BigInt::Pari has the same problem with negs pre-5.18.0 */
+ #define my_svuv(sv) ( (!SvROK(sv)) ? SvUV(sv) : PSTRTOULL(SvPV_nolen(sv),NULL,10) )
+ #define my_sviv(sv) ( (!SvROK(sv)) ? SvIV(sv) : PSTRTOLL(SvPV_nolen(sv),NULL,10) )
+#else
+ #define my_svuv(sv) SvUV(sv)
+ #define my_sviv(sv) SvIV(sv)
+#endif
+
+/* multicall compatibility stuff */
+#if (PERL_REVISION <= 5 && PERL_VERSION < 7) || !defined(dMULTICALL)
+# define USE_MULTICALL 0   /* Too much trouble to work around it */
+#else
+# define USE_MULTICALL 1
+#endif
+#if PERL_VERSION < 13 || (PERL_VERSION == 13 && PERL_SUBVERSION < 9)
+#  define FIX_MULTICALL_REFCOUNT \
+      if (CvDEPTH(multicall_cv) > 1) SvREFCNT_inc(multicall_cv);
+#else
+#  define FIX_MULTICALL_REFCOUNT
+#endif
+
+#ifndef CvISXSUB
+#  define CvISXSUB(cv) CvXSUB(cv)
+#endif
+
+/* Not right, but close */
+#if !defined cxinc && ( (PERL_VERSION == 8 && PERL_SUBVERSION >= 2) || (PERL_VERSION == 10 && PERL_SUBVERSION <= 1) )
+# define cxinc() Perl_cxinc(aTHX)
+#endif
+
+#if PERL_VERSION < 17 || (PERL_VERSION == 17 && PERL_SUBVERSION < 7)
+#  define SvREFCNT_dec_NN(sv)    SvREFCNT_dec(sv)
+#endif
+
+#if BITS_PER_WORD == 32
+  static const unsigned int uvmax_maxlen = 10;
+  static const unsigned int ivmax_maxlen = 10;
+  static const char uvmax_str[] = "4294967295";
+  static const char ivmax_str[] = "2147483648";
+#else
+  static const unsigned int uvmax_maxlen = 20;
+  static const unsigned int ivmax_maxlen = 19;
+  static const char uvmax_str[] = "18446744073709551615";
+  static const char ivmax_str[] =  "9223372036854775808";
+#endif
+
+#define MY_CXT_KEY "Math::Prime::Util::API_guts"
+typedef struct {
+  SV* const_int[4];   /* -1, 0, 1, 2 */
+  HV* MPUroot;
+  HV* MPUGMP;
+  HV* MPUPP;
+} my_cxt_t;
+
+START_MY_CXT
+
+/* Is this a pedantically valid integer?
+ * Croaks if undefined or invalid.
+ * Returns 0 if it is an object or a string too large for a UV.
+ * Returns 1 if it is good to process by XS.
+ */
+static int _validate_int(pTHX_ SV* n, int negok)
+{
+  const char* maxstr;
+  char* ptr;
+  STRLEN i, len, maxlen;
+  int ret, isbignum = 0, isneg = 0;
+
+  /* TODO: magic, grok_number, etc. */
+  if ((SvFLAGS(n) & (SVf_IOK |
+#if PERL_REVISION >=5 && PERL_VERSION >= 9 && PERL_SUBVERSION >= 4
+                     SVf_ROK |
+#else
+                     SVf_AMAGIC |
+#endif
+                     SVs_GMG )) == SVf_IOK) { /* If defined as number, use it */
+    if (SvIsUV(n) || SvIVX(n) >= 0)  return 1; /* The normal case */
+    if (negok)  return -1;
+    else croak("Parameter '%" SVf "' must be a positive integer", n);
+  }
+  if (sv_isobject(n)) {
+    const char *hvname = HvNAME_get(SvSTASH(SvRV(n)));
+    if (hvname == 0)
+      return 0;
+    if (strEQ(hvname, "Math::BigInt") || strEQ(hvname, "Math::BigFloat") ||
+        strEQ(hvname, "Math::GMPz")   || strEQ(hvname, "Math::GMP") ||
+        strEQ(hvname, "Math::Pari") )
+      isbignum = 1;
+    else
+      return 0;
+  }
+  /* Without being very careful, don't process magic variables here */
+  if (SvGAMAGIC(n) && !isbignum) return 0;
+  if (!SvOK(n))  croak("Parameter must be defined");
+  ptr = SvPV_nomg(n, len);             /* Includes stringifying bigints */
+  if (len == 0 || ptr == 0)  croak("Parameter must be a positive integer");
+  if (ptr[0] == '-' && negok) {
+    isneg = 1; ptr++; len--;           /* Read negative sign */
+  } else if (ptr[0] == '+') {
+    ptr++; len--;                      /* Allow a single plus sign */
+  }
+  if (len == 0 || !isDIGIT(ptr[0]))
+    croak("Parameter '%" SVf "' must be a positive integer", n);
+  while (len > 0 && *ptr == '0')       /* Strip all leading zeros */
+    { ptr++; len--; }
+  if (len > uvmax_maxlen)              /* Huge number, don't even look at it */
+    return 0;
+  for (i = 0; i < len; i++)            /* Ensure all characters are digits */
+    if (!isDIGIT(ptr[i]))
+      croak("Parameter '%" SVf "' must be a positive integer", n);
+  if (isneg == 1)                      /* Negative number (ignore overflow) */
+    return -1;
+  ret    = isneg ? -1           : 1;
+  maxlen = isneg ? ivmax_maxlen : uvmax_maxlen;
+  maxstr = isneg ? ivmax_str    : uvmax_str;
+  if (len < maxlen)                    /* Valid small integer */
+    return ret;
+  for (i = 0; i < maxlen; i++) {       /* Check if in range */
+    if (ptr[i] < maxstr[i]) return ret;
+    if (ptr[i] > maxstr[i]) return 0;
+  }
+  return ret;                          /* value = UV_MAX/UV_MIN.  That's ok */
+}
+
+#define VCALL_ROOT 0x0
+#define VCALL_PP 0x1
+#define VCALL_GMP 0x2
+/* Call a Perl sub to handle work for us. */
+static int _vcallsubn(pTHX_ I32 flags, I32 stashflags, const char* name, int nargs)
+{
+    GV* gv = NULL;
+    dMY_CXT;
+    Size_t namelen = strlen(name);
+    /* If given a GMP function, and GMP enabled, and function exists, use it. */
+    int use_gmp = stashflags & VCALL_GMP && _XS_get_callgmp();
+    assert(!(stashflags & ~(VCALL_PP|VCALL_GMP)));
+    if (use_gmp && hv_exists(MY_CXT.MPUGMP,name,namelen)) {
+      GV ** gvp = (GV**)hv_fetch(MY_CXT.MPUGMP,name,namelen,0);
+      if (gvp) gv = *gvp;
+    }
+    if (!gv && (stashflags & VCALL_PP))
+      perl_require_pv("Math/Prime/Util/PP.pm");
+    if (!gv) {
+      GV ** gvp = (GV**)hv_fetch(stashflags & VCALL_PP? MY_CXT.MPUPP : MY_CXT.MPUroot, name,namelen,0);
+      if (gvp) gv = *gvp;
+    }
+    /* use PL_stack_sp in PUSHMARK macro directly it will be read after
+      the possible mark stack extend */
+    PUSHMARK(PL_stack_sp-nargs);
+    /* no PUTBACK bc we didn't move global SP */
+    return call_sv((SV*)gv, flags);
+}
+#define _vcallsub(func) (void)_vcallsubn(aTHX_ G_SCALAR, VCALL_ROOT, func, items)
+#define _vcallsub_with_gmp(func) (void)_vcallsubn(aTHX_ G_SCALAR, VCALL_GMP|VCALL_PP, func, items)
+#define _vcallsub_with_pp(func) (void)_vcallsubn(aTHX_ G_SCALAR, VCALL_PP, func, items)
+
+/* In my testing, this constant return works fine with threads, but to be
+ * correct (see perlxs) one has to make a context, store separate copies in
+ * each one, then retrieve them from a struct using a hash index.  This
+ * defeats the purpose if only done once. */
+#define RETURN_NPARITY(ret) \
+  do { int r_ = ret; \
+       dMY_CXT; \
+       if (r_ >= -1 && r_ <= 2) { ST(0) = MY_CXT.const_int[r_+1]; XSRETURN(1); } \
+       else                     { XSRETURN_IV(r_);                      } \
+  } while (0)
+#define PUSH_NPARITY(ret) \
+  do { int r_ = ret; \
+       if (r_ >= -1 && r_ <= 2) { PUSHs( MY_CXT.const_int[r_+1] );       } \
+       else                     { PUSHs(sv_2mortal(newSViv(r_))); } \
+  } while (0)
+
+#define OBJECTIFY_RESULT(input, output) \
+  if (!sv_isobject(output)) { \
+    SV* resptr = output; \
+    const char *iname = sv_isobject(input) \
+                      ? HvNAME_get(SvSTASH(SvRV(input))) : 0; \
+    if (iname == 0 || strEQ(iname, "Math::BigInt")) { \
+      _vcallsub("_to_bigint"); /* Turn into bigint */ \
+    } else { /* Return it as: ref(input)->new(result) */ \
+      dSP;  ENTER;  PUSHMARK(SP); \
+      XPUSHs(sv_2mortal(newSVpv(iname, 0)));  XPUSHs(resptr); \
+      PUTBACK;  call_method("new", G_SCALAR);  LEAVE; \
+    } \
+  }
+
+/* Object state kept in a string is changed in place, so the buffer must be
+ * ours alone: not read-only, and not shared copy-on-write with a copy. */
+static char* _state_pv(pTHX_ SV* sv, const char* what)
+{
+  if (SvREADONLY(sv))  croak("%s is read-only", what);
+  return SvPV_force_nolen(sv);
+}
+
+/* PrimeIterator objects are a reference to a scalar.  For native values
+ * the scalar holds this header followed by a list of consecutive primes,
+ * with the current value at list[index].  Stepping past either end of the
+ * list sieves a new batch of primes.  Anything else in the scalar (a plain
+ * number, or a bigint) is a value handled by the Perl methods, and native
+ * values are turned back into a list when a C method next sees them. */
+#define ITER_MAGIC  UVCONST(0x4D505549)  /* "MPUI" */
+#define ITER_BATCH  4096                 /* Approx primes in each sieve */
+typedef struct {
+  UV magic;
+  UV index;
+  UV nprimes;
+} iter_head_t;
+#define ITER_LIST(h)  ((UV*)((h)+1))
+
+static iter_head_t* _iter_fill(pTHX_ SV* sv, UV low, UV high, int at_end)
+{
+  iter_head_t* h;
+  UV maxprimes = 3 + 8*(high/30 - low/30 + 1);
+  (void)SvUPGRADE(sv, SVt_PV);
+  SvGROW(sv, sizeof(iter_head_t) + maxprimes*sizeof(UV));
+  h = (iter_head_t*) SvPVX(sv);
+  h->magic = ITER_MAGIC;
+  h->nprimes = range_primes(low, high, ITER_LIST(h));
+  h->index = (at_end && h->nprimes > 0) ? h->nprimes-1 : 0;
+  SvCUR_set(sv, sizeof(iter_head_t) + h->nprimes*sizeof(UV));
+  SvPOK_only(sv);
+  return h;
+}
+static iter_head_t* _iter_set(pTHX_ SV* sv, UV p)
+{
+  return _iter_fill(aTHX_ sv, p, p, 0);
+}
+/* Returns 0 if the scalar is a bigint. */
+static iter_head_t* _iter_state(pTHX_ SV* self)
+{
+  SV* sv;
+  if (!SvROK(self))  croak("PrimeIterator method called without an object");
+  sv = SvRV(self);
+  if (SvPOK(sv) && SvCUR(sv) >= sizeof(iter_head_t)+sizeof(UV)) {
+    iter_head_t* h = (iter_head_t*) SvPVX(sv);
+    if (h->magic == ITER_MAGIC)
+      return (iter_head_t*) _state_pv(aTHX_ sv, "PrimeIterator object");
+  }
+  if (_validate_int(aTHX_ sv, 0) != 1)
+    return 0;
+  return _iter_set(aTHX_ sv, SvUV(sv));
+}
+/* Bytes to sieve for about ITER_BATCH primes near n. */
+static UV _iter_window(UV n)
+{
+  UV bytes = (UV) (ITER_BATCH * log((double)n + 3.0) / 30.0);
+  return (bytes < 64) ? 64 : (bytes > 16384) ? 16384 : bytes;
+}
+/* Step forward or back, refilling the list.  Returns 0 if we run out of
+ * native primes. */
+static iter_head_t* _iter_next(pTHX_ SV* self, iter_head_t* h)
+{
+  UV p, low, high;
+  if (h->index+1 < h->nprimes)  { h->index++; return h; }
+  p = ITER_LIST(h)[h->index];
+  if (p >= MPU_MAX_PRIME)  return 0;
+  low = p+1;
+  high = (MPU_MAX_PRIME - low < 30*_iter_window(p)) ? MPU_MAX_PRIME
+                                                     : low + 30*_iter_window(p);
+  return _iter_fill(aTHX_ SvRV(self), low, high, 0);
+}
+static iter_head_t* _iter_prev(pTHX_ SV* self, iter_head_t* h)
+{
+  UV p, low, high;
+  if (h->index > 0)  { h->index--; return h; }
+  p = ITER_LIST(h)[h->index];
+  if (p <= 2)  return h;
+  high = p-1;
+  low = (high > 30*_iter_window(p)) ? high - 30*_iter_window(p) : 0;
+  return _iter_fill(aTHX_ SvRV(self), low, high, 1);
+}
+/* Put the plain value back in the scalar and have Perl do the method. */
+#define ITER_CALL_PERL(h, method) \
+  do { \
+    if (h)  sv_setuv(SvRV(ST(0)), ITER_LIST(h)[h->index]); \
+    PUSHMARK(PL_stack_sp-items); \
+    (void)call_pv("Math::Prime::Util::PrimeIterator::" method, G_SCALAR); \
+    return; \
+  } while (0)
+
+/* Packed output writes native UVs straight into a string's buffer rather
+ * than making an SV for each value.  The string is either new or one the
+ * caller gave us, in which case its buffer is reused when big enough. */
+typedef struct {
+  SV* sv;
+  UV* list;
+  UV  n;
+  UV  max;
+} packed_t;
+
+static void _packed_start(pTHX_ packed_t* pk, SV* sv, UV expect)
+{
+  if (expect < 16)  expect = 16;
+  if (sv == 0) {
+    sv = sv_2mortal(newSV(expect * sizeof(UV)));
+  } else {
+    if (SvREADONLY(sv))  croak("Packed output buffer is read-only");
+    if (SvTHINKFIRST(sv) || !SvPOK(sv))  /* refs, shared (COW) strings */
+      sv_setpvn(sv, "", 0);
+    SvGROW(sv, expect * sizeof(UV));
+  }
+  pk->sv = sv;
+  pk->list = (UV*) SvPVX(sv);
+  pk->n = 0;
+  pk->max = SvLEN(sv) / sizeof(UV);
+}
+static void _packed_grow(pTHX_ packed_t* pk)
+{
+  SvGROW(pk->sv, (pk->max + pk->max/2 + 16) * sizeof(UV));
+  pk->list = (UV*) SvPVX(pk->sv);
+  pk->max = SvLEN(pk->sv) / sizeof(UV);
+}
+#define PACKED_PUSH(pk, v) \
+  do { \
+    if ((pk)->n >= (pk)->max)  _packed_grow(aTHX_ pk); \
+    (pk)->list[(pk)->n++] = (v); \
+  } while (0)
+static void _packed_end(pTHX_ packed_t* pk, UV size)
+{
+  SvCUR_set(pk->sv, pk->n * size);
+  SvPOK_only(pk->sv);
+  SvSETMAGIC(pk->sv);    /* a caller's tied or lvalue buffer sees the write */
+}
+/* The packed string if we made it, otherwise the count in the caller's. */
+#define PACKED_RETURN(pk, bufsv) \
+  do { \
+    ST(0) = (bufsv) ? sv_2mortal(newSVuv((pk)->n)) : (pk)->sv; \
+    XSRETURN(1); \
+  } while (0)
+
+/* About how many primes are in [low,high], for sizing output.  Not a bound. */
+static UV _primes_expect(UV low, UV high)
+{
+  UV wheel = 3 + 8*(high/30 - low/30 + 1);
+  UV est = (low < high/2) ? prime_count_upper(high)
+         : (UV) ((double)(high-low) / (log((double)low) - 1.1)) + 64;
+  return (est < wheel) ? est : wheel;
+}
+
+/* State for reading a prime gap file, kept in a Perl string: the header,
+ * the checkpoint table, then the most recently decoded block. */
+typedef struct {
+  prime_gaps_info_t info;
+  UV block;       /* block number + 1 of the decoded primes, 0 if none */
+  UV nprimes;
+} pgf_head_t;
+#define PGF_TABLE(h)   ((unsigned char*)((h)+1))
+#define PGF_PRIMES(h)  ((UV*)(PGF_TABLE(h) + ((h)->info.ncheck*PRIME_GAPS_CHECK_BYTES + sizeof(UV)-1) / sizeof(UV) * sizeof(UV)))
+
+static PerlIO* _pgf_io(pTHX_ SV* svfh)
+{
+  IO* io = sv_2io(svfh);
+  if (io == 0 || IoIFP(io) == 0)  croak("Prime gap file is not open");
+  return IoIFP(io);
+}
+static pgf_head_t* _pgf_state(pTHX_ SV* state)
+{
+  pgf_head_t* h;
+  if (!SvPOK(state) || SvCUR(state) < sizeof(pgf_head_t))
+    croak("Invalid prime gap file state");
+  h = (pgf_head_t*) _state_pv(aTHX_ state, "Prime gap file state");
+  if ((UV)((char*)(PGF_PRIMES(h) + h->info.interval) - (char*)h) != SvCUR(state))
+    croak("Invalid prime gap file state");
+  return h;
+}
+/* Make sure the block holding index is decoded, returning its offset. */
+static UV _pgf_block(pTHX_ pgf_head_t* h, PerlIO* fp, UV index)
+{
+  UV j = index / h->info.interval;
+  if (h->block != j+1) {
+    UV prime, pindex, offset, end, nbytes, want, dummy;
+    unsigned char* buf;
+    if (!prime_gaps_checkpoint(&h->info, PGF_TABLE(h), j, &prime, &pindex, &offset))
+      croak("Corrupt prime gap file checkpoint");
+    end = h->info.table_offset;
+    if (j+1 < h->info.ncheck &&
+        !prime_gaps_checkpoint(&h->info, PGF_TABLE(h), j+1, &dummy, &pindex, &end))
+      croak("Corrupt prime gap file checkpoint");
+    want = h->info.count - j * h->info.interval;
+    if (want > h->info.interval)  want = h->info.interval;
+    if (end < offset || end - offset > want * ((BITS_PER_WORD+6)/7))
+      croak("Corrupt prime gap file checkpoint");
+    nbytes = end - offset;
+    h->block = 0;
+    New(0, buf, nbytes+1, unsigned char);
+    if (PerlIO_seek(fp, (Off_t)offset, SEEK_SET) != 0 ||
+        (nbytes > 0 && PerlIO_read(fp, buf, nbytes) != (SSize_t)nbytes)) {
+      Safefree(buf);
+      croak("Error reading prime gap file");
+    }
+    h->nprimes = prime_gaps_decode(buf, nbytes, prime, PGF_PRIMES(h), want);
+    Safefree(buf);
+    if (h->nprimes != want)  croak("Corrupt prime gap file block %"UVuf, j);
+    h->block = j+1;
+  }
+  return index - j * h->info.interval;
+}
+
+#line 463 "XS.c"
+#ifndef PERL_UNUSED_VAR
+#  define PERL_UNUSED_VAR(var) if (0) var = var
+#endif
+
+#ifndef dVAR
+#  define dVAR		dNOOP
+#endif
+
+
+/* This stuff is not part of the API! You have been warned. */
+#ifndef PERL_VERSION_DECIMAL
+#  define PERL_VERSION_DECIMAL(r,v,s) (r*1000000 + v*1000 + s)
+#endif
+#ifndef PERL_DECIMAL_VERSION
+#  define PERL_DECIMAL_VERSION \
+	  PERL_VERSION_DECIMAL(PERL_REVISION,PERL_VERSION,PERL_SUBVERSION)
+#endif
+#ifndef PERL_VERSION_GE
+#  define PERL_VERSION_GE(r,v,s) \
+	  (PERL_DECIMAL_VERSION >= PERL_VERSION_DECIMAL(r,v,s))
+#endif
+#ifndef PERL_VERSION_LE
+#  define PERL_VERSION_LE(r,v,s) \
+	  (PERL_DECIMAL_VERSION <= PERL_VERSION_DECIMAL(r,v,s))
+#endif
+
+/* XS_INTERNAL is the explicit static-linkage variant of the default
+ * XS macro.
+ *
+ * XS_EXTERNAL is the same as XS_INTERNAL except it does not include
+ * "STATIC", ie. it exports XSUB symbols. You probably don't want that
+ * for anything but the BOOT XSUB.
+ *
+ * See XSUB.h in core!
+ */
+
+
+/* TODO: This might be compatible further back than 5.10.0. */
+#if PERL_VERSION_GE(5, 10, 0) && PERL_VERSION_LE(5, 15, 1)
+#  undef XS_EXTERNAL
+#  undef XS_INTERNAL
+#  if defined(__CYGWIN__) && defined(USE_DYNAMIC_LOADING)
+#    define XS_EXTERNAL(name) __declspec(dllexport) XSPROTO(name)
+#    define XS_INTERNAL(name) STATIC XSPROTO(name)
+#  endif
+#  if defined(__SYMBIAN32__)
+#    define XS_EXTERNAL(name) EXPORT_C XSPROTO(name)
+#    define XS_INTERNAL(name) EXPORT_C STATIC XSPROTO(name)
+#  endif
+#  ifndef XS_EXTERNAL
+#    if defined(HASATTRIBUTE_UNUSED) && !defined(__cplusplus)
+#      define XS_EXTERNAL(name) void name(pTHX_ CV* cv __attribute__unused__)
+#      define XS_INTERNAL(name) STATIC void name(pTHX_ CV* cv __attribute__unused__)
+#    else
+#      ifdef __cplusplus
+#        define XS_EXTERNAL(name) extern "C" XSPROTO(name)
+#        define XS_INTERNAL(name) static XSPROTO(name)
+#      else
+#        define XS_EXTERNAL(name) XSPROTO(name)
+#        define XS_INTERNAL(name) STATIC XSPROTO(name)
+#      endif
+#    endif
+#  endif
+#endif
+
+/* perl >= 5.10.0 && perl <= 5.15.1 */
+
+
+/* The XS_EXTERNAL macro is used for functions that must not be static
+ * like the boot XSUB of a module. If perl didn't have an XS_EXTERNAL
+ * macro defined, the best we can do is assume XS is the same.
+ * Dito for XS_INTERNAL.
+ */
+#ifndef XS_EXTERNAL
+#  define XS_EXTERNAL(name) XS(name)
+#endif
+#ifndef XS_INTERNAL
+#  define XS_INTERNAL(name) XS(name)
+#endif
+
+/* Now, finally, after all this mess, we want an ExtUtils::ParseXS
+ * internal macro that we're free to redefine for varying linkage due
+ * to the EXPORT_XSUB_SYMBOLS XS keyword. This is internal, use
+ * XS_EXTERNAL(name) or XS_INTERNAL(name) in your code if you need to!
+ */
+
+#undef XS_EUPXS
+#if defined(PERL_EUPXS_ALWAYS_EXPORT)
+#  define XS_EUPXS(name) XS_EXTERNAL(name)
+#else
+   /* default to internal */
+#  define XS_EUPXS(name) XS_INTERNAL(name)
+#endif
+
+#ifndef PERL_ARGS_ASSERT_CROAK_XS_USAGE
+#define PERL_ARGS_ASSERT_CROAK_XS_USAGE assert(cv); assert(params)
+
+/* prototype to pass -Wmissing-prototypes */
+STATIC void
+S_croak_xs_usage(const CV *const cv, const char *const params);
+
+STATIC void
+S_croak_xs_usage(const CV *const cv, const char *const params)
+{
+    const GV *const gv = CvGV(cv);
+
+    PERL_ARGS_ASSERT_CROAK_XS_USAGE;
+
+    if (gv) {
+        const char *const gvname = GvNAME(gv);
+        const HV *const stash = GvSTASH(gv);
+        const char *const hvname = stash ? HvNAME(stash) : NULL;
+
+        if (hvname)
+	    Perl_croak_nocontext("Usage: %s::%s(%s)", hvname, gvname, params);
+        else
+	    Perl_croak_nocontext("Usage: %s(%s)", gvname, params);
+    } else {
+        /* Pants. I don't think that it should be possible to get here. */
+	Perl_croak_nocontext("Usage: CODE(0x%" UVxf ")(%s)", PTR2UV(cv), params);
+    }
+}
+#undef  PERL_ARGS_ASSERT_CROAK_XS_USAGE
+
+#define croak_xs_usage        S_croak_xs_usage
+
+#endif
+
+/* NOTE: the prototype of newXSproto() is different in versions of perls,
+ * so we define a portable version of newXSproto()
+ */
+#ifdef newXS_flags
+#define newXSproto_portable(name, c_impl, file, proto) newXS_flags(name, c_impl, file, proto, 0)
+#else
+#define newXSproto_portable(name, c_impl, file, proto) (PL_Sv=(SV*)newXS(name, c_impl, file), sv_setpv(PL_Sv, proto), (CV*)PL_Sv)
+#endif /* !defined(newXS_flags) */
+
+#if PERL_VERSION_LE(5, 21, 5)
+#  define newXS_deffile(a,b) Perl_newXS(aTHX_ a,b,file)
+#else
+#  define newXS_deffile(a,b) Perl_newXS_deffile(aTHX_ a,b)
+#endif
+
+#line 607 "XS.c"
+#if defined(USE_ITHREADS) && defined(MY_CXT_KEY)
+#define XSubPPtmpAAAA 1
+
+
+XS_EUPXS(XS_Math__Prime__Util_CLONE); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_CLONE)
+{
+    dVAR; dXSARGS;
+    PERL_UNUSED_VAR(cv); /* -W */
+    PERL_UNUSED_VAR(items); /* -W */
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 479 "XS.xs"
+  int i;
+#line 623 "XS.c"
+#line 481 "XS.xs"
+  {
+    MY_CXT_CLONE; /* possible declaration */
+    for (i = 0; i <= 3; i++) {
+      MY_CXT.const_int[i] = newSViv(i-1);
+      SvREADONLY_on(MY_CXT.const_int[i]);
+    }
+    MY_CXT.MPUroot = gv_stashpv("Math::Prime::Util", TRUE);
+    MY_CXT.MPUGMP = gv_stashpv("Math::Prime::Util::GMP", TRUE);
+    MY_CXT.MPUPP = gv_stashpv("Math::Prime::Util::PP", TRUE);
+  }
+  return; /* skip implicit PUTBACK, returning @_ to caller, more efficient*/
+#line 636 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+#endif
+
+XS_EUPXS(XS_Math__Prime__Util_END); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_END)
+{
+    dVAR; dXSARGS;
+    PERL_UNUSED_VAR(cv); /* -W */
+    PERL_UNUSED_VAR(items); /* -W */
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 498 "XS.xs"
+  dMY_CXT;
+  int i;
+#line 656 "XS.c"
+#line 501 "XS.xs"
+  for (i = 0; i <= 3; i++) {
+    SV * const sv = MY_CXT.const_int[i];
+    MY_CXT.const_int[i] = NULL;
+    SvREFCNT_dec_NN(sv);
+  } /* stashes are owned by stash tree, no refcount on them in MY_CXT */
+  MY_CXT.MPUroot = NULL;
+  MY_CXT.MPUGMP = NULL;
+  MY_CXT.MPUPP = NULL;
+  _prime_memfreeall();
+  prime_count_table_free();
+  return; /* skip implicit PUTBACK, returning @_ to caller, more efficient*/
+#line 669 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_prime_cache_save); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_prime_cache_save)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "filename");
+    {
+	int	RETVAL;
+	dXSTARG;
+	char*	filename = (char *)SvPV_nolen(ST(0))
+;
+
+	RETVAL = prime_cache_save(filename);
+	XSprePUSH;
+	PUSHi((IV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_prime_cache_load); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_prime_cache_load)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "filename");
+    {
+	UV	RETVAL;
+	dXSTARG;
+	char*	filename = (char *)SvPV_nolen(ST(0))
+;
+
+	RETVAL = prime_cache_load(filename);
+	XSprePUSH;
+	PUSHu((UV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_prime_count_table_save); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_prime_count_table_save)
+{
+    dVAR; dXSARGS;
+    if (items < 3 || items > 4)
+       croak_xs_usage(cv,  "filename, low, high, interval= 30000000");
+    {
+#line 522 "XS.xs"
+    UV ncheck;
+#line 725 "XS.c"
+	int	RETVAL;
+	dXSTARG;
+	char*	filename = (char *)SvPV_nolen(ST(0))
+;
+	UV	low = (UV)SvUV(ST(1))
+;
+	UV	high = (UV)SvUV(ST(2))
+;
+	UV	interval;
+
+	if (items < 4)
+	    interval = 30000000;
+	else {
+	    interval = (UV)SvUV(ST(3))
+;
+	}
+#line 524 "XS.xs"
+    if (interval == 0 || interval % 30 != 0)
+      croak("prime_count_table_save: interval must be a positive multiple of 30");
+    RETVAL = prime_count_table_save(filename, low, high, interval, &ncheck);
+#line 746 "XS.c"
+	XSprePUSH;
+	PUSHi((IV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_prime_count_table_load); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_prime_count_table_load)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "filename");
+    {
+	UV	RETVAL;
+	dXSTARG;
+	char*	filename = (char *)SvPV_nolen(ST(0))
+;
+
+	RETVAL = prime_count_table_load(filename);
+	XSprePUSH;
+	PUSHu((UV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util__get_prime_segment_stats); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util__get_prime_segment_stats)
+{
+    dVAR; dXSARGS;
+    if (items != 0)
+       croak_xs_usage(cv,  "");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 536 "XS.xs"
+    UV allocs, reuses, pooled;
+#line 785 "XS.c"
+#line 538 "XS.xs"
+    get_prime_segment_stats(&allocs, &reuses, &pooled);
+    EXTEND(SP, 3);
+    PUSHs(sv_2mortal(newSVuv(allocs)));
+    PUSHs(sv_2mortal(newSVuv(reuses)));
+    PUSHs(sv_2mortal(newSVuv(pooled)));
+#line 792 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_prime_memfree); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_prime_memfree)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items != 0)
+       croak_xs_usage(cv,  "");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 552 "XS.xs"
+    UV ret;
+#line 811 "XS.c"
+#line 554 "XS.xs"
+    switch (ix) {
+      case 0:  prime_memfree(); goto return_nothing;
+      case 1:  ret = _XS_get_verbose(); break;
+      case 2:  ret = _XS_get_callgmp(); break;
+      case 3:  ret = get_prime_cache(0,0); break;
+      case 4:
+      default: ret = _XS_get_segment_size(); break;
+    }
+    XSRETURN_UV(ret);
+    return_nothing:
+#line 823 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_prime_precalc); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_prime_precalc)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items != 1)
+       croak_xs_usage(cv,  "n");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+	UV	n = (UV)SvUV(ST(0))
+;
+#line 573 "XS.xs"
+    PUTBACK; /* SP is never used again, the 3 next func calls are tailcall
+    friendly since this XSUB has nothing to do after the 3 calls return */
+    switch (ix) {
+      case 0:  prime_precalc(n);    break;
+      case 1:  _XS_set_verbose(n);  break;
+      case 2:  _XS_set_callgmp(n);  break;
+      case 3:  _XS_set_threads(n);  break;
+      default: _XS_set_segment_size(n);  break;
+    }
+    return; /* skip implicit PUTBACK */
+#line 853 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util__XS_get_cache_size); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util__XS_get_cache_size)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "level");
+    {
+	UV	RETVAL;
+	dXSTARG;
+	int	level = (int)SvIV(ST(0))
+;
+
+	RETVAL = _XS_get_cache_size(level);
+	XSprePUSH;
+	PUSHu((UV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util__XS_set_cache_size); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util__XS_set_cache_size)
+{
+    dVAR; dXSARGS;
+    if (items != 2)
+       croak_xs_usage(cv,  "level, size");
+    {
+	int	level = (int)SvIV(ST(0))
+;
+	UV	size = (UV)SvUV(ST(1))
+;
+
+	_XS_set_cache_size(level, size);
+    }
+    XSRETURN_EMPTY;
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_prime_count); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_prime_count)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items < 1)
+       croak_xs_usage(cv,  "svlo, ...");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 598 "XS.xs"
+    int lostatus, histatus;
+    UV lo, hi;
+#line 911 "XS.c"
+	SV*	svlo = ST(0)
+;
+#line 601 "XS.xs"
+    lostatus = _validate_int(aTHX_ svlo, 0);
+    histatus = (items == 1 || _validate_int(aTHX_ ST(1), 0));
+    if (lostatus == 1 && histatus == 1) {
+      UV count = 0;
+      if (items == 1) {
+        lo = 2;
+        hi = my_svuv(svlo);
+      } else {
+        lo = my_svuv(svlo);
+        hi = my_svuv(ST(1));
+      }
+      if (lo <= hi) {
+        if (ix == 2) {
+          count = twin_prime_count(lo, hi);
+        } else if (ix == 3) {
+          UV hisum;
+          if (!sum_primes128(lo, hi, &hisum, &count)) {
+            lostatus = sum_primes(lo, hi, &count);
+          } else if (hisum != 0) {
+            char str[40];
+            sum_primes128_string(hisum, count, str);
+            ST(0) = sv_2mortal(newSVpv(str, 0));
+            PL_stack_sp = PL_stack_base + ax;   /* just the string */
+            (void)_vcallsubn(aTHX_ G_SCALAR, VCALL_ROOT, "_to_bigint", 1);
+            return;
+          }
+        } else if (ix == 4) {
+          int fd = (items < 3) ? fileno(stdout) : my_sviv(ST(2));
+          int format = PRINT_PRIMES_TEXT;
+          if (items >= 4) {
+            const char* fstr = SvPV_nolen(ST(3));
+            if      (strEQ(fstr, "text"))  format = PRINT_PRIMES_TEXT;
+            else if (strEQ(fstr, "le64"))  format = PRINT_PRIMES_LE64;
+            else if (strEQ(fstr, "delta")) format = PRINT_PRIMES_DELTA;
+            else croak("print_primes format must be text, le64, or delta");
+          }
+          print_primes(lo, hi, fd, format);
+          XSRETURN_EMPTY;
+        } else if (ix == 1 || (hi / (hi-lo+1)) > 100) {
+          count = _XS_prime_count(lo, hi);
+        } else {
+          count = _XS_pi(hi);
+          if (lo > 2)
+            count -= _XS_pi(lo-1);
+        }
+      }
+      if (lostatus == 1) XSRETURN_UV(count);
+    }
+    switch (ix) {
+      case 0:
+      case 1: _vcallsubn(aTHX_ GIMME_V, VCALL_ROOT, "_generic_prime_count", items); break;
+      case 2:_vcallsub_with_pp("twin_prime_count");  break;
+      case 3:_vcallsub_with_pp("sum_primes");  break;
+      case 4:
+      default:_vcallsub_with_pp("print_primes");  break;
+    }
+    return; /* skip implicit PUTBACK */
+#line 972 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_prime_count_multi); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_prime_count_multi)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items != 1)
+       croak_xs_usage(cv,  "svx");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 664 "XS.xs"
+    AV* av;
+    UV i, n, *v, *res;
+#line 992 "XS.c"
+	SV*	svx = ST(0)
+;
+#line 667 "XS.xs"
+    if (!SvROK(svx) || SvTYPE(SvRV(svx)) != SVt_PVAV)
+      croak("%s argument must be an array reference", ix ? "nth_prime_multi" : "prime_count_multi");
+    av = (AV*) SvRV(svx);
+    n = av_len(av) + 1;
+    New(0, v, n+1, UV);
+    for (i = 0; i < n; i++) {
+      SV** psv = av_fetch(av, i, 0);
+      if (psv == 0 || _validate_int(aTHX_ *psv, 0) != 1)  break;
+      v[i] = my_svuv(*psv);
+      if (ix == 1 && v[i] >= MPU_MAX_PRIME_IDX)  break;
+    }
+    if (i < n) {   /* Something is out of range.  Let Perl do them. */
+      Safefree(v);
+      _vcallsubn(aTHX_ G_ARRAY, VCALL_PP, ix ? "nth_prime_multi" : "prime_count_multi", items);
+      return;
+    }
+    New(0, res, n+1, UV);
+    if (ix == 0)  prime_count_multi(n, v, res);
+    else          nth_prime_multi(n, v, res);
+    Safefree(v);
+    EXTEND(SP, (IV)n);
+    for (i = 0; i < n; i++)
+      PUSHs(sv_2mortal(newSVuv(res[i])));
+    Safefree(res);
+#line 1020 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util__XS_LMO_pi); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util__XS_LMO_pi)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items != 1)
+       croak_xs_usage(cv,  "n");
+    {
+#line 701 "XS.xs"
+    UV ret;
+#line 1037 "XS.c"
+	UV	RETVAL;
+	dXSTARG;
+	UV	n = (UV)SvUV(ST(0))
+;
+#line 703 "XS.xs"
+    switch (ix) {
+      case 0: ret = _XS_LMO_pi(n); break;
+      case 1: ret = _XS_legendre_pi(n); break;
+      case 2: ret = _XS_meissel_pi(n); break;
+      case 3: ret = _XS_lehmer_pi(n); break;
+      case 4: ret = _XS_LMOS_pi(n); break;
+      default:ret = _XS_LMO_easy_pi(n); break;
+    }
+    RETVAL = ret;
+#line 1052 "XS.c"
+	XSprePUSH;
+	PUSHu((UV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_sieve_primes); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_sieve_primes)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items < 2)
+       croak_xs_usage(cv,  "low, high, ...");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 730 "XS.xs"
+    AV* av = 0;
+    packed_t pk;
+    SV* bufsv = 0;
+#line 1074 "XS.c"
+	UV	low = (UV)SvUV(ST(0))
+;
+	UV	high = (UV)SvUV(ST(1))
+;
+#line 734 "XS.xs"
+    pk.sv = 0;
+    if (ix >= 8) {                  /* Packed into a string, maybe the caller's */
+      UV lo = (low < 7) ? 7 : low, expect = 3;
+      ix -= 8;
+      if (items > 2 && SvOK(ST(2)))  bufsv = ST(2);
+      if (lo <= high)
+        expect += (ix == 4) ? _primes_expect(lo, high)/8 : _primes_expect(lo, high);
+      _packed_start(aTHX_ &pk, bufsv, expect);
+    } else {
+      av = newAV();
+      {
+        SV * retsv = sv_2mortal(newRV_noinc( (SV*) av ));
+        PUSHs(retsv);
+        PUTBACK;
+        SP = NULL; /* never use SP again, poison */
+      }
+    }
+#define PUSH_RESULT(v) \
+    do { if (av) av_push(av, newSVuv(v)); else PACKED_PUSH(&pk, v); } while (0)
+    if ((low <= 2) && (high >= 2) && ix != 4) { PUSH_RESULT( 2 ); }
+    if ((low <= 3) && (high >= 3) && ix != 5) { PUSH_RESULT( 3 ); }
+    if ((low <= 5) && (high >= 5) && ix != 5) { PUSH_RESULT( 5 ); }
+    if (low < 7)  low = 7;
+    if (low <= high) {
+      if (ix == 4) high += 2;
+      if (ix == 0) {                          /* Sieve with primary cache */
+        START_DO_FOR_EACH_PRIME(low, high) {
+          PUSH_RESULT(p);
+        } END_DO_FOR_EACH_PRIME
+      } else if (ix == 1) {                   /* Trial */
+        for (low = next_prime(low-1);
+             low <= high && low != 0;
+             low = next_prime(low) ) {
+          PUSH_RESULT(low);
+        }
+      } else if (ix == 2) {                   /* Erat with private memory */
+        unsigned char* sieve = sieve_erat30(high);
+        START_DO_FOR_EACH_SIEVE_PRIME( sieve, 0, low, high ) {
+           PUSH_RESULT(p);
+        } END_DO_FOR_EACH_SIEVE_PRIME
+        Safefree(sieve);
+      } else if (ix == 3 || ix == 4) {        /* Segment */
+        unsigned char* segment;
+        UV seg_base, seg_low, seg_high, lastp = 0;
+        void* ctx = start_segment_primes(low, high, &segment);
+        while (next_segment_primes(ctx, &seg_base, &seg_low, &seg_high)) {
+          START_DO_FOR_EACH_SIEVE_PRIME( segment, seg_base, seg_low, seg_high )
+            if (ix == 3)            PUSH_RESULT( p );
+            else if (lastp+2 == p)  PUSH_RESULT( lastp );
+            lastp = p;
+          END_DO_FOR_EACH_SIEVE_PRIME
+        }
+        end_segment_primes(ctx);
+      } else if (ix == 5) {                   /* Ramanujan primes */
+        UV s;
+        UV nlo = ramanujan_prime_count_lower(low);
+        UV nhi = ramanujan_prime_count_upper(high);
+        UV* L = n_range_ramanujan_primes(nlo, nhi);
+        for (s = 0; s <= nhi-nlo && L[s] <= high; s++) {
+          if (L[s] >= low)
+            PUSH_RESULT(L[s]);
+        }
+        Safefree(L);
+      }
+    }
+#undef PUSH_RESULT
+    if (av == 0) {
+      _packed_end(aTHX_ &pk, sizeof(UV));
+      PACKED_RETURN(&pk, bufsv);
+    }
+    return; /* skip implicit PUTBACK */
+#line 1151 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_trial_factor); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_trial_factor)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items < 1)
+       croak_xs_usage(cv,  "n, ...");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 818 "XS.xs"
+    UV arg1, arg2;
+    static const UV default_arg1[] =
+       {0,     64000000, 8000000, 4000000, 4000000, 200, 4000000, 1000000};
+     /* Trial, Fermat,   Holf,    SQUFOF,  PRHO,    P+1, Brent,    P-1 */
+#line 1173 "XS.c"
+	UV	n = (UV)SvUV(ST(0))
+;
+#line 823 "XS.xs"
+    if (n == 0)  XSRETURN_UV(0);
+    if (ix == 8) {  /* We don't have an ecm_factor, call PP. */
+      _vcallsubn(aTHX_ GIMME_V, VCALL_PP, "ecm_factor", 1);
+      return;
+    }
+    /* Must read arguments before pushing anything */
+    arg1 = (items >= 2) ? my_svuv(ST(1)) : default_arg1[ix];
+    arg2 = (items >= 3) ? my_svuv(ST(2)) : 0;
+    /* Small factors */
+    while ( (n% 2) == 0 ) {  n /=  2;  XPUSHs(sv_2mortal(newSVuv( 2 ))); }
+    while ( (n% 3) == 0 ) {  n /=  3;  XPUSHs(sv_2mortal(newSVuv( 3 ))); }
+    while ( (n% 5) == 0 ) {  n /=  5;  XPUSHs(sv_2mortal(newSVuv( 5 ))); }
+    if (n == 1) {  /* done */ }
+    else if (_XS_is_prime(n)) { XPUSHs(sv_2mortal(newSVuv( n ))); }
+    else {
+      UV factors[MPU_MAX_FACTORS+1];
+      int i, nfactors = 0;
+      switch (ix) {
+        case 0:  nfactors = trial_factor  (n, factors, arg1);  break;
+        case 1:  nfactors = fermat_factor (n, factors, arg1);  break;
+        case 2:  nfactors = holf_factor   (n, factors, arg1);  break;
+        case 3:  nfactors = squfof_factor (n, factors, arg1);  break;
+        case 4:  nfactors = prho_factor   (n, factors, arg1);  break;
+        case 5:  nfactors = pplus1_factor (n, factors, arg1);  break;
+        case 6:  if (items < 3) arg2 = 1;
+                 nfactors = pbrent_factor (n, factors, arg1, arg2);  break;
+        case 7:
+        default: if (items < 3) arg2 = 10*arg1;
+                 nfactors = pminus1_factor(n, factors, arg1, arg2);  break;
+      }
+      EXTEND(SP, nfactors);
+      for (i = 0; i < nfactors; i++)
+        PUSHs(sv_2mortal(newSVuv( factors[i] )));
+    }
+#line 1211 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_is_strong_pseudoprime); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_is_strong_pseudoprime)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items < 1)
+       croak_xs_usage(cv,  "svn, ...");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 863 "XS.xs"
+    int c, status = 1;
+#line 1230 "XS.c"
+	SV*	svn = ST(0)
+;
+#line 865 "XS.xs"
+    if (items < 2)
+      croak("No bases given to is_strong_pseudoprime");
+    /* Check all arguments */
+    for (c = 0; c < items && status == 1; c++)
+      if (_validate_int(aTHX_ ST(c), 0) != 1)
+        status = 0;
+    if (status == 1) {
+      UV n = my_svuv(svn);
+      int b, ret = 1;
+      if        (n < 4) {                        /* 0,1 composite; 2,3 prime */
+        ret = (n >= 2);
+      } else if (ix == 1) {                      /* Fermat test */
+        for (c = 1; c < items && ret == 1; c++)
+          ret = is_pseudoprime(n, my_svuv(ST(c)));
+      } else if ((n % 2) == 0) {                 /* evens composite */
+         ret = 0;
+      } else {
+        UV bases[32];
+        for (c = 1; c < items && ret == 1; ) {
+          for (b = 0; b < 32 && c < items; c++)
+            bases[b++] = my_svuv(ST(c));
+          ret = miller_rabin(n, bases, b);
+        }
+      }
+      RETURN_NPARITY(ret);
+    }
+    switch (ix) {
+      case 0: _vcallsub_with_gmp("is_strong_pseudoprime"); break;
+      case 1:
+      default:_vcallsub_with_gmp("is_pseudoprime");  break;
+    }
+    return; /* skip implicit PUTBACK */
+#line 1266 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_gcd); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_gcd)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    PERL_UNUSED_VAR(cv); /* -W */
+    PERL_UNUSED_VAR(items); /* -W */
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 908 "XS.xs"
+    int i, status = 1;
+    UV ret, nullv, n;
+#line 1286 "XS.c"
+#line 911 "XS.xs"
+    if (ix == 2 || ix == 3) {
+      UV retindex = 0;
+      int sign, minmax = (ix == 2);
+      if (items == 0) XSRETURN_UNDEF;
+      if (items == 1) XSRETURN(1);
+      status = _validate_int(aTHX_ ST(0), 2);
+      if (status != 0 && items > 1) {
+        sign = status;
+        ret = my_svuv(ST(0));
+        for (i = 1; i < items; i++) {
+          status = _validate_int(aTHX_ ST(i), 2);
+          if (status == 0) break;
+          n = my_svuv(ST(i));
+          if (( (sign == -1 && status == 1) ||
+                (n >= ret && sign == status)
+              ) ? !minmax : minmax ) {
+            sign = status;
+            ret = n;
+            retindex = i;
+          }
+        }
+      }
+      if (status != 0) {
+        ST(0) = ST(retindex);
+        XSRETURN(1);
+      }
+    } else if (ix == 4) {
+      UV lo = 0;
+      IV hi = 0;
+      for (ret = i = 0; i < items; i++) {
+        status = _validate_int(aTHX_ ST(i), 2);
+        if (status == 0) break;
+        n = my_svuv(ST(i));
+        if (status == 1) {
+          hi += (n > (UV_MAX - lo));
+        } else {
+          if (UV_MAX-n == (UV)IV_MAX) { status = 0; break; }  /* IV Overflow */
+          hi -= ((UV_MAX-n) >= lo);
+        }
+        lo += n;
+      }
+      if (status != 0 && hi == -1 && lo > IV_MAX)  XSRETURN_IV((IV)lo);
+      /* If status != 0 then the 128-bit result is:
+       *   result = ( hi << 64) + lo     if hi > 0
+       *   result = (-hi << 64) - lo     if hi < 0
+       * We have to somehow return this as a bigint, which we can't do here.
+       * Sad, because this will now be wasted work and slow. */
+      if (hi != 0) status = 0;  /* Overflow */
+      ret = lo;
+    } else if (ix == 5) {
+      int sign = 1;
+      ret = 1;
+      for (i = 0; i < items; i++) {
+        status = _validate_int(aTHX_ ST(i), 2);
+        if (status == 0) break;
+        n = (status == 1) ? my_svuv(ST(i)) : (UV)-my_sviv(ST(i));
+        if (ret > 0 && n > UV_MAX/ret) { status = 0; break; }
+        sign *= status;
+        ret *= n;
+      }
+      if (sign == -1 && status != 0) {
+        if (ret <= (UV)IV_MAX)  XSRETURN_IV(-(IV)ret);
+        else                    status = 0;
+      }
+    } else {
+      /* For each arg, while valid input, validate+gcd/lcm.  Shortcut stop. */
+      if (ix == 0) { ret = 0; nullv = 1; }
+      else         { ret = (items == 0) ? 0 : 1; nullv = 0; }
+      for (i = 0; i < items && ret != nullv && status != 0; i++) {
+        status = _validate_int(aTHX_ ST(i), 2);
+        if (status == 0)
+          break;
+        n = status * my_svuv(ST(i));  /* n = abs(arg) */
+        if (i == 0) {
+          ret = n;
+        } else {
+          UV gcd = gcd_ui(ret, n);
+          if (ix == 0) {
+            ret = gcd;
+          } else {
+            n /= gcd;
+            if (n <= (UV_MAX / ret) )    ret *= n;
+            else                         status = 0;   /* Overflow */
+          }
+        }
+      }
+    }
+    if (status != 0)
+      XSRETURN_UV(ret);
+    /* For min/max, use string compare if not an object */
+    if ((ix == 2 || ix == 3) && !sv_isobject(ST(0))) {
+      int i, retindex = 0;
+      int minmax = (ix == 2);
+      STRLEN alen, blen;
+      char *aptr, *bptr;
+      aptr = SvPV_nomg(ST(0), alen);
+      (void) strnum_minmax(minmax, 0, 0, aptr, alen);
+      for (i = 1; i < items; i++) {
+        bptr = SvPV_nomg(ST(i), blen);
+        if (strnum_minmax(minmax, aptr, alen, bptr, blen)) {
+          aptr = bptr;
+          alen = blen;
+          retindex = i;
+        }
+      }
+      ST(0) = ST(retindex);
+      XSRETURN(1);
+    }
+    switch (ix) {
+      case 0: _vcallsub_with_gmp("gcd");   break;
+      case 1: _vcallsub_with_gmp("lcm");   break;
+      case 2: _vcallsub_with_gmp("vecmin"); break;
+      case 3: _vcallsub_with_gmp("vecmax"); break;
+      case 4: _vcallsub_with_pp("vecsum");  break;
+      case 5:
+      default:_vcallsub_with_pp("vecprod");  break;
+    }
+    return; /* skip implicit PUTBACK */
+#line 1406 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_vecextract); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_vecextract)
+{
+    dVAR; dXSARGS;
+    if (items != 2)
+       croak_xs_usage(cv,  "x, svm");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 1033 "XS.xs"
+    AV* av;
+    UV i = 0;
+#line 1425 "XS.c"
+	SV*	x = ST(0)
+;
+	SV*	svm = ST(1)
+;
+#line 1036 "XS.xs"
+    if ((!SvROK(x)) || (SvTYPE(SvRV(x)) != SVt_PVAV))
+      croak("vecextract first argument must be an array reference");
+    av = (AV*) SvRV(x);
+    if (SvROK(svm) && SvTYPE(SvRV(svm)) == SVt_PVAV) {
+      AV* avm = (AV*) SvRV(svm);
+      UV mlen = av_len(avm);
+      for (i = 0; i <= mlen; i++) {
+        SV** iv = av_fetch(avm, i, 0);
+        if (iv && SvTYPE(*iv) == SVt_IV) {
+          SV **v = av_fetch(av, SvIV(*iv), 0);
+          if (v) XPUSHs(*v);
+        }
+      }
+    } else if (_validate_int(aTHX_ svm, 0)) {
+      UV mask = my_svuv(svm);
+      while (mask) {
+        if (mask & 1) {
+          SV** v = av_fetch(av, i, 0);
+          if (v) XPUSHs(*v);
+        }
+        i++;
+        mask >>= 1;
+      }
+    } else {
+      _vcallsubn(aTHX_ GIMME_V, VCALL_PP, "vecextract", items);
+      return;
+    }
+#line 1458 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_chinese); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_chinese)
+{
+    dVAR; dXSARGS;
+    PERL_UNUSED_VAR(cv); /* -W */
+    PERL_UNUSED_VAR(items); /* -W */
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 1068 "XS.xs"
+    int i, status;
+    UV* an;
+    UV ret;
+#line 1478 "XS.c"
+#line 1072 "XS.xs"
+    status = 1;
+    New(0, an, 2*items, UV);
+    ret = 0;
+    for (i = 0; i < items; i++) {
+      AV* av;
+      SV** psva;
+      SV** psvn;
+      if (!SvROK(ST(i)) || SvTYPE(SvRV(ST(i))) != SVt_PVAV || av_len((AV*)SvRV(ST(i))) != 1)
+        croak("chinese arguments are two-element array references");
+      av = (AV*) SvRV(ST(i));
+      psva = av_fetch(av, 0, 0);
+      psvn = av_fetch(av, 1, 0);
+      if (psva == 0 || psvn == 0 || _validate_int(aTHX_ *psva, 1) != 1 || !_validate_int(aTHX_ *psvn, 0)) {
+        status = 0;
+        break;
+      }
+      an[i+0]     = my_svuv(*psva);
+      an[i+items] = my_svuv(*psvn);
+    }
+    if (status)
+      ret = chinese(an, an+items, items, &status);
+    Safefree(an);
+    if (status == -1) XSRETURN_UNDEF;
+    if (status)       XSRETURN_UV(ret);
+    _vcallsub_with_pp("chinese");
+    return; /* skip implicit PUTBACK */
+#line 1506 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_lucas_sequence); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_lucas_sequence)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    PERL_UNUSED_VAR(cv); /* -W */
+    PERL_UNUSED_VAR(items); /* -W */
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 1105 "XS.xs"
+    UV U, V, Qk;
+#line 1525 "XS.c"
+#line 1107 "XS.xs"
+    if (ix == 1 || ix == 2) {
+      if (items != 3) croak("lucasu: P, Q, k");
+      if (_validate_int(aTHX_ ST(0), 1) && _validate_int(aTHX_ ST(1), 1) &&
+          _validate_int(aTHX_ ST(2), 0)) {
+        IV P = my_sviv(ST(0));
+        IV Q = my_sviv(ST(1));
+        UV k = my_svuv(ST(2));
+        IV ret;
+        int ok = (ix == 1) ? lucasu(&ret, P, Q, k) : lucasv(&ret, P, Q, k);
+        if (ok) XSRETURN_IV(ret);
+      }
+      _vcallsub_with_gmp( (ix==1) ? "lucasu" : "lucasv" );
+      return;
+    }
+    if (items != 4) croak("lucas_sequence: n, P, Q, k");
+    if (_validate_int(aTHX_ ST(0), 0) && _validate_int(aTHX_ ST(1), 1) &&
+        _validate_int(aTHX_ ST(2), 1) && _validate_int(aTHX_ ST(3), 0)) {
+      lucas_seq(&U, &V, &Qk,
+                my_svuv(ST(0)), my_sviv(ST(1)), my_sviv(ST(2)), my_svuv(ST(3)));
+      PUSHs(sv_2mortal(newSVuv( U )));  /* 4 args in, 3 out, no EXTEND needed */
+      PUSHs(sv_2mortal(newSVuv( V )));
+      PUSHs(sv_2mortal(newSVuv( Qk )));
+    } else {
+      _vcallsubn(aTHX_ GIMME_V, VCALL_PP, "lucas_sequence", items);
+      return;
+    }
+#line 1553 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_is_prime); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_is_prime)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items < 1)
+       croak_xs_usage(cv,  "svn, ...");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 1154 "XS.xs"
+    int status;
+#line 1572 "XS.c"
+	SV*	svn = ST(0)
+;
+#line 1156 "XS.xs"
+    status = _validate_int(aTHX_ svn, 1);
+    if (status != 0) {
+      int ret = 0;
+      if (status == 1 && ix != 16) {
+        UV n = my_svuv(svn);
+        UV a = (items == 1) ? 0 : my_svuv(ST(1));
+        switch (ix) {
+          case 0:
+          case 1:
+          case 2:  ret = _XS_is_prime(n); break;
+          case 3:  ret = BPSW(n); break;
+          case 4:  ret = is_aks_prime(n); break;
+          case 5:  ret = is_lucas_pseudoprime(n, 0); break;
+          case 6:  ret = is_lucas_pseudoprime(n, 1); break;
+          case 7:  ret = is_lucas_pseudoprime(n, 2); break;
+          case 8:  {
+                     /* IV P = 1, Q = -1; */ /* Fibonacci polynomial */
+                     IV P = 0, Q = 0;        /* Q=2,P=least odd s.t. (D|n)=-1 */
+                     if (items == 3) { P = my_sviv(ST(1)); Q = my_sviv(ST(2)); }
+                     else if (items != 1) croak("is_frobenius_pseudoprime takes P,Q");
+                     ret = is_frobenius_pseudoprime(n, P, Q);
+                   } break;
+          case 9:  ret = is_frobenius_underwood_pseudoprime(n); break;
+          case 10: ret = is_frobenius_khashin_pseudoprime(n); break;
+          case 11: ret = is_perrin_pseudoprime(n); break;
+          case 12: ret = is_catalan_pseudoprime(n); break;
+          case 13: ret = is_almost_extra_strong_lucas_pseudoprime
+                         (n, (items == 1) ? 1 : a); break;
+          case 14: ret = is_ramanujan_prime(n); break;
+          case 15:
+          default: ret = is_mersenne_prime(n);
+                   if (ret == -1) status = 0;
+                   break;
+        }
+      } else if (ix == 16) {
+        UV n = (status == 1) ? my_svuv(svn) : (UV) -my_sviv(svn);
+        UV a = (items == 1) ? 0 : my_svuv(ST(1));
+        if (status == -1 && n > (UV)IV_MAX) { status = 0; }
+        if (status == 1 || (status == -1 && (a == 0 || a & 1))) {
+          ret = is_power(n, a);
+          if (status == -1 && a == 0) {
+            ret >>= valuation(ret,2);
+            if (ret == 1) ret = 0;
+          }
+          if (ret && items == 3) {
+            UV root = rootof(n, a ? a : (UV)ret);
+            if (!SvROK(ST(2))) croak("is_power third argument not a scalar reference");
+            if (status == 1) sv_setuv(SvRV(ST(2)),  root);
+            else             sv_setiv(SvRV(ST(2)), -root);
+          }
+        }
+      }
+      if (status != 0) RETURN_NPARITY(ret);
+    }
+    switch (ix) {
+      case 0: _vcallsub_with_gmp("is_prime");       break;
+      case 1: _vcallsub_with_gmp("is_prob_prime");  break;
+      case 2: _vcallsub_with_gmp("is_provable_prime");  break;
+      case 3: _vcallsub_with_gmp("is_bpsw_prime");  break;
+      case 4: _vcallsub_with_gmp("is_aks_prime"); break;
+      case 5: _vcallsub_with_gmp("is_lucas_pseudoprime"); break;
+      case 6: _vcallsub_with_gmp("is_strong_lucas_pseudoprime"); break;
+      case 7: _vcallsub_with_gmp("is_extra_strong_lucas_pseudoprime"); break;
+      case 8: _vcallsub_with_gmp("is_frobenius_pseudoprime"); break;
+      case 9: _vcallsub_with_gmp("is_frobenius_underwood_pseudoprime"); break;
+      case 10:_vcallsub_with_gmp("is_frobenius_khashin_pseudoprime"); break;
+      case 11:_vcallsub_with_gmp("is_perrin_pseudoprime"); break;
+      case 12:_vcallsub_with_gmp("is_catalan_pseudoprime"); break;
+      case 13:_vcallsub_with_gmp("is_almost_extra_strong_lucas_pseudoprime"); break;
+      case 14:_vcallsub_with_gmp("is_ramanujan_prime"); break;
+      case 15:_vcallsub_with_gmp("is_mersenne_prime"); break;
+      case 16:
+      default:if (items != 3 && status != -1) {
+                STRLEN len;
+                char* ptr = SvPV_nomg(svn, len);
+                if (len > 0 && ptr[0] != '-') {
+                  /* items != 3 and not negative */
+                  _vcallsub_with_gmp("is_power");
+                  return;
+                }
+              }
+              _vcallsub_with_pp("is_power");
+              break;
+    }
+    return; /* skip implicit PUTBACK */
+#line 1661 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_next_prime); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_next_prime)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items != 1)
+       croak_xs_usage(cv,  "svn");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+	SV*	svn = ST(0)
+;
+#line 1258 "XS.xs"
+    if (_validate_int(aTHX_ svn, 0)) {
+      UV n = my_svuv(svn);
+      if ( (n >= MPU_MAX_PRIME     && ix == 0) ||
+           (n >= MPU_MAX_PRIME_IDX && (ix==2 || ix==3 || ix==4 || ix==5)) ||
+           (n >= MPU_MAX_TWIN_PRIME_IDX && (ix==6 || ix==7)) ||
+           (n >= MPU_MAX_RMJN_PRIME_IDX && (ix==8)) ) {
+        /* Out of range.  Fall through to Perl. */
+      } else {
+        UV ret;
+        switch (ix) {
+          case 0: ret = next_prime(n);  break;
+          case 1: ret = (n < 3) ? 0 : prev_prime(n);  break;
+          case 2: ret = nth_prime(n); break;
+          case 3: ret = nth_prime_upper(n); break;
+          case 4: ret = nth_prime_lower(n); break;
+          case 5: ret = nth_prime_approx(n); break;
+          case 6: ret = nth_twin_prime(n); break;
+          case 7: ret = nth_twin_prime_approx(n); break;
+          case 8: ret = nth_ramanujan_prime(n); break;
+          case 9: ret = prime_count_upper(n); break;
+          case 10:ret = prime_count_lower(n); break;
+          case 11:ret = prime_count_approx(n); break;
+          case 12:
+          default:ret = twin_prime_count_approx(n); break;
+        }
+        XSRETURN_UV(ret);
+      }
+    }
+    if ((ix == 0 || ix == 1) && _XS_get_callgmp() && PERL_REVISION >= 5 && PERL_VERSION > 8) {
+      _vcallsub_with_gmp( ix ? "prev_prime" : "next_prime");
+      OBJECTIFY_RESULT(svn, ST(0));
+      return;
+    }
+    switch (ix) {
+      case 0:  _vcallsub_with_pp("next_prime");         break;
+      case 1:  _vcallsub_with_pp("prev_prime");         break;
+      case 2:  _vcallsub_with_pp("nth_prime");          break;
+      case 3:  _vcallsub_with_pp("nth_prime_upper");    break;
+      case 4:  _vcallsub_with_pp("nth_prime_lower");    break;
+      case 5:  _vcallsub_with_pp("nth_prime_approx");   break;
+      case 6:  _vcallsub_with_pp("nth_twin_prime");     break;
+      case 7:  _vcallsub_with_pp("nth_twin_prime_approx"); break;
+      case 8:  _vcallsub_with_pp("nth_ramanujan_prime"); break;
+      case 9:  _vcallsub_with_pp("prime_count_upper");  break;
+      case 10: _vcallsub_with_pp("prime_count_lower");  break;
+      case 11: _vcallsub_with_pp("prime_count_approx"); break;
+      case 12:
+      default: _vcallsub_with_pp("twin_prime_count_approx"); break;
+    }
+    return; /* skip implicit PUTBACK */
+#line 1731 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_Pi); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_Pi)
+{
+    dVAR; dXSARGS;
+    if (items < 0 || items > 1)
+       croak_xs_usage(cv,  "digits= 0");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 1311 "XS.xs"
+    NV pival = 3.141592653589793238462643383279502884197169L;
+    UV mantsize = DBL_MANT_DIG / 3.322;   /* Let long doubles go to BF */
+#line 1750 "XS.c"
+	UV	digits;
+
+	if (items < 1)
+	    digits = 0;
+	else {
+	    digits = (UV)SvUV(ST(0))
+;
+	}
+#line 1314 "XS.xs"
+    if (digits == 0) {
+      XSRETURN_NV( pival );
+    } else if (digits <= mantsize && digits <= 40) {
+      char t[40+2];
+      NV pi;
+      (void)sprintf(t, "%.*"NVff, (int)(digits-1), pival);
+#if defined(USE_LONG_DOUBLE) && defined(HAS_LONG_DOUBLE)
+      pi = strtold(t, NULL);
+#else
+      pi = strtod(t, NULL);
+#endif
+      XSRETURN_NV( pi );
+    } else {
+      _vcallsub_with_pp("Pi");
+      return;
+    }
+#line 1776 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util__pidigits); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util__pidigits)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "digits");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+	int	digits = (int)SvIV(ST(0))
+;
+#line 1334 "XS.xs"
+    if (digits == 1) {
+      XSRETURN_UV(3);
+    } else {
+      char *out;
+      IV  *a;
+      IV b, c, d, e, f, g, i,  d4, d3, d2, d1;
+
+      digits++;   /* For rounding */
+      b = d = e = g = i = 0;  f = 10000;
+      c = 14*(digits/4 + 2);
+      New(0, a, c, IV);
+      New(0, out, digits+5+1, char);
+      *out++ = '3';  /* We'll turn "31415..." into "3.1415..." */
+      for (b = 0; b < c; b++)  a[b] = 20000000;
+
+      while ((b = c -= 14) > 0 && i < digits) {
+        d = e = d % f;
+        while (--b > 0) {
+          d = d * b + a[b];
+          g = (b << 1) - 1;
+          a[b] = (d % g) * f;
+          d /= g;
+        }
+        /* sprintf(out+i, "%04d", e+d/f);   i += 4; */
+        d4 = e+d/f;
+        if (d4 > 9999) {
+          d4 -= 10000;
+          out[i-1]++;
+          for (b=i-1; out[b] == '0'+1; b--) { out[b]='0'; out[b-1]++; }
+        }
+        d3 = d4/10;  d2 = d3/10;  d1 = d2/10;
+        out[i++] = '0' + d1;
+        out[i++] = '0' + d2-d1*10;
+        out[i++] = '0' + d3-d2*10;
+        out[i++] = '0' + d4-d3*10;
+      }
+      Safefree(a);
+      if (out[digits-1] >= '5') out[digits-2]++;  /* Round */
+      for (i = digits-2; out[i] == '9'+1; i--)    /* Keep rounding */
+        { out[i] = '0';  out[i-1]++; }
+      digits--;  /* Undo the extra digit we used for rounding */
+      out[digits] = '\0';
+      *out-- = '.';
+      XPUSHs(sv_2mortal(newSVpvn(out, digits+1)));
+      Safefree(out);
+    }
+#line 1841 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_factor); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_factor)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items != 1)
+       croak_xs_usage(cv,  "svn");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 1388 "XS.xs"
+    U32 gimme_v;
+    int status, i, nfactors;
+#line 1861 "XS.c"
+	SV*	svn = ST(0)
+;
+#line 1391 "XS.xs"
+    gimme_v = GIMME_V;
+    status = _validate_int(aTHX_ svn, 0);
+    if (status == 1) {
+      UV factors[MPU_MAX_FACTORS+1];
+      UV exponents[MPU_MAX_FACTORS+1];
+      UV n = my_svuv(svn);
+      if (gimme_v == G_SCALAR) {
+        switch (ix) {
+          case 0:  nfactors = factor(n, factors);        break;
+          case 1:  nfactors = factor_exp(n, factors, 0); break;
+          default: nfactors = divisor_sum(n, 0);         break;
+        }
+        PUSHs(sv_2mortal(newSVuv( nfactors )));
+      } else if (gimme_v == G_ARRAY) {
+        switch (ix) {
+          case 0:  nfactors = factor(n, factors);
+                   EXTEND(SP, nfactors);
+                   for (i = 0; i < nfactors; i++)
+                     PUSHs(sv_2mortal(newSVuv( factors[i] )));
+                   break;
+          case 1:  nfactors = factor_exp(n, factors, exponents);
+                   /* if (n == 1)  XSRETURN_EMPTY; */
+                   EXTEND(SP, nfactors);
+                   for (i = 0; i < nfactors; i++) {
+                     AV* av = newAV();
+                     av_push(av, newSVuv(factors[i]));
+                     av_push(av, newSVuv(exponents[i]));
+                     PUSHs( sv_2mortal(newRV_noinc( (SV*) av )) );
+                   }
+                   break;
+          default: {
+                     UV ndivisors;
+                     UV* divs = _divisor_list(n, &ndivisors);
+                     EXTEND(SP, ndivisors);
+                     for (i = 0; (UV)i < ndivisors; i++)
+                       PUSHs(sv_2mortal(newSVuv( divs[i] )));
+                     Safefree(divs);
+                   }
+                   break;
+        }
+      }
+    } else {
+      switch (ix) {
+        case 0:  _vcallsubn(aTHX_ gimme_v, VCALL_ROOT, "_generic_factor", 1);     break;
+        case 1:  _vcallsubn(aTHX_ gimme_v, VCALL_ROOT, "_generic_factor_exp", 1); break;
+        default: _vcallsubn(aTHX_ gimme_v, VCALL_GMP|VCALL_PP, "divisors", 1);   break;
+      }
+      return; /* skip implicit PUTBACK */
+    }
+#line 1914 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_divisor_sum); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_divisor_sum)
+{
+    dVAR; dXSARGS;
+    if (items < 1)
+       croak_xs_usage(cv,  "svn, ...");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 1444 "XS.xs"
+    SV* svk;
+    int nstatus, kstatus;
+#line 1933 "XS.c"
+	SV*	svn = ST(0)
+;
+#line 1447 "XS.xs"
+    svk = (items > 1) ? ST(1) : 0;
+    nstatus = _validate_int(aTHX_ svn, 0);
+    kstatus = (items == 1 || (SvIOK(svk) && SvIV(svk) >= 0))  ?  1  :  0;
+    /* The above doesn't understand small bigints */
+    if (nstatus == 1 && kstatus == 0 && SvROK(svk) && (sv_isa(svk, "Math::BigInt") || sv_isa(svk, "Math::GMP")))
+      kstatus = _validate_int(aTHX_ svk, 0);
+    if (nstatus == 1 && kstatus == 1) {
+      UV n = my_svuv(svn);
+      UV k = (items > 1) ? my_svuv(svk) : 1;
+      UV sigma = divisor_sum(n, k);
+      if (sigma != 0)  XSRETURN_UV(sigma);   /* sigma 0 means overflow */
+    }
+    _vcallsub_with_gmp("divisor_sum");
+    return; /* skip implicit PUTBACK */
+#line 1951 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_znorder); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_znorder)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items != 2)
+       croak_xs_usage(cv,  "sva, svn");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 1469 "XS.xs"
+    int astatus, nstatus;
+#line 1970 "XS.c"
+	SV*	sva = ST(0)
+;
+	SV*	svn = ST(1)
+;
+#line 1471 "XS.xs"
+    astatus = _validate_int(aTHX_ sva, (ix==1) ? 2 : 0);
+    nstatus = _validate_int(aTHX_ svn, (ix==1) ? 2 : 0);
+    if (astatus != 0 && nstatus != 0) {
+      UV a = my_svuv(sva);
+      UV n = my_svuv(svn);
+      UV ret;
+      switch (ix) {
+        case 0:  ret = znorder(a, n);
+                 break;
+        case 1:  if ( (astatus == 1 && (nstatus == -1 || n > a)) ||
+                      (astatus ==-1 && (nstatus == -1 && n > a)) )
+                   { ret = 0; break; }
+                 if (nstatus == -1)
+                   n = a - n; /* n<0,k<=n:  (-1)^(n-k) * binomial(-k-1,n-k) */
+                 if (astatus == -1) {
+                   ret = binomial( -my_sviv(sva)+n-1, n );
+                   if (ret > 0 && ret <= (UV)IV_MAX)
+                     XSRETURN_IV( (IV)ret * ((n&1) ? -1 : 1) );
+                   goto overflow;
+                 } else {
+                   ret = binomial(a, n);
+                   if (ret == 0)
+                     goto overflow;
+                 }
+                 break;
+        case 2:  ret = jordan_totient(a, n);
+                 if (ret == 0 && n > 1)
+                   goto overflow;
+                 break;
+        case 3:
+        default: ret = legendre_phi(a, n);
+                 break;
+      }
+      if (ret == 0 && ix == 0)  XSRETURN_UNDEF;  /* not defined */
+      XSRETURN_UV(ret);
+    }
+    overflow:
+    switch (ix) {
+      case 0:  _vcallsub_with_pp("znorder");  break;
+      case 1:  _vcallsub_with_pp("binomial");  break;
+      case 2:  _vcallsub_with_pp("jordan_totient");  break;
+      case 3:
+      default: _vcallsub_with_pp("legendre_phi"); break;
+    }
+    return; /* skip implicit PUTBACK */
+#line 2021 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_znlog); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_znlog)
+{
+    dVAR; dXSARGS;
+    if (items != 3)
+       croak_xs_usage(cv,  "sva, svg, svp");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 1520 "XS.xs"
+    int astatus, gstatus, pstatus;
+#line 2039 "XS.c"
+	SV*	sva = ST(0)
+;
+	SV*	svg = ST(1)
+;
+	SV*	svp = ST(2)
+;
+#line 1522 "XS.xs"
+    astatus = _validate_int(aTHX_ sva, 0);
+    gstatus = _validate_int(aTHX_ svg, 0);
+    pstatus = _validate_int(aTHX_ svp, 0);
+    if (astatus == 1 && gstatus == 1 && pstatus == 1) {
+      UV a = my_svuv(sva), g = my_svuv(svg), p = my_svuv(svp);
+      UV ret = znlog(a, g, p);
+      /* TODO: perhaps return p to mean no solution? */
+      if (ret == 0 && a > 1) XSRETURN_UNDEF;
+      XSRETURN_UV(ret);
+    }
+    _vcallsub_with_gmp("znlog");
+    return; /* skip implicit PUTBACK */
+#line 2059 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_kronecker); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_kronecker)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items != 2)
+       croak_xs_usage(cv,  "sva, svb");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 1541 "XS.xs"
+    int astatus, bstatus, abpositive, abnegative;
+#line 2078 "XS.c"
+	SV*	sva = ST(0)
+;
+	SV*	svb = ST(1)
+;
+#line 1543 "XS.xs"
+    astatus = _validate_int(aTHX_ sva, 2);
+    bstatus = _validate_int(aTHX_ svb, 2);
+    if (astatus != 0 && bstatus != 0) {
+      if (ix == 0) {
+        /* Are both a and b positive? */
+        abpositive = astatus == 1 && bstatus == 1;
+        /* Will both fit in IVs?  We should use a bitmask return. */
+        abnegative = !abpositive
+                     && (SvIOK(sva) && !SvIsUV(sva))
+                     && (SvIOK(svb) && !SvIsUV(svb));
+        if (abpositive || abnegative) {
+          UV a = my_svuv(sva);
+          UV b = my_svuv(svb);
+          int k = (abpositive) ? kronecker_uu(a,b) : kronecker_ss(a,b);
+          RETURN_NPARITY(k);
+        }
+      } else if (ix == 1) {
+        UV n = (astatus == -1) ? (UV)(-(my_sviv(sva))) : my_svuv(sva);
+        UV k = (bstatus == -1) ? (UV)(-(my_sviv(svb))) : my_svuv(svb);
+        /* valuation of 0-2 is very common, so return a constant if possible */
+        RETURN_NPARITY( valuation(n, k) );
+      } else {
+        UV a, n, ret = 0;
+        n = (bstatus != -1) ? my_svuv(svb) : (UV)(-(my_sviv(svb)));
+        if (n > 0) {
+          a = (astatus != -1) ? my_svuv(sva)
+                              : n * ((UV)(-my_sviv(sva))/n + 1) + my_sviv(sva);
+          if (a > 0) {
+            if (n == 1) XSRETURN_UV(0);
+            ret = modinverse(a, n);
+          }
+        }
+        if (ret == 0) XSRETURN_UNDEF;
+        XSRETURN_UV(ret);
+      }
+    }
+    switch (ix) {
+      case 0:  _vcallsub_with_gmp("kronecker");  break;
+      case 1:  _vcallsub_with_gmp("valuation"); break;
+      case 2:
+      default: _vcallsub_with_gmp("invmod"); break;
+    }
+    return; /* skip implicit PUTBACK */
+#line 2127 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_gcdext); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_gcdext)
+{
+    dVAR; dXSARGS;
+    if (items != 2)
+       croak_xs_usage(cv,  "sva, svb");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 1590 "XS.xs"
+    int astatus, bstatus;
+#line 2145 "XS.c"
+	SV*	sva = ST(0)
+;
+	SV*	svb = ST(1)
+;
+#line 1592 "XS.xs"
+    astatus = _validate_int(aTHX_ sva, 2);
+    bstatus = _validate_int(aTHX_ svb, 2);
+    /* TODO: These should be built into validate_int */
+    if ( (astatus == 1 && SvIsUV(sva)) || (astatus == -1 && !SvIOK(sva)) )
+      astatus = 0;  /* too large */
+    if ( (bstatus == 1 && SvIsUV(svb)) || (bstatus == -1 && !SvIOK(svb)) )
+      bstatus = 0;  /* too large */
+    if (astatus != 0 && bstatus != 0) {
+      IV u, v, d;
+      IV a = my_sviv(sva);
+      IV b = my_sviv(svb);
+      d = gcdext(a, b, &u, &v, 0, 0);
+      XPUSHs(sv_2mortal(newSViv( u )));
+      XPUSHs(sv_2mortal(newSViv( v )));
+      XPUSHs(sv_2mortal(newSViv( d )));
+    } else {
+      _vcallsubn(aTHX_ GIMME_V, VCALL_PP, "gcdext", items);
+      return; /* skip implicit PUTBACK */
+    }
+#line 2170 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_stirling); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_stirling)
+{
+    dVAR; dXSARGS;
+    if (items < 2 || items > 3)
+       croak_xs_usage(cv,  "n, m, type= 1");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+	UV	n = (UV)SvUV(ST(0))
+;
+	UV	m = (UV)SvUV(ST(1))
+;
+	UV	type;
+
+	if (items < 3)
+	    type = 1;
+	else {
+	    type = (UV)SvUV(ST(2))
+;
+	}
+#line 1615 "XS.xs"
+    if (type != 1 && type != 2)
+      croak("stirling type must be 1 or 2");
+    if (n == m)
+      XSRETURN_UV(1);
+    else if (n == 0 || m == 0 || m > n)
+      XSRETURN_UV(0);
+    else if (m == 1 && type == 2)
+      XSRETURN_UV(1);
+    else if (m == 1 && type == 1) {
+      UV f = factorial(n-1);
+      if (f != 0 && f <= (UV)IV_MAX) XSRETURN_IV( f * ((n&1) ? 1 : -1) );
+    } else if (type == 2) {
+      IV s = stirling2(n, m);
+      if (s != 0) XSRETURN_IV(s);
+    } else if (type == 1) {
+      IV s = stirling1(n, m);
+      if (s != 0) XSRETURN_IV(s);
+    }
+    _vcallsub_with_pp("stirling");
+    return;
+#line 2219 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util__XS_ExponentialIntegral); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util__XS_ExponentialIntegral)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items != 1)
+       croak_xs_usage(cv,  "x");
+    {
+#line 1644 "XS.xs"
+    NV nv, ret;
+#line 2236 "XS.c"
+	NV	RETVAL;
+	dXSTARG;
+	SV*	x = ST(0)
+;
+#line 1646 "XS.xs"
+    nv = SvNV(x);
+    switch (ix) {
+      case 0: ret = (NV) _XS_ExponentialIntegral(nv); break;
+      case 1: ret = (NV) _XS_LogarithmicIntegral(nv); break;
+      case 2: ret = (NV) ld_riemann_zeta(nv); break;
+      case 3: ret = (NV) _XS_RiemannR(nv); break;
+      case 4:
+      default:ret = (NV) lambertw(nv); break;
+    }
+    RETVAL = ret;
+#line 2252 "XS.c"
+	XSprePUSH;
+	PUSHn((NV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_euler_phi); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_euler_phi)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items < 1)
+       croak_xs_usage(cv,  "svlo, ...");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 1664 "XS.xs"
+    int lostatus, histatus;
+#line 2272 "XS.c"
+	SV*	svlo = ST(0)
+;
+#line 1666 "XS.xs"
+    lostatus = _validate_int(aTHX_ svlo, 2);
+    histatus = (items == 1 || _validate_int(aTHX_ ST(1), 0));
+    if (items == 1 && lostatus != 0) {
+      /* input is a single value and in UV/IV range */
+      if (ix == 0) {
+        UV n = (lostatus == -1) ? 0 : my_svuv(svlo);
+        XSRETURN_UV(totient(n));
+      } else {
+        UV n = (lostatus == -1) ? (UV)(-(my_sviv(svlo))) : my_svuv(svlo);
+        RETURN_NPARITY(moebius(n));
+      }
+    } else if (items == 2 && lostatus == 1 && histatus == 1) {
+      /* input is a range and both lo and hi are non-negative */
+      UV lo = my_svuv(svlo);
+      UV hi = my_svuv(ST(1));
+      if (lo <= hi) {
+        UV i;
+        EXTEND(SP, hi-lo+1);
+        if (ix == 0) {
+          UV  arraylo = (lo < 100)  ?  0  :  lo;
+          UV* totients = _totient_range(arraylo, hi);
+          for (i = lo; i <= hi; i++)
+            PUSHs(sv_2mortal(newSVuv(totients[i-arraylo])));
+          Safefree(totients);
+        } else {
+          signed char* mu = _moebius_range(lo, hi);
+          dMY_CXT;
+          for (i = lo; i <= hi; i++)
+            PUSH_NPARITY(mu[i-lo]);
+          Safefree(mu);
+        }
+      }
+    } else {
+      /* Whatever we didn't handle above */
+      U32 gimme_v = GIMME_V;
+      switch (ix) {
+        case 0:  _vcallsubn(aTHX_ gimme_v, VCALL_PP, "euler_phi", items);break;
+        case 1:
+        default: _vcallsubn(aTHX_ gimme_v, VCALL_GMP|VCALL_PP, "moebius", items);  break;
+      }
+      return;
+    }
+#line 2318 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util__euler_phi_packed); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util__euler_phi_packed)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items < 2)
+       croak_xs_usage(cv,  "lo, hi, ...");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 1714 "XS.xs"
+    SV* bufsv;
+    char* res = 0;
+    UV n, size;
+#line 2339 "XS.c"
+	UV	lo = (UV)SvUV(ST(0))
+;
+	UV	hi = (UV)SvUV(ST(1))
+;
+#line 1718 "XS.xs"
+    bufsv = (items > 2) ? ST(2) : 0;
+    n = (lo <= hi) ? hi-lo+1 : 0;
+    size = (ix == 0) ? sizeof(UV) : sizeof(signed char);
+    if (n > 0) {
+      if (ix == 0) {
+        UV  arraylo = (lo < 100)  ?  0  :  lo;
+        UV* totients = _totient_range(arraylo, hi);
+        if (arraylo != lo)
+          memmove(totients, totients + (lo-arraylo), n * sizeof(UV));
+        res = (char*) totients;
+      } else {
+        res = (char*) _moebius_range(lo, hi);
+      }
+    }
+    if (bufsv == 0) {               /* Hand the array to a new string */
+      SV* sv = sv_2mortal(newSV(0));
+      if (res == 0)  sv_setpvn(sv, "", 0);
+      else           sv_usepvn(sv, res, n * size);
+      ST(0) = sv;
+    } else {
+      if (SvREADONLY(bufsv))  croak("Packed output buffer is read-only");
+      sv_setpvn(bufsv, res ? res : "", n * size);
+      if (res)  Safefree(res);
+      ST(0) = sv_2mortal(newSVuv(n));
+    }
+    XSRETURN(1);
+#line 2371 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_carmichael_lambda); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_carmichael_lambda)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items != 1)
+       croak_xs_usage(cv,  "svn");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 1758 "XS.xs"
+    int status;
+#line 2390 "XS.c"
+	SV*	svn = ST(0)
+;
+#line 1760 "XS.xs"
+    status = _validate_int(aTHX_ svn, (ix >= 7) ? 1 : 0);
+    if (status != 0) {
+      UV r, n = my_svuv(svn);
+      switch (ix) {
+        case 0:  XSRETURN_UV(carmichael_lambda(n)); break;
+        case 1:  XSRETURN_IV(mertens(n)); break;
+        case 2:  { UV factors[MPU_MAX_FACTORS+1];
+                   int nfactors = factor(my_svuv(svn), factors);
+                   RETURN_NPARITY( (nfactors & 1) ? -1 : 1 ); }
+                 break;
+        case 3:  XSRETURN_NV(chebyshev_function(n, 0)); break;
+        case 4:  XSRETURN_NV(chebyshev_function(n, 1)); break;
+        case 5:  r = factorial(n);
+                 if (r != 0) XSRETURN_UV(r);
+                 status = 0; break;
+        case 6:  XSRETURN_UV(isqrt(n)); break;
+        case 7:  XSRETURN_UV( (status == -1) ? 1 : exp_mangoldt(n) ); break;
+        case 8:  if (status == -1) n = -(IV)n;
+                 r = znprimroot(n);
+                 if (r == 0 && n != 1)  XSRETURN_UNDEF;  /* No root */
+                 XSRETURN_UV(r);  break;
+        case 9:
+        default: if (status == -1) n = -(IV)n;
+                 XSRETURN_UV(mpu_popcount(n));  break;
+      }
+    }
+    switch (ix) {
+      case 0:  _vcallsub_with_gmp("carmichael_lambda");  break;
+      case 1:  _vcallsub_with_pp("mertens"); break;
+      case 2:  _vcallsub_with_gmp("liouville"); break;
+      case 3:  _vcallsub_with_pp("chebyshev_theta"); break;
+      case 4:  _vcallsub_with_pp("chebyshev_psi"); break;
+      case 5:  _vcallsub_with_pp("factorial"); break;
+      case 6:  _vcallsub_with_pp("sqrtint"); break;
+      case 7:  _vcallsub_with_gmp("exp_mangoldt"); break;
+      case 8:  _vcallsub_with_gmp("znprimroot"); break;
+      case 9:
+      default: { char* ptr;  STRLEN len;  ptr = SvPV_nomg(svn, len);
+                 XSRETURN_UV(mpu_popcount_string(ptr, len)); }
+               break;
+    }
+    return; /* skip implicit PUTBACK */
+#line 2436 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util__validate_num); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util__validate_num)
+{
+    dVAR; dXSARGS;
+    if (items < 1)
+       croak_xs_usage(cv,  "svn, ...");
+    {
+#line 1806 "XS.xs"
+    SV* sv1;
+    SV* sv2;
+#line 2453 "XS.c"
+	bool	RETVAL;
+	SV*	svn = ST(0)
+;
+#line 1809 "XS.xs"
+    /* Internal function.  Emulate the PP version of this:
+     *   $is_valid = _validate_num( $n [, $min [, $max] ] )
+     * Return 0 if we're befuddled by the input.
+     * Otherwise croak if n isn't >= 0 and integer, n < min, or n > max.
+     * Small bigints will be converted to scalars.
+     */
+    RETVAL = FALSE;
+    if (_validate_int(aTHX_ svn, 0)) {
+      if (SvROK(svn)) {  /* Convert small Math::BigInt object into scalar */
+        UV n = my_svuv(svn);
+#if PERL_REVISION <= 5 && PERL_VERSION < 8 && BITS_PER_WORD == 64
+        sv_setpviv(svn, n);
+#else
+        sv_setuv(svn, n);
+#endif
+      }
+      if (items > 1 && ((sv1 = ST(1)), SvOK(sv1))) {
+        UV n = my_svuv(svn);
+        UV min = my_svuv(sv1);
+        if (n < min)
+          croak("Parameter '%"UVuf"' must be >= %"UVuf, n, min);
+        if (items > 2 && ((sv2 = ST(2)), SvOK(sv2))) {
+          UV max = my_svuv(sv2);
+          if (n > max)
+            croak("Parameter '%"UVuf"' must be <= %"UVuf, n, max);
+          MPUassert( items <= 3, "_validate_num takes at most 3 parameters");
+        }
+      }
+      RETVAL = TRUE;
+    }
+#line 2488 "XS.c"
+	ST(0) = boolSV(RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_forprimes); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_forprimes)
+{
+    dVAR; dXSARGS;
+    if (items < 2 || items > 3)
+       croak_xs_usage(cv,  "block, svbeg, svend= 0");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 1846 "XS.xs"
+    GV *gv;
+    HV *stash;
+    SV* svarg;
+    CV *cv;
+    unsigned char* segment;
+    UV beg, end, seg_base, seg_low, seg_high;
+#line 2511 "XS.c"
+	SV*	block = ST(0)
+;
+	SV*	svbeg = ST(1)
+;
+	SV*	svend;
+
+	if (items < 3)
+	    svend = 0;
+	else {
+	    svend = ST(2)
+;
+	}
+#line 1853 "XS.xs"
+    cv = sv_2cv(block, &stash, &gv, 0);
+    if (cv == Nullcv)
+      croak("Not a subroutine reference");
+
+    if (!_validate_int(aTHX_ svbeg, 0) || (items >= 3 && !_validate_int(aTHX_ svend,0))) {
+      _vcallsubn(aTHX_ G_VOID|G_DISCARD, VCALL_ROOT, "_generic_forprimes", items);
+      return;
+    }
+
+    if (items < 3) {
+      beg = 2;
+      end = my_svuv(svbeg);
+    } else {
+      beg = my_svuv(svbeg);
+      end = my_svuv(svend);
+    }
+
+    SAVESPTR(GvSV(PL_defgv));
+    svarg = newSVuv(beg);
+    GvSV(PL_defgv) = svarg;
+    /* Handle early part */
+    while (beg < 6) {
+      beg = (beg <= 2) ? 2 : (beg <= 3) ? 3 : 5;
+      if (beg <= end) {
+        sv_setuv(svarg, beg);
+        PUSHMARK(SP);
+        call_sv((SV*)cv, G_VOID|G_DISCARD);
+      }
+      beg += 1 + (beg > 2);
+    }
+#if USE_MULTICALL
+    if (!CvISXSUB(cv) && beg <= end) {
+      dMULTICALL;
+      I32 gimme = G_VOID;
+      PUSH_MULTICALL(cv);
+      if (
+#if BITS_PER_WORD == 64
+          (beg >= UVCONST(     100000000000000) && end-beg <    100000) ||
+          (beg >= UVCONST(      10000000000000) && end-beg <     40000) ||
+          (beg >= UVCONST(       1000000000000) && end-beg <     17000) ||
+#endif
+          ((end-beg) < 500) ) {     /* MULTICALL next prime */
+        for (beg = next_prime(beg-1); beg <= end && beg != 0; beg = next_prime(beg)) {
+          sv_setuv(svarg, beg);
+          MULTICALL;
+        }
+      } else {                      /* MULTICALL segment sieve */
+        void* ctx = start_segment_primes_serial(beg, end, &segment);
+        while (next_segment_primes(ctx, &seg_base, &seg_low, &seg_high)) {
+          int crossuv = (seg_high > IV_MAX) && !SvIsUV(svarg);
+          START_DO_FOR_EACH_SIEVE_PRIME( segment, seg_base, seg_low, seg_high )
+            /* sv_setuv(svarg, p); */
+            if      (SvTYPE(svarg) != SVt_IV) { sv_setuv(svarg, p);            }
+            else if (crossuv && p > IV_MAX)   { sv_setuv(svarg, p); crossuv=0; }
+            else                              { SvUV_set(svarg, p);            }
+            MULTICALL;
+          END_DO_FOR_EACH_SIEVE_PRIME
+        }
+        end_segment_primes(ctx);
+      }
+      FIX_MULTICALL_REFCOUNT;
+      POP_MULTICALL;
+    }
+    else
+#endif
+    if (beg <= end) {               /* NO-MULTICALL segment sieve */
+      void* ctx = start_segment_primes_serial(beg, end, &segment);
+      while (next_segment_primes(ctx, &seg_base, &seg_low, &seg_high)) {
+        START_DO_FOR_EACH_SIEVE_PRIME( segment, seg_base, seg_low, seg_high )
+          sv_setuv(svarg, p);
+          PUSHMARK(SP);
+          call_sv((SV*)cv, G_VOID|G_DISCARD);
+        END_DO_FOR_EACH_SIEVE_PRIME
+      }
+      end_segment_primes(ctx);
+    }
+    SvREFCNT_dec(svarg);
+#line 2602 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_forprimes_block); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_forprimes_block)
+{
+    dVAR; dXSARGS;
+    if (items < 2 || items > 3)
+       croak_xs_usage(cv,  "block, svbeg, svend= 0");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 1935 "XS.xs"
+    GV *gv;
+    HV *stash;
+    SV* svarg;
+    CV *cv;
+    packed_t pk;
+    unsigned char* segment;
+    UV beg, end, lo, seg_base, seg_low, seg_high;
+#line 2626 "XS.c"
+	SV*	block = ST(0)
+;
+	SV*	svbeg = ST(1)
+;
+	SV*	svend;
+
+	if (items < 3)
+	    svend = 0;
+	else {
+	    svend = ST(2)
+;
+	}
+#line 1943 "XS.xs"
+    cv = sv_2cv(block, &stash, &gv, 0);
+    if (cv == Nullcv)
+      croak("Not a subroutine reference");
+
+    if (!_validate_int(aTHX_ svbeg, 0) || (items >= 3 && !_validate_int(aTHX_ svend,0))) {
+      _vcallsubn(aTHX_ G_VOID|G_DISCARD, VCALL_ROOT, "_generic_forprimes_block", items);
+      return;
+    }
+
+    if (items < 3) {
+      beg = 2;
+      end = my_svuv(svbeg);
+    } else {
+      beg = my_svuv(svbeg);
+      end = my_svuv(svend);
+    }
+    if (beg < 2)  beg = 2;
+
+    SAVESPTR(GvSV(PL_defgv));
+    svarg = newSVpvn("", 0);
+    GvSV(PL_defgv) = svarg;
+    /* Once per segment, $_ holds its primes packed and @_ its bounds. */
+    lo = beg;
+    if (beg <= end) {
+      void* ctx = start_segment_primes_serial((beg < 7) ? 7 : beg, (end < 7) ? 7 : end, &segment);
+      while (next_segment_primes(ctx, &seg_base, &seg_low, &seg_high)) {
+        UV hi = (seg_high < end) ? seg_high : end;
+        _packed_start(aTHX_ &pk, svarg, (seg_low <= hi) ? _primes_expect(seg_low, hi) : 3);
+        if (lo == beg) {
+          if (beg <= 2 && end >= 2)  PACKED_PUSH(&pk, 2);
+          if (beg <= 3 && end >= 3)  PACKED_PUSH(&pk, 3);
+          if (beg <= 5 && end >= 5)  PACKED_PUSH(&pk, 5);
+        }
+        if (seg_low <= hi) {
+          START_DO_FOR_EACH_SIEVE_PRIME( segment, seg_base, seg_low, hi )
+            PACKED_PUSH(&pk, p);
+          END_DO_FOR_EACH_SIEVE_PRIME
+        }
+        _packed_end(aTHX_ &pk, sizeof(UV));
+        ENTER;
+        SAVETMPS;
+        PUSHMARK(SP);
+        XPUSHs(sv_2mortal(newSVuv(lo)));
+        XPUSHs(sv_2mortal(newSVuv(hi)));
+        PUTBACK;
+        call_sv((SV*)cv, G_VOID|G_DISCARD);
+        SPAGAIN;
+        FREETMPS;
+        LEAVE;
+        if (hi >= end)  break;
+        lo = hi+1;
+      }
+      end_segment_primes(ctx);
+    }
+    SvREFCNT_dec(svarg);
+#line 2695 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_forcomposites); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_forcomposites)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items < 2 || items > 3)
+       croak_xs_usage(cv,  "block, svbeg, svend= 0");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 2005 "XS.xs"
+    UV beg, end;
+    GV *gv;
+    HV *stash;
+    SV* svarg;  /* We use svarg to prevent clobbering $_ outside the block */
+    CV *cv;
+#line 2718 "XS.c"
+	SV*	block = ST(0)
+;
+	SV*	svbeg = ST(1)
+;
+	SV*	svend;
+
+	if (items < 3)
+	    svend = 0;
+	else {
+	    svend = ST(2)
+;
+	}
+#line 2011 "XS.xs"
+    cv = sv_2cv(block, &stash, &gv, 0);
+    if (cv == Nullcv)
+      croak("Not a subroutine reference");
+
+    if (!_validate_int(aTHX_ svbeg, 0) || (items >= 3 && !_validate_int(aTHX_ svend,0))) {
+      _vcallsubn(aTHX_ G_VOID|G_DISCARD, VCALL_ROOT, (ix == 0) ? "_generic_forcomposites" : "_generic_foroddcomposites", items);
+      return;
+    }
+
+    if (items < 3) {
+      beg = ix ? 9 : 4;
+      end = my_svuv(svbeg);
+    } else {
+      beg = my_svuv(svbeg);
+      end = my_svuv(svend);
+    }
+
+    SAVESPTR(GvSV(PL_defgv));
+    svarg = newSVuv(0);
+    GvSV(PL_defgv) = svarg;
+#if USE_MULTICALL
+    if (!CvISXSUB(cv) && end >= beg) {
+      unsigned char* segment;
+      UV seg_base, seg_low, seg_high, c, cbeg, cend, prevprime, nextprime;
+      void* ctx;
+      dMULTICALL;
+      I32 gimme = G_VOID;
+      PUSH_MULTICALL(cv);
+      if (beg >= MPU_MAX_PRIME ||
+#if BITS_PER_WORD == 64
+          (beg >= UVCONST(     100000000000000) && end-beg <    120000) ||
+          (beg >= UVCONST(      10000000000000) && end-beg <     50000) ||
+          (beg >= UVCONST(       1000000000000) && end-beg <     20000) ||
+#endif
+          end-beg < 1000 ) {
+        beg = (beg <= 4) ? 3 : beg-1;
+        nextprime = next_prime(beg);
+        while (beg++ < end) {
+          if (beg == nextprime)     nextprime = next_prime(beg);
+          else if (!ix || beg & 1)  { sv_setuv(svarg, beg); MULTICALL; }
+        }
+      } else {
+        if (ix) {
+          if (beg < 9)  beg = 9;
+        } else if (beg <= 4) { /* sieve starts at 7, so handle this here */
+          sv_setuv(svarg, 4);  MULTICALL;
+          beg = 6;
+        }
+        /* Find the two primes that bound their interval. */
+        /* beg must be < max_prime, and end >= max_prime is special. */
+        prevprime = prev_prime(beg);
+        nextprime = (end >= MPU_MAX_PRIME) ? MPU_MAX_PRIME : next_prime(end);
+        ctx = start_segment_primes_serial(beg, nextprime, &segment);
+        while (next_segment_primes(ctx, &seg_base, &seg_low, &seg_high)) {
+          START_DO_FOR_EACH_SIEVE_PRIME( segment, seg_base, seg_low, seg_high )
+            cbeg = prevprime+1;  if (cbeg < beg) cbeg = beg;
+            prevprime = p;
+            cend = prevprime-1;  if (cend > end) cend = end;
+            for (c = cbeg; c <= cend; c++) {
+              if (!ix || c & 1) { sv_setuv(svarg, c);  MULTICALL; }
+            }
+          END_DO_FOR_EACH_SIEVE_PRIME
+        }
+        end_segment_primes(ctx);
+        if (end > nextprime)   /* Complete the case where end > max_prime */
+          while (nextprime++ < end)
+            if (!ix || nextprime & 1)
+              { sv_setuv(svarg, nextprime);  MULTICALL; }
+      }
+      FIX_MULTICALL_REFCOUNT;
+      POP_MULTICALL;
+    }
+    else
+#endif
+    if (beg <= end) {
+      beg = (beg <= 4) ? 3 : beg-1;
+      while (beg++ < end) {
+        if ((!ix || beg&1) && !is_prob_prime(beg)) {
+          sv_setuv(svarg, beg);
+          PUSHMARK(SP);
+          call_sv((SV*)cv, G_VOID|G_DISCARD);
+        }
+      }
+    }
+    SvREFCNT_dec(svarg);
+#line 2817 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_fordivisors); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_fordivisors)
+{
+    dVAR; dXSARGS;
+    if (items != 2)
+       croak_xs_usage(cv,  "block, svn");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 2101 "XS.xs"
+    UV i, n, ndivisors;
+    UV *divs;
+    GV *gv;
+    HV *stash;
+    SV* svarg;  /* We use svarg to prevent clobbering $_ outside the block */
+    CV *cv;
+#line 2840 "XS.c"
+	SV*	block = ST(0)
+;
+	SV*	svn = ST(1)
+;
+#line 2108 "XS.xs"
+    cv = sv_2cv(block, &stash, &gv, 0);
+    if (cv == Nullcv)
+      croak("Not a subroutine reference");
+
+    if (!_validate_int(aTHX_ svn, 0)) {
+      _vcallsubn(aTHX_ G_VOID|G_DISCARD, VCALL_ROOT, "_generic_fordivisors", 2);
+      return;
+    }
+
+    n = my_svuv(svn);
+    divs = _divisor_list(n, &ndivisors);
+
+    SAVESPTR(GvSV(PL_defgv));
+    svarg = newSVuv(0);
+    GvSV(PL_defgv) = svarg;
+#if USE_MULTICALL
+    if (!CvISXSUB(cv)) {
+      dMULTICALL;
+      I32 gimme = G_VOID;
+      PUSH_MULTICALL(cv);
+      for (i = 0; i < ndivisors; i++) {
+        sv_setuv(svarg, divs[i]);
+        MULTICALL;
+      }
+      FIX_MULTICALL_REFCOUNT;
+      POP_MULTICALL;
+    }
+    else
+#endif
+    {
+      for (i = 0; i < ndivisors; i++) {
+        sv_setuv(svarg, divs[i]);
+        PUSHMARK(SP);
+        call_sv((SV*)cv, G_VOID|G_DISCARD);
+      }
+    }
+    SvREFCNT_dec(svarg);
+    Safefree(divs);
+#line 2884 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_forpart); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_forpart)
+{
+    dVAR; dXSARGS;
+    if (items < 2 || items > 3)
+       croak_xs_usage(cv,  "block, svn, svh= 0");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 2151 "XS.xs"
+    UV i, n, amin, amax, nmin, nmax;
+    GV *gv;
+    HV *stash;
+    CV *cv;
+    SV** svals;
+#line 2906 "XS.c"
+	SV*	block = ST(0)
+;
+	SV*	svn = ST(1)
+;
+	SV*	svh;
+
+	if (items < 3)
+	    svh = 0;
+	else {
+	    svh = ST(2)
+;
+	}
+#line 2157 "XS.xs"
+    cv = sv_2cv(block, &stash, &gv, 0);
+    if (cv == Nullcv)
+      croak("Not a subroutine reference");
+    if (!_validate_int(aTHX_ svn, 0)) {
+      _vcallsub_with_pp("forpart");
+      return;
+    }
+    n = my_svuv(svn);
+    if (n > (UV_MAX-2)) croak("forpart argument overflow");
+
+    New(0, svals, n+1, SV*);
+    for (i = 0; i <= n; i++) {
+      svals[i] = newSVuv(i);
+      SvREADONLY_on(svals[i]);
+    }
+
+    amin = 0;  amax = n;  nmin = 0;  nmax = n;
+    if (svh != 0) {
+      HV* rhash;
+      SV** svp;
+      if (!SvROK(svh) || SvTYPE(SvRV(svh)) != SVt_PVHV)
+        croak("forpart second argument must be a hash reference");
+      rhash = (HV*) SvRV(svh);
+      if ((svp = hv_fetchs(rhash, "n", 0)) != NULL)
+        { nmin = my_svuv(*svp);  nmax = nmin; }
+      if ((svp = hv_fetchs(rhash, "amin", 0)) != NULL) amin = my_svuv(*svp);
+      if ((svp = hv_fetchs(rhash, "amax", 0)) != NULL) amax = my_svuv(*svp);
+      if ((svp = hv_fetchs(rhash, "nmin", 0)) != NULL) nmin = my_svuv(*svp);
+      if ((svp = hv_fetchs(rhash, "nmax", 0)) != NULL) nmax = my_svuv(*svp);
+
+      if (amax > n) amax = n;
+      if (nmax > n) nmax = n;
+    }
+
+    if (n==0 || (nmin <= nmax && amin <= amax && nmax > 0 && amax > 0))
+    { /* ZS1 algorithm from Zoghbi and Stojmenovic 1998) */
+      UV *x, m, h;
+      New(0, x, n+2, UV);  /* plus 2 because of n=0 */
+      for (i = 0; i <= n; i++)  x[i] = 1;
+      x[1] = n;
+      m = (n > 0) ? 1 : 0;   /* n=0 => one call with empty list */
+      h = 1;
+
+      if (nmin > 1) {
+        UV max = n - nmin + 1;
+        UV t = n - max;
+        x[h=1] = max;
+        while (t >= max) {  x[++h] = max;  t -= max;  }
+        m = h + (t > 0);
+        if (t > 1)  x[++h] = t;
+      }
+
+      if (x[1] > amax) { /* x[1] is always decreasing, so handle it here */
+        UV t = n - amax;
+        x[h=1] = amax;
+        while (t >= amax) {  x[++h] = amax;  t -= amax;  }
+        m = h + (t > 0);
+        if (t > 1)  x[++h] = t;
+      }
+
+      /* More restriction optimizations would be useful. */
+      while (1) {
+        if (m >= nmin && m <= nmax && x[m] >= amin)
+        { dSP; ENTER; PUSHMARK(SP);
+          EXTEND(SP, m); for (i=1; i <= m; i++) { PUSHs(svals[x[i]]); }
+          PUTBACK; call_sv((SV*)cv, G_VOID|G_DISCARD); LEAVE;
+        }
+        if (x[1] <= 1 || x[1] < amin) break;
+        /* Skip forward if restricted and we can move on. */
+        if (x[2] < amin || (m > nmax && (n-x[1]+x[2]-1)/x[2] >= nmax)) {
+          for (m = 1; n >= (x[1] + m); m++)
+            x[m+1] = 1;
+          h = 1;
+        }
+        if (x[h] == 2) {
+          m++;  x[h--] = 1;
+        } else {
+          UV r = x[h]-1;
+          UV t = m-h+1;
+          x[h] = r;
+          while (t >= r) {  x[++h] = r;  t -= r;  }
+          m = h + (t > 0);
+          if (t > 1)  x[++h] = t;
+        }
+      }
+      Safefree(x);
+    }
+    for (i = 0; i <= n; i++)
+      SvREFCNT_dec(svals[i]);
+    Safefree(svals);
+#line 3010 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_forcomb); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_forcomb)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items < 2 || items > 3)
+       croak_xs_usage(cv,  "block, svn, svk= 0");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 2254 "XS.xs"
+    UV i, n, k, j, m;
+    GV *gv;
+    HV *stash;
+    CV *cv;
+    SV** svals;
+    UV*  cm;
+#line 3034 "XS.c"
+	SV*	block = ST(0)
+;
+	SV*	svn = ST(1)
+;
+	SV*	svk;
+
+	if (items < 3)
+	    svk = 0;
+	else {
+	    svk = ST(2)
+;
+	}
+#line 2261 "XS.xs"
+    cv = sv_2cv(block, &stash, &gv, 0);
+    if (cv == Nullcv)
+      croak("Not a subroutine reference");
+    if (ix == 1 && svk != 0)
+      croak("Too many arguments for forperm");
+
+    if (!_validate_int(aTHX_ svn, 0) || (svk != 0 && !_validate_int(aTHX_ svk, 0))) {
+      _vcallsub_with_pp( (ix == 0) ? "forcomb" : "forperm" );
+      return;
+    }
+
+    n = my_svuv(svn);
+    k = (svk == 0) ? n : my_svuv(svk);
+    if (k > n)
+      return;
+
+    New(0, cm, k+1, UV);
+    cm[0] = UV_MAX;
+    for (i = 0; i < k; i++)
+      cm[i] = k-i;
+
+    New(0, svals, n, SV*);
+    for (i = 0; i < n; i++) {
+      svals[i] = newSVuv(i);
+      SvREADONLY_on(svals[i]);
+    }
+
+    while (1) {
+      { dSP; ENTER; PUSHMARK(SP);                /* Send the values */
+        EXTEND(SP, k);
+        for (i = 0; i < k; i++) { PUSHs(svals[ cm[k-i-1]-1 ]); }
+        PUTBACK; call_sv((SV*)cv, G_VOID|G_DISCARD); LEAVE;
+      }
+      if (ix == 0) {
+        if (cm[0]++ < n)  continue;                /* Increment last value */
+        for (i = 1; i < k && cm[i] >= n-i; i++) ;  /* Find next index to incr */
+        if (i >= k)  break;                        /* Done! */
+        cm[i]++;                                   /* Increment this one */
+        while (i-- > 0)  cm[i] = cm[i+1] + 1;      /* Set the rest */
+      } else {
+        for (j = 1; j < k && cm[j] > cm[j-1]; j++) ;    /* Find last decrease */
+        if (j >= k) break;                              /* Done! */
+        for (m = 0; cm[j] > cm[m]; m++)                 /* Find next greater */
+          ;
+        { UV t = cm[j];  cm[j] = cm[m];  cm[m] = t; }   /* Swap */
+        for (i = j-1, m = 0;  m < i;  i--, m++)         /* Reverse the end */
+          { UV t = cm[i];  cm[i] = cm[m];  cm[m] = t; }
+      }
+    }
+    Safefree(cm);
+    for (i = 0; i < n; i++)
+      SvREFCNT_dec(svals[i]);
+    Safefree(svals);
+#line 3101 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util_vecreduce); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util_vecreduce)
+{
+    dVAR; dXSARGS;
+    if (items < 1)
+       croak_xs_usage(cv,  "block, ...");
+    {
+	SV*	block = ST(0)
+;
+#line 2319 "XS.xs"
+{   /* This is basically reduce from List::Util.  Try to maintain compat. */
+    SV *ret = sv_newmortal();
+    int i;
+    GV *agv,*bgv,*gv;
+    HV *stash;
+    SV **args = &PL_stack_base[ax];
+    CV *cv = sv_2cv(block, &stash, &gv, 0);
+
+    if (cv == Nullcv) croak("Not a subroutine reference");
+    if (items <= 1) XSRETURN_UNDEF;
+
+    agv = gv_fetchpv("a", GV_ADD, SVt_PV);
+    bgv = gv_fetchpv("b", GV_ADD, SVt_PV);
+    SAVESPTR(GvSV(agv));
+    SAVESPTR(GvSV(bgv));
+    GvSV(agv) = ret;
+    SvSetMagicSV(ret, args[1]);
+#ifdef dMULTICALL
+    if (!CvISXSUB(cv)) {
+      dMULTICALL;
+      I32 gimme = G_SCALAR;
+      PUSH_MULTICALL(cv);
+      for (i = 2; i < items; i++) {
+        GvSV(bgv) = args[i];
+        MULTICALL;
+        SvSetMagicSV(ret, *PL_stack_sp);
+      }
+      FIX_MULTICALL_REFCOUNT;
+      POP_MULTICALL;
+    }
+    else
+#endif
+    {
+      for (i = 2; i < items; i++) {
+        dSP;
+        GvSV(bgv) = args[i];
+        PUSHMARK(SP);
+        call_sv((SV*)cv, G_SCALAR);
+        SvSetMagicSV(ret, *PL_stack_sp);
+      }
+    }
+    ST(0) = ret;
+    XSRETURN(1);
+}
+#line 3162 "XS.c"
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util__prime_array_new); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util__prime_array_new)
+{
+    dVAR; dXSARGS;
+    if (items != 2)
+       croak_xs_usage(cv,  "memory, maxindex");
+    {
+#line 2368 "XS.xs"
+    UV size;
+#line 3177 "XS.c"
+	SV *	RETVAL;
+	UV	memory = (UV)SvUV(ST(0))
+;
+	UV	maxindex = (UV)SvUV(ST(1))
+;
+#line 2370 "XS.xs"
+    size = prime_array_size(memory, maxindex);
+    RETVAL = newSV(size);
+    prime_array_init(SvPVX(RETVAL), memory, maxindex);
+    SvCUR_set(RETVAL, size);
+    SvPOK_only(RETVAL);
+#line 3189 "XS.c"
+	RETVAL = sv_2mortal(RETVAL);
+	ST(0) = RETVAL;
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util__prime_array_fetch); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util__prime_array_fetch)
+{
+    dVAR; dXSARGS;
+    if (items != 2)
+       croak_xs_usage(cv,  "svpa, index");
+    {
+	UV	RETVAL;
+	dXSTARG;
+	SV*	svpa = ST(0)
+;
+	UV	index = (UV)SvUV(ST(1))
+;
+#line 2381 "XS.xs"
+    if (!SvPOK(svpa) || !prime_array_valid(SvPVX(svpa), SvCUR(svpa)))
+      croak("Invalid prime array state");
+    RETVAL = prime_array_fetch(_state_pv(aTHX_ svpa, "Prime array state"), index);
+#line 3214 "XS.c"
+	XSprePUSH;
+	PUSHu((UV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util__prime_gaps_save); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util__prime_gaps_save)
+{
+    dVAR; dXSARGS;
+    if (items != 5)
+       croak_xs_usage(cv,  "filename, low, high, interval, first_index");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 2390 "XS.xs"
+    UV count;
+#line 3233 "XS.c"
+	char*	filename = (char *)SvPV_nolen(ST(0))
+;
+	UV	low = (UV)SvUV(ST(1))
+;
+	UV	high = (UV)SvUV(ST(2))
+;
+	UV	interval = (UV)SvUV(ST(3))
+;
+	UV	first_index = (UV)SvUV(ST(4))
+;
+#line 2392 "XS.xs"
+    if (interval == 0 || interval > PRIME_GAPS_MAX_INTERVAL)
+      croak("Prime gap file interval must be from 1 to %lu", (unsigned long)PRIME_GAPS_MAX_INTERVAL);
+    if (!prime_gaps_save(filename, low, high, interval, first_index, &count))
+      XSRETURN_UNDEF;
+    XSRETURN_UV(count);
+#line 3250 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util__prime_gaps_open); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util__prime_gaps_open)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "svfh");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 2401 "XS.xs"
+    PerlIO* fp;
+    Off_t filesize;
+    unsigned char buf[PRIME_GAPS_HEADER];
+    prime_gaps_info_t info;
+    pgf_head_t* h;
+    UV tbytes, size;
+    SV* state;
+#line 3274 "XS.c"
+	SV*	svfh = ST(0)
+;
+#line 2409 "XS.xs"
+    fp = _pgf_io(aTHX_ svfh);
+    if (PerlIO_seek(fp, 0, SEEK_END) != 0 || (filesize = PerlIO_tell(fp)) < PRIME_GAPS_HEADER ||
+        PerlIO_seek(fp, 0, SEEK_SET) != 0 ||
+        PerlIO_read(fp, buf, PRIME_GAPS_HEADER) != PRIME_GAPS_HEADER ||
+        !prime_gaps_header(buf, (UV)filesize, &info))
+      XSRETURN_UNDEF;
+    tbytes = info.ncheck * PRIME_GAPS_CHECK_BYTES;
+    size = sizeof(pgf_head_t) + (tbytes + sizeof(UV)-1) / sizeof(UV) * sizeof(UV)
+         + info.interval * sizeof(UV);
+    state = sv_2mortal(newSV(size));
+    h = (pgf_head_t*) SvPVX(state);
+    h->info = info;
+    h->block = h->nprimes = 0;
+    if (PerlIO_seek(fp, (Off_t)info.table_offset, SEEK_SET) != 0 ||
+        (tbytes > 0 && PerlIO_read(fp, PGF_TABLE(h), tbytes) != (SSize_t)tbytes))
+      XSRETURN_UNDEF;
+    SvCUR_set(state, size);
+    SvPOK_only(state);
+    ST(0) = state;
+    XSRETURN(1);
+#line 3298 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util__prime_gaps_info); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util__prime_gaps_info)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "state");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 2433 "XS.xs"
+    pgf_head_t* h;
+#line 3316 "XS.c"
+	SV*	state = ST(0)
+;
+#line 2435 "XS.xs"
+    h = _pgf_state(aTHX_ state);
+    EXTEND(SP, 5);
+    PUSHs(sv_2mortal(newSVuv(h->info.low)));
+    PUSHs(sv_2mortal(newSVuv(h->info.high)));
+    PUSHs(sv_2mortal(newSVuv(h->info.count)));
+    PUSHs(sv_2mortal(newSVuv(h->info.first_index)));
+    PUSHs(sv_2mortal(newSVuv(h->info.interval)));
+#line 3327 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util__prime_gaps_fetch); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util__prime_gaps_fetch)
+{
+    dVAR; dXSARGS;
+    if (items != 3)
+       croak_xs_usage(cv,  "state, svfh, index");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 2446 "XS.xs"
+    pgf_head_t* h;
+#line 3345 "XS.c"
+	SV*	state = ST(0)
+;
+	SV*	svfh = ST(1)
+;
+	UV	index = (UV)SvUV(ST(2))
+;
+#line 2448 "XS.xs"
+    h = _pgf_state(aTHX_ state);
+    if (index >= h->info.count)  XSRETURN_UNDEF;
+    XSRETURN_UV(PGF_PRIMES(h)[_pgf_block(aTHX_ h, _pgf_io(aTHX_ svfh), index)]);
+#line 3356 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util__prime_gaps_packed); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util__prime_gaps_packed)
+{
+    dVAR; dXSARGS;
+    if (items != 4)
+       croak_xs_usage(cv,  "state, svfh, index, n");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 2455 "XS.xs"
+    pgf_head_t* h;
+    PerlIO* fp;
+    packed_t pk;
+#line 3376 "XS.c"
+	SV*	state = ST(0)
+;
+	SV*	svfh = ST(1)
+;
+	UV	index = (UV)SvUV(ST(2))
+;
+	UV	n = (UV)SvUV(ST(3))
+;
+#line 2459 "XS.xs"
+    h = _pgf_state(aTHX_ state);
+    fp = _pgf_io(aTHX_ svfh);
+    if (index > h->info.count)  index = h->info.count;
+    if (n > h->info.count - index)  n = h->info.count - index;
+    _packed_start(aTHX_ &pk, 0, n);   /* room for all n */
+    while (n > 0) {
+      UV off = _pgf_block(aTHX_ h, fp, index);
+      UV take = h->nprimes - off;
+      if (take > n)  take = n;
+      memcpy(pk.list + pk.n, PGF_PRIMES(h) + off, take * sizeof(UV));
+      pk.n += take;
+      index += take;
+      n -= take;
+    }
+    _packed_end(aTHX_ &pk, sizeof(UV));
+    ST(0) = pk.sv;
+    XSRETURN(1);
+#line 3403 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util__PrimeIterator_value); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util__PrimeIterator_value)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 2485 "XS.xs"
+    iter_head_t* h;
+    UV p;
+#line 3423 "XS.c"
+	SV*	self = ST(0)
+;
+#line 2488 "XS.xs"
+    h = _iter_state(aTHX_ self);
+    if (h == 0) {
+      switch (ix) {
+        case 0:  ITER_CALL_PERL(h, "_pp_value");  break;
+        case 1:  ITER_CALL_PERL(h, "_pp_peek");  break;
+        default: ITER_CALL_PERL(h, "_pp_iterate");  break;
+      }
+    }
+    p = ITER_LIST(h)[h->index];
+    if (ix == 1) {
+      if (h->index+1 < h->nprimes)  XSRETURN_UV(ITER_LIST(h)[h->index+1]);
+      if (p >= MPU_MAX_PRIME)  ITER_CALL_PERL(h, "_pp_peek");
+      XSRETURN_UV(next_prime(p));
+    }
+    if (ix == 2 && _iter_next(aTHX_ self, h) == 0)
+      ITER_CALL_PERL(h, "_pp_iterate");
+    XSRETURN_UV(p);
+#line 3444 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util__PrimeIterator_next); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util__PrimeIterator_next)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 2511 "XS.xs"
+    iter_head_t* h;
+#line 3463 "XS.c"
+	SV*	self = ST(0)
+;
+#line 2513 "XS.xs"
+    h = _iter_state(aTHX_ self);
+    if (ix == 0) {
+      if (h == 0 || _iter_next(aTHX_ self, h) == 0)
+        ITER_CALL_PERL(h, "_pp_next");
+    } else {
+      if (h == 0)
+        ITER_CALL_PERL(h, "_pp_prev");
+      (void)_iter_prev(aTHX_ self, h);
+    }
+    XSRETURN(1);   /* self */
+#line 3477 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_Math__Prime__Util__PrimeIterator_rewind); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_Math__Prime__Util__PrimeIterator_rewind)
+{
+    dVAR; dXSARGS;
+    dXSI32;
+    if (items < 1 || items > 2)
+       croak_xs_usage(cv,  "self, svn= 0");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 2530 "XS.xs"
+    iter_head_t* h = 0;
+    UV n;
+#line 3497 "XS.c"
+	SV*	self = ST(0)
+;
+	SV*	svn;
+
+	if (items < 2)
+	    svn = 0;
+	else {
+	    svn = ST(1)
+;
+	}
+#line 2533 "XS.xs"
+    if (!SvROK(self))  croak("PrimeIterator method called without an object");
+    if (ix == 1 && svn == 0)  croak("seek_to_value needs a value");
+    if (ix == 2 && svn == 0)  croak("seek_to_i needs an index");
+    if (svn != 0 && SvOK(svn) && _validate_int(aTHX_ svn, 0) != 1) {
+      switch (ix) {
+        case 0:  ITER_CALL_PERL(h, "_pp_rewind");  break;
+        case 1:  ITER_CALL_PERL(h, "_pp_seek_to_value");  break;
+        default: ITER_CALL_PERL(h, "_pp_seek_to_i");  break;
+      }
+    }
+    n = (svn == 0 || !SvOK(svn)) ? 2 : SvUV(svn);
+    if (ix == 2) {
+      if (n > MPU_MAX_PRIME_IDX)  ITER_CALL_PERL(h, "_pp_seek_to_i");
+      n = (n == 0) ? 2 : nth_prime(n);
+    } else {
+      if (n > MPU_MAX_PRIME)  ITER_CALL_PERL(h, "_pp_rewind");
+      n = (n <= 2) ? 2 : next_prime(n-1);
+    }
+    (void)_iter_set(aTHX_ SvRV(self), n);
+    XSRETURN(1);   /* self */
+#line 3529 "XS.c"
+	PUTBACK;
+	return;
+    }
+}
+
+#ifdef __cplusplus
+extern "C"
+#endif
+XS_EXTERNAL(boot_Math__Prime__Util); /* prototype to pass -Wmissing-prototypes */
+XS_EXTERNAL(boot_Math__Prime__Util)
+{
+#if PERL_VERSION_LE(5, 21, 5)
+    dVAR; dXSARGS;
+#else
+    dVAR; dXSBOOTARGSXSAPIVERCHK;
+#endif
+#if PERL_VERSION_LE(5, 8, 999) /* PERL_VERSION_LT is 5.33+ */
+    char* file = __FILE__;
+#else
+    const char* file = __FILE__;
+#endif
+
+    PERL_UNUSED_VAR(file);
+
+    PERL_UNUSED_VAR(cv); /* -W */
+    PERL_UNUSED_VAR(items); /* -W */
+#if PERL_VERSION_LE(5, 21, 5)
+    XS_VERSION_BOOTCHECK;
+#  ifdef XS_APIVERSION_BOOTCHECK
+    XS_APIVERSION_BOOTCHECK;
+#  endif
+#endif
+
+    {
+        CV * cv;
+
+#if XSubPPtmpAAAA
+        (void)newXSproto_portable("Math::Prime::Util::CLONE", XS_Math__Prime__Util_CLONE, file, ";@");
+#endif
+        (void)newXSproto_portable("Math::Prime::Util::END", XS_Math__Prime__Util_END, file, ";@");
+        (void)newXSproto_portable("Math::Prime::Util::prime_cache_save", XS_Math__Prime__Util_prime_cache_save, file, "$");
+        (void)newXSproto_portable("Math::Prime::Util::prime_cache_load", XS_Math__Prime__Util_prime_cache_load, file, "$");
+        (void)newXSproto_portable("Math::Prime::Util::prime_count_table_save", XS_Math__Prime__Util_prime_count_table_save, file, "$$$;$");
+        (void)newXSproto_portable("Math::Prime::Util::prime_count_table_load", XS_Math__Prime__Util_prime_count_table_load, file, "$");
+        (void)newXSproto_portable("Math::Prime::Util::_get_prime_segment_stats", XS_Math__Prime__Util__get_prime_segment_stats, file, "");
+        cv = newXSproto_portable("Math::Prime::Util::_XS_get_callgmp", XS_Math__Prime__Util_prime_memfree, file, "");
+        XSANY.any_i32 = 2;
+        cv = newXSproto_portable("Math::Prime::Util::_XS_get_segment_size", XS_Math__Prime__Util_prime_memfree, file, "");
+        XSANY.any_i32 = 4;
+        cv = newXSproto_portable("Math::Prime::Util::_XS_get_verbose", XS_Math__Prime__Util_prime_memfree, file, "");
+        XSANY.any_i32 = 1;
+        cv = newXSproto_portable("Math::Prime::Util::_get_prime_cache_size", XS_Math__Prime__Util_prime_memfree, file, "");
+        XSANY.any_i32 = 3;
+        cv = newXSproto_portable("Math::Prime::Util::prime_memfree", XS_Math__Prime__Util_prime_memfree, file, "");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::_XS_set_callgmp", XS_Math__Prime__Util_prime_precalc, file, "$");
+        XSANY.any_i32 = 2;
+        cv = newXSproto_portable("Math::Prime::Util::_XS_set_segment_size", XS_Math__Prime__Util_prime_precalc, file, "$");
+        XSANY.any_i32 = 4;
+        cv = newXSproto_portable("Math::Prime::Util::_XS_set_threads", XS_Math__Prime__Util_prime_precalc, file, "$");
+        XSANY.any_i32 = 3;
+        cv = newXSproto_portable("Math::Prime::Util::_XS_set_verbose", XS_Math__Prime__Util_prime_precalc, file, "$");
+        XSANY.any_i32 = 1;
+        cv = newXSproto_portable("Math::Prime::Util::prime_precalc", XS_Math__Prime__Util_prime_precalc, file, "$");
+        XSANY.any_i32 = 0;
+        (void)newXSproto_portable("Math::Prime::Util::_XS_get_cache_size", XS_Math__Prime__Util__XS_get_cache_size, file, "$");
+        (void)newXSproto_portable("Math::Prime::Util::_XS_set_cache_size", XS_Math__Prime__Util__XS_set_cache_size, file, "$$");
+        cv = newXSproto_portable("Math::Prime::Util::_XS_segment_pi", XS_Math__Prime__Util_prime_count, file, "$;@");
+        XSANY.any_i32 = 1;
+        cv = newXSproto_portable("Math::Prime::Util::prime_count", XS_Math__Prime__Util_prime_count, file, "$;@");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::print_primes", XS_Math__Prime__Util_prime_count, file, "$;@");
+        XSANY.any_i32 = 4;
+        cv = newXSproto_portable("Math::Prime::Util::sum_primes", XS_Math__Prime__Util_prime_count, file, "$;@");
+        XSANY.any_i32 = 3;
+        cv = newXSproto_portable("Math::Prime::Util::twin_prime_count", XS_Math__Prime__Util_prime_count, file, "$;@");
+        XSANY.any_i32 = 2;
+        cv = newXSproto_portable("Math::Prime::Util::nth_prime_multi", XS_Math__Prime__Util_prime_count_multi, file, "$");
+        XSANY.any_i32 = 1;
+        cv = newXSproto_portable("Math::Prime::Util::prime_count_multi", XS_Math__Prime__Util_prime_count_multi, file, "$");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::_XS_LMOS_pi", XS_Math__Prime__Util__XS_LMO_pi, file, "$");
+        XSANY.any_i32 = 4;
+        cv = newXSproto_portable("Math::Prime::Util::_XS_LMO_easy_pi", XS_Math__Prime__Util__XS_LMO_pi, file, "$");
+        XSANY.any_i32 = 5;
+        cv = newXSproto_portable("Math::Prime::Util::_XS_LMO_pi", XS_Math__Prime__Util__XS_LMO_pi, file, "$");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::_XS_legendre_pi", XS_Math__Prime__Util__XS_LMO_pi, file, "$");
+        XSANY.any_i32 = 1;
+        cv = newXSproto_portable("Math::Prime::Util::_XS_lehmer_pi", XS_Math__Prime__Util__XS_LMO_pi, file, "$");
+        XSANY.any_i32 = 3;
+        cv = newXSproto_portable("Math::Prime::Util::_XS_meissel_pi", XS_Math__Prime__Util__XS_LMO_pi, file, "$");
+        XSANY.any_i32 = 2;
+        cv = newXSproto_portable("Math::Prime::Util::_erat_primes_packed", XS_Math__Prime__Util_sieve_primes, file, "$$;@");
+        XSANY.any_i32 = 10;
+        cv = newXSproto_portable("Math::Prime::Util::_ramanujan_primes", XS_Math__Prime__Util_sieve_primes, file, "$$;@");
+        XSANY.any_i32 = 5;
+        cv = newXSproto_portable("Math::Prime::Util::_ramanujan_primes_packed", XS_Math__Prime__Util_sieve_primes, file, "$$;@");
+        XSANY.any_i32 = 13;
+        cv = newXSproto_portable("Math::Prime::Util::_segment_primes_packed", XS_Math__Prime__Util_sieve_primes, file, "$$;@");
+        XSANY.any_i32 = 11;
+        cv = newXSproto_portable("Math::Prime::Util::_segment_twin_primes_packed", XS_Math__Prime__Util_sieve_primes, file, "$$;@");
+        XSANY.any_i32 = 12;
+        cv = newXSproto_portable("Math::Prime::Util::_sieve_primes_packed", XS_Math__Prime__Util_sieve_primes, file, "$$;@");
+        XSANY.any_i32 = 8;
+        cv = newXSproto_portable("Math::Prime::Util::_trial_primes_packed", XS_Math__Prime__Util_sieve_primes, file, "$$;@");
+        XSANY.any_i32 = 9;
+        cv = newXSproto_portable("Math::Prime::Util::erat_primes", XS_Math__Prime__Util_sieve_primes, file, "$$;@");
+        XSANY.any_i32 = 2;
+        cv = newXSproto_portable("Math::Prime::Util::segment_primes", XS_Math__Prime__Util_sieve_primes, file, "$$;@");
+        XSANY.any_i32 = 3;
+        cv = newXSproto_portable("Math::Prime::Util::segment_twin_primes", XS_Math__Prime__Util_sieve_primes, file, "$$;@");
+        XSANY.any_i32 = 4;
+        cv = newXSproto_portable("Math::Prime::Util::sieve_primes", XS_Math__Prime__Util_sieve_primes, file, "$$;@");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::trial_primes", XS_Math__Prime__Util_sieve_primes, file, "$$;@");
+        XSANY.any_i32 = 1;
+        cv = newXSproto_portable("Math::Prime::Util::ecm_factor", XS_Math__Prime__Util_trial_factor, file, "$;@");
+        XSANY.any_i32 = 8;
+        cv = newXSproto_portable("Math::Prime::Util::fermat_factor", XS_Math__Prime__Util_trial_factor, file, "$;@");
+        XSANY.any_i32 = 1;
+        cv = newXSproto_portable("Math::Prime::Util::holf_factor", XS_Math__Prime__Util_trial_factor, file, "$;@");
+        XSANY.any_i32 = 2;
+        cv = newXSproto_portable("Math::Prime::Util::pbrent_factor", XS_Math__Prime__Util_trial_factor, file, "$;@");
+        XSANY.any_i32 = 6;
+        cv = newXSproto_portable("Math::Prime::Util::pminus1_factor", XS_Math__Prime__Util_trial_factor, file, "$;@");
+        XSANY.any_i32 = 7;
+        cv = newXSproto_portable("Math::Prime::Util::pplus1_factor", XS_Math__Prime__Util_trial_factor, file, "$;@");
+        XSANY.any_i32 = 5;
+        cv = newXSproto_portable("Math::Prime::Util::prho_factor", XS_Math__Prime__Util_trial_factor, file, "$;@");
+        XSANY.any_i32 = 4;
+        cv = newXSproto_portable("Math::Prime::Util::squfof_factor", XS_Math__Prime__Util_trial_factor, file, "$;@");
+        XSANY.any_i32 = 3;
+        cv = newXSproto_portable("Math::Prime::Util::trial_factor", XS_Math__Prime__Util_trial_factor, file, "$;@");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::is_pseudoprime", XS_Math__Prime__Util_is_strong_pseudoprime, file, "$;@");
+        XSANY.any_i32 = 1;
+        cv = newXSproto_portable("Math::Prime::Util::is_strong_pseudoprime", XS_Math__Prime__Util_is_strong_pseudoprime, file, "$;@");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::gcd", XS_Math__Prime__Util_gcd, file, "@");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::lcm", XS_Math__Prime__Util_gcd, file, "@");
+        XSANY.any_i32 = 1;
+        cv = newXSproto_portable("Math::Prime::Util::vecmax", XS_Math__Prime__Util_gcd, file, "@");
+        XSANY.any_i32 = 3;
+        cv = newXSproto_portable("Math::Prime::Util::vecmin", XS_Math__Prime__Util_gcd, file, "@");
+        XSANY.any_i32 = 2;
+        cv = newXSproto_portable("Math::Prime::Util::vecprod", XS_Math__Prime__Util_gcd, file, "@");
+        XSANY.any_i32 = 5;
+        cv = newXSproto_portable("Math::Prime::Util::vecsum", XS_Math__Prime__Util_gcd, file, "@");
+        XSANY.any_i32 = 4;
+        (void)newXSproto_portable("Math::Prime::Util::vecextract", XS_Math__Prime__Util_vecextract, file, "$$");
+        (void)newXSproto_portable("Math::Prime::Util::chinese", XS_Math__Prime__Util_chinese, file, "@");
+        cv = newXSproto_portable("Math::Prime::Util::lucas_sequence", XS_Math__Prime__Util_lucas_sequence, file, ";@");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::lucasu", XS_Math__Prime__Util_lucas_sequence, file, ";@");
+        XSANY.any_i32 = 1;
+        cv = newXSproto_portable("Math::Prime::Util::lucasv", XS_Math__Prime__Util_lucas_sequence, file, ";@");
+        XSANY.any_i32 = 2;
+        cv = newXSproto_portable("Math::Prime::Util::is_aks_prime", XS_Math__Prime__Util_is_prime, file, "$;@");
+        XSANY.any_i32 = 4;
+        cv = newXSproto_portable("Math::Prime::Util::is_almost_extra_strong_lucas_pseudoprime", XS_Math__Prime__Util_is_prime, file, "$;@");
+        XSANY.any_i32 = 13;
+        cv = newXSproto_portable("Math::Prime::Util::is_bpsw_prime", XS_Math__Prime__Util_is_prime, file, "$;@");
+        XSANY.any_i32 = 3;
+        cv = newXSproto_portable("Math::Prime::Util::is_catalan_pseudoprime", XS_Math__Prime__Util_is_prime, file, "$;@");
+        XSANY.any_i32 = 12;
+        cv = newXSproto_portable("Math::Prime::Util::is_extra_strong_lucas_pseudoprime", XS_Math__Prime__Util_is_prime, file, "$;@");
+        XSANY.any_i32 = 7;
+        cv = newXSproto_portable("Math::Prime::Util::is_frobenius_khashin_pseudoprime", XS_Math__Prime__Util_is_prime, file, "$;@");
+        XSANY.any_i32 = 10;
+        cv = newXSproto_portable("Math::Prime::Util::is_frobenius_pseudoprime", XS_Math__Prime__Util_is_prime, file, "$;@");
+        XSANY.any_i32 = 8;
+        cv = newXSproto_portable("Math::Prime::Util::is_frobenius_underwood_pseudoprime", XS_Math__Prime__Util_is_prime, file, "$;@");
+        XSANY.any_i32 = 9;
+        cv = newXSproto_portable("Math::Prime::Util::is_lucas_pseudoprime", XS_Math__Prime__Util_is_prime, file, "$;@");
+        XSANY.any_i32 = 5;
+        cv = newXSproto_portable("Math::Prime::Util::is_mersenne_prime", XS_Math__Prime__Util_is_prime, file, "$;@");
+        XSANY.any_i32 = 15;
+        cv = newXSproto_portable("Math::Prime::Util::is_perrin_pseudoprime", XS_Math__Prime__Util_is_prime, file, "$;@");
+        XSANY.any_i32 = 11;
+        cv = newXSproto_portable("Math::Prime::Util::is_power", XS_Math__Prime__Util_is_prime, file, "$;@");
+        XSANY.any_i32 = 16;
+        cv = newXSproto_portable("Math::Prime::Util::is_prime", XS_Math__Prime__Util_is_prime, file, "$;@");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::is_prob_prime", XS_Math__Prime__Util_is_prime, file, "$;@");
+        XSANY.any_i32 = 1;
+        cv = newXSproto_portable("Math::Prime::Util::is_provable_prime", XS_Math__Prime__Util_is_prime, file, "$;@");
+        XSANY.any_i32 = 2;
+        cv = newXSproto_portable("Math::Prime::Util::is_ramanujan_prime", XS_Math__Prime__Util_is_prime, file, "$;@");
+        XSANY.any_i32 = 14;
+        cv = newXSproto_portable("Math::Prime::Util::is_strong_lucas_pseudoprime", XS_Math__Prime__Util_is_prime, file, "$;@");
+        XSANY.any_i32 = 6;
+        cv = newXSproto_portable("Math::Prime::Util::next_prime", XS_Math__Prime__Util_next_prime, file, "$");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::nth_prime", XS_Math__Prime__Util_next_prime, file, "$");
+        XSANY.any_i32 = 2;
+        cv = newXSproto_portable("Math::Prime::Util::nth_prime_approx", XS_Math__Prime__Util_next_prime, file, "$");
+        XSANY.any_i32 = 5;
+        cv = newXSproto_portable("Math::Prime::Util::nth_prime_lower", XS_Math__Prime__Util_next_prime, file, "$");
+        XSANY.any_i32 = 4;
+        cv = newXSproto_portable("Math::Prime::Util::nth_prime_upper", XS_Math__Prime__Util_next_prime, file, "$");
+        XSANY.any_i32 = 3;
+        cv = newXSproto_portable("Math::Prime::Util::nth_ramanujan_prime", XS_Math__Prime__Util_next_prime, file, "$");
+        XSANY.any_i32 = 8;
+        cv = newXSproto_portable("Math::Prime::Util::nth_twin_prime", XS_Math__Prime__Util_next_prime, file, "$");
+        XSANY.any_i32 = 6;
+        cv = newXSproto_portable("Math::Prime::Util::nth_twin_prime_approx", XS_Math__Prime__Util_next_prime, file, "$");
+        XSANY.any_i32 = 7;
+        cv = newXSproto_portable("Math::Prime::Util::prev_prime", XS_Math__Prime__Util_next_prime, file, "$");
+        XSANY.any_i32 = 1;
+        cv = newXSproto_portable("Math::Prime::Util::prime_count_approx", XS_Math__Prime__Util_next_prime, file, "$");
+        XSANY.any_i32 = 11;
+        cv = newXSproto_portable("Math::Prime::Util::prime_count_lower", XS_Math__Prime__Util_next_prime, file, "$");
+        XSANY.any_i32 = 10;
+        cv = newXSproto_portable("Math::Prime::Util::prime_count_upper", XS_Math__Prime__Util_next_prime, file, "$");
+        XSANY.any_i32 = 9;
+        cv = newXSproto_portable("Math::Prime::Util::twin_prime_count_approx", XS_Math__Prime__Util_next_prime, file, "$");
+        XSANY.any_i32 = 12;
+        (void)newXSproto_portable("Math::Prime::Util::Pi", XS_Math__Prime__Util_Pi, file, ";$");
+        (void)newXSproto_portable("Math::Prime::Util::_pidigits", XS_Math__Prime__Util__pidigits, file, "$");
+        cv = newXSproto_portable("Math::Prime::Util::divisors", XS_Math__Prime__Util_factor, file, "$");
+        XSANY.any_i32 = 2;
+        cv = newXSproto_portable("Math::Prime::Util::factor", XS_Math__Prime__Util_factor, file, "$");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::factor_exp", XS_Math__Prime__Util_factor, file, "$");
+        XSANY.any_i32 = 1;
+        (void)newXSproto_portable("Math::Prime::Util::divisor_sum", XS_Math__Prime__Util_divisor_sum, file, "$;@");
+        cv = newXSproto_portable("Math::Prime::Util::binomial", XS_Math__Prime__Util_znorder, file, "$$");
+        XSANY.any_i32 = 1;
+        cv = newXSproto_portable("Math::Prime::Util::jordan_totient", XS_Math__Prime__Util_znorder, file, "$$");
+        XSANY.any_i32 = 2;
+        cv = newXSproto_portable("Math::Prime::Util::legendre_phi", XS_Math__Prime__Util_znorder, file, "$$");
+        XSANY.any_i32 = 3;
+        cv = newXSproto_portable("Math::Prime::Util::znorder", XS_Math__Prime__Util_znorder, file, "$$");
+        XSANY.any_i32 = 0;
+        (void)newXSproto_portable("Math::Prime::Util::znlog", XS_Math__Prime__Util_znlog, file, "$$$");
+        cv = newXSproto_portable("Math::Prime::Util::invmod", XS_Math__Prime__Util_kronecker, file, "$$");
+        XSANY.any_i32 = 2;
+        cv = newXSproto_portable("Math::Prime::Util::kronecker", XS_Math__Prime__Util_kronecker, file, "$$");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::valuation", XS_Math__Prime__Util_kronecker, file, "$$");
+        XSANY.any_i32 = 1;
+        (void)newXSproto_portable("Math::Prime::Util::gcdext", XS_Math__Prime__Util_gcdext, file, "$$");
+        (void)newXSproto_portable("Math::Prime::Util::stirling", XS_Math__Prime__Util_stirling, file, "$$;$");
+        cv = newXSproto_portable("Math::Prime::Util::_XS_ExponentialIntegral", XS_Math__Prime__Util__XS_ExponentialIntegral, file, "$");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::_XS_LambertW", XS_Math__Prime__Util__XS_ExponentialIntegral, file, "$");
+        XSANY.any_i32 = 4;
+        cv = newXSproto_portable("Math::Prime::Util::_XS_LogarithmicIntegral", XS_Math__Prime__Util__XS_ExponentialIntegral, file, "$");
+        XSANY.any_i32 = 1;
+        cv = newXSproto_portable("Math::Prime::Util::_XS_RiemannR", XS_Math__Prime__Util__XS_ExponentialIntegral, file, "$");
+        XSANY.any_i32 = 3;
+        cv = newXSproto_portable("Math::Prime::Util::_XS_RiemannZeta", XS_Math__Prime__Util__XS_ExponentialIntegral, file, "$");
+        XSANY.any_i32 = 2;
+        cv = newXSproto_portable("Math::Prime::Util::euler_phi", XS_Math__Prime__Util_euler_phi, file, "$;@");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::moebius", XS_Math__Prime__Util_euler_phi, file, "$;@");
+        XSANY.any_i32 = 1;
+        cv = newXSproto_portable("Math::Prime::Util::_euler_phi_packed", XS_Math__Prime__Util__euler_phi_packed, file, "$$;@");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::_moebius_packed", XS_Math__Prime__Util__euler_phi_packed, file, "$$;@");
+        XSANY.any_i32 = 1;
+        cv = newXSproto_portable("Math::Prime::Util::carmichael_lambda", XS_Math__Prime__Util_carmichael_lambda, file, "$");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::chebyshev_psi", XS_Math__Prime__Util_carmichael_lambda, file, "$");
+        XSANY.any_i32 = 4;
+        cv = newXSproto_portable("Math::Prime::Util::chebyshev_theta", XS_Math__Prime__Util_carmichael_lambda, file, "$");
+        XSANY.any_i32 = 3;
+        cv = newXSproto_portable("Math::Prime::Util::exp_mangoldt", XS_Math__Prime__Util_carmichael_lambda, file, "$");
+        XSANY.any_i32 = 7;
+        cv = newXSproto_portable("Math::Prime::Util::factorial", XS_Math__Prime__Util_carmichael_lambda, file, "$");
+        XSANY.any_i32 = 5;
+        cv = newXSproto_portable("Math::Prime::Util::hammingweight", XS_Math__Prime__Util_carmichael_lambda, file, "$");
+        XSANY.any_i32 = 9;
+        cv = newXSproto_portable("Math::Prime::Util::liouville", XS_Math__Prime__Util_carmichael_lambda, file, "$");
+        XSANY.any_i32 = 2;
+        cv = newXSproto_portable("Math::Prime::Util::mertens", XS_Math__Prime__Util_carmichael_lambda, file, "$");
+        XSANY.any_i32 = 1;
+        cv = newXSproto_portable("Math::Prime::Util::sqrtint", XS_Math__Prime__Util_carmichael_lambda, file, "$");
+        XSANY.any_i32 = 6;
+        cv = newXSproto_portable("Math::Prime::Util::znprimroot", XS_Math__Prime__Util_carmichael_lambda, file, "$");
+        XSANY.any_i32 = 8;
+        (void)newXSproto_portable("Math::Prime::Util::_validate_num", XS_Math__Prime__Util__validate_num, file, "$;@");
+        (void)newXSproto_portable("Math::Prime::Util::forprimes", XS_Math__Prime__Util_forprimes, file, "&$;$");
+        (void)newXSproto_portable("Math::Prime::Util::forprimes_block", XS_Math__Prime__Util_forprimes_block, file, "&$;$");
+        cv = newXSproto_portable("Math::Prime::Util::forcomposites", XS_Math__Prime__Util_forcomposites, file, "&$;$");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::foroddcomposites", XS_Math__Prime__Util_forcomposites, file, "&$;$");
+        XSANY.any_i32 = 1;
+        (void)newXSproto_portable("Math::Prime::Util::fordivisors", XS_Math__Prime__Util_fordivisors, file, "&$");
+        (void)newXSproto_portable("Math::Prime::Util::forpart", XS_Math__Prime__Util_forpart, file, "&$;$");
+        cv = newXSproto_portable("Math::Prime::Util::forcomb", XS_Math__Prime__Util_forcomb, file, "&$;$");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::forperm", XS_Math__Prime__Util_forcomb, file, "&$;$");
+        XSANY.any_i32 = 1;
+        (void)newXSproto_portable("Math::Prime::Util::vecreduce", XS_Math__Prime__Util_vecreduce, file, "&@");
+        (void)newXSproto_portable("Math::Prime::Util::_prime_array_new", XS_Math__Prime__Util__prime_array_new, file, "$$");
+        (void)newXSproto_portable("Math::Prime::Util::_prime_array_fetch", XS_Math__Prime__Util__prime_array_fetch, file, "$$");
+        (void)newXSproto_portable("Math::Prime::Util::_prime_gaps_save", XS_Math__Prime__Util__prime_gaps_save, file, "$$$$$");
+        (void)newXSproto_portable("Math::Prime::Util::_prime_gaps_open", XS_Math__Prime__Util__prime_gaps_open, file, "$");
+        (void)newXSproto_portable("Math::Prime::Util::_prime_gaps_info", XS_Math__Prime__Util__prime_gaps_info, file, "$");
+        (void)newXSproto_portable("Math::Prime::Util::_prime_gaps_fetch", XS_Math__Prime__Util__prime_gaps_fetch, file, "$$$");
+        (void)newXSproto_portable("Math::Prime::Util::_prime_gaps_packed", XS_Math__Prime__Util__prime_gaps_packed, file, "$$$$");
+        cv = newXSproto_portable("Math::Prime::Util::PrimeIterator::iterate", XS_Math__Prime__Util__PrimeIterator_value, file, "$");
+        XSANY.any_i32 = 2;
+        cv = newXSproto_portable("Math::Prime::Util::PrimeIterator::peek", XS_Math__Prime__Util__PrimeIterator_value, file, "$");
+        XSANY.any_i32 = 1;
+        cv = newXSproto_portable("Math::Prime::Util::PrimeIterator::value", XS_Math__Prime__Util__PrimeIterator_value, file, "$");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::PrimeIterator::next", XS_Math__Prime__Util__PrimeIterator_next, file, "$");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::PrimeIterator::prev", XS_Math__Prime__Util__PrimeIterator_next, file, "$");
+        XSANY.any_i32 = 1;
+        cv = newXSproto_portable("Math::Prime::Util::PrimeIterator::rewind", XS_Math__Prime__Util__PrimeIterator_rewind, file, "$;$");
+        XSANY.any_i32 = 0;
+        cv = newXSproto_portable("Math::Prime::Util::PrimeIterator::seek_to_i", XS_Math__Prime__Util__PrimeIterator_rewind, file, "$;$");
+        XSANY.any_i32 = 2;
+        cv = newXSproto_portable("Math::Prime::Util::PrimeIterator::seek_to_value", XS_Math__Prime__Util__PrimeIterator_rewind, file, "$;$");
+        XSANY.any_i32 = 1;
+    }
+
+    /* Initialisation Section */
+
+#line 458 "XS.xs"
+{
+    SV * sv = newSViv(BITS_PER_WORD);
+    HV * stash = gv_stashpv("Math::Prime::Util", TRUE);
+    newCONSTSUB(stash, "_XS_prime_maxbits", sv);
+    { int i;
+      MY_CXT_INIT;
+      MY_CXT.MPUroot = stash;
+      for (i = 0; i <= 3; i++) {
+        MY_CXT.const_int[i] = newSViv(i-1);
+        SvREADONLY_on(MY_CXT.const_int[i]);
+      }
+      MY_CXT.MPUGMP = gv_stashpv("Math::Prime::Util::GMP", TRUE);
+      MY_CXT.MPUPP = gv_stashpv("Math::Prime::Util::PP", TRUE);
+    }
+}
+
+#if XSubPPtmpAAAA
+#endif
+#line 3873 "XS.c"
+
+    /* End of Initialisation Section */
+
+#if PERL_VERSION_LE(5, 21, 5)
+#  if PERL_VERSION_GE(5, 9, 0)
+    if (PL_unitcheckav)
+        call_list(PL_scopestack_ix, PL_unitcheckav);
+#  endif
+    XSRETURN_YES;
+#else
+    Perl_xs_boot_epilog(aTHX_ ax);
+#endif
+}
+
@@ -24,6 +24,10 @@
 #include "lehmer.h"
 #include "lmo.h"
 #include "aks.h"
+#include "primearray.h"
+#include "primegaps.h"
+#include "prime_sums.h"
+#include "pctable.h"
 #include "constants.h"
 
 #if BITS_PER_WORD == 64
@@ -234,6 +238,218 @@ static int _vcallsubn(pTHX_ I32 flags, I32 stashflags, const char* name, int nar
     } \
   }
 
+/* Object state kept in a string is changed in place, so the buffer must be
+ * ours alone: not read-only, and not shared copy-on-write with a copy. */
+static char* _state_pv(pTHX_ SV* sv, const char* what)
+{
+  if (SvREADONLY(sv))  croak("%s is read-only", what);
+  return SvPV_force_nolen(sv);
+}
+
+/* PrimeIterator objects are a reference to a scalar.  For native values
+ * the scalar holds this header followed by a list of consecutive primes,
+ * with the current value at list[index].  Stepping past either end of the
+ * list sieves a new batch of primes.  Anything else in the scalar (a plain
+ * number, or a bigint) is a value handled by the Perl methods, and native
+ * values are turned back into a list when a C method next sees them. */
+#define ITER_MAGIC  UVCONST(0x4D505549)  /* "MPUI" */
+#define ITER_BATCH  4096                 /* Approx primes in each sieve */
+typedef struct {
+  UV magic;
+  UV index;
+  UV nprimes;
+} iter_head_t;
+#define ITER_LIST(h)  ((UV*)((h)+1))
+
+static iter_head_t* _iter_fill(pTHX_ SV* sv, UV low, UV high, int at_end)
+{
+  iter_head_t* h;
+  UV maxprimes = 3 + 8*(high/30 - low/30 + 1);
+  (void)SvUPGRADE(sv, SVt_PV);
+  SvGROW(sv, sizeof(iter_head_t) + maxprimes*sizeof(UV));
+  h = (iter_head_t*) SvPVX(sv);
+  h->magic = ITER_MAGIC;
+  h->nprimes = range_primes(low, high, ITER_LIST(h));
+  h->index = (at_end && h->nprimes > 0) ? h->nprimes-1 : 0;
+  SvCUR_set(sv, sizeof(iter_head_t) + h->nprimes*sizeof(UV));
+  SvPOK_only(sv);
+  return h;
+}
+static iter_head_t* _iter_set(pTHX_ SV* sv, UV p)
+{
+  return _iter_fill(aTHX_ sv, p, p, 0);
+}
+/* Returns 0 if the scalar is a bigint. */
+static iter_head_t* _iter_state(pTHX_ SV* self)
+{
+  SV* sv;
+  if (!SvROK(self))  croak("PrimeIterator method called without an object");
+  sv = SvRV(self);
+  if (SvPOK(sv) && SvCUR(sv) >= sizeof(iter_head_t)+sizeof(UV)) {
+    iter_head_t* h = (iter_head_t*) SvPVX(sv);
+    if (h->magic == ITER_MAGIC)
+      return (iter_head_t*) _state_pv(aTHX_ sv, "PrimeIterator object");
+  }
+  if (_validate_int(aTHX_ sv, 0) != 1)
+    return 0;
+  return _iter_set(aTHX_ sv, SvUV(sv));
+}
+/* Bytes to sieve for about ITER_BATCH primes near n. */
+static UV _iter_window(UV n)
+{
+  UV bytes = (UV) (ITER_BATCH * log((double)n + 3.0) / 30.0);
+  return (bytes < 64) ? 64 : (bytes > 16384) ? 16384 : bytes;
+}
+/* Step forward or back, refilling the list.  Returns 0 if we run out of
+ * native primes. */
+static iter_head_t* _iter_next(pTHX_ SV* self, iter_head_t* h)
+{
+  UV p, low, high;
+  if (h->index+1 < h->nprimes)  { h->index++; return h; }
+  p = ITER_LIST(h)[h->index];
+  if (p >= MPU_MAX_PRIME)  return 0;
+  low = p+1;
+  high = (MPU_MAX_PRIME - low < 30*_iter_window(p)) ? MPU_MAX_PRIME
+                                                     : low + 30*_iter_window(p);
+  return _iter_fill(aTHX_ SvRV(self), low, high, 0);
+}
+static iter_head_t* _iter_prev(pTHX_ SV* self, iter_head_t* h)
+{
+  UV p, low, high;
+  if (h->index > 0)  { h->index--; return h; }
+  p = ITER_LIST(h)[h->index];
+  if (p <= 2)  return h;
+  high = p-1;
+  low = (high > 30*_iter_window(p)) ? high - 30*_iter_window(p) : 0;
+  return _iter_fill(aTHX_ SvRV(self), low, high, 1);
+}
+/* Put the plain value back in the scalar and have Perl do the method. */
+#define ITER_CALL_PERL(h, method) \
+  do { \
+    if (h)  sv_setuv(SvRV(ST(0)), ITER_LIST(h)[h->index]); \
+    PUSHMARK(PL_stack_sp-items); \
+    (void)call_pv("Math::Prime::Util::PrimeIterator::" method, G_SCALAR); \
+    return; \
+  } while (0)
+
+/* Packed output writes native UVs straight into a string's buffer rather
+ * than making an SV for each value.  The string is either new or one the
+ * caller gave us, in which case its buffer is reused when big enough. */
+typedef struct {
+  SV* sv;
+  UV* list;
+  UV  n;
+  UV  max;
+} packed_t;
+
+static void _packed_start(pTHX_ packed_t* pk, SV* sv, UV expect)
+{
+  if (expect < 16)  expect = 16;
+  if (sv == 0) {
+    sv = sv_2mortal(newSV(expect * sizeof(UV)));
+  } else {
+    if (SvREADONLY(sv))  croak("Packed output buffer is read-only");
+    if (SvTHINKFIRST(sv) || !SvPOK(sv))  /* refs, shared (COW) strings */
+      sv_setpvn(sv, "", 0);
+    SvGROW(sv, expect * sizeof(UV));
+  }
+  pk->sv = sv;
+  pk->list = (UV*) SvPVX(sv);
+  pk->n = 0;
+  pk->max = SvLEN(sv) / sizeof(UV);
+}
+static void _packed_grow(pTHX_ packed_t* pk)
+{
+  SvGROW(pk->sv, (pk->max + pk->max/2 + 16) * sizeof(UV));
+  pk->list = (UV*) SvPVX(pk->sv);
+  pk->max = SvLEN(pk->sv) / sizeof(UV);
+}
+#define PACKED_PUSH(pk, v) \
+  do { \
+    if ((pk)->n >= (pk)->max)  _packed_grow(aTHX_ pk); \
+    (pk)->list[(pk)->n++] = (v); \
+  } while (0)
+static void _packed_end(pTHX_ packed_t* pk, UV size)
+{
+  SvCUR_set(pk->sv, pk->n * size);
+  SvPOK_only(pk->sv);
+  SvSETMAGIC(pk->sv);    /* a caller's tied or lvalue buffer sees the write */
+}
+/* The packed string if we made it, otherwise the count in the caller's. */
+#define PACKED_RETURN(pk, bufsv) \
+  do { \
+    ST(0) = (bufsv) ? sv_2mortal(newSVuv((pk)->n)) : (pk)->sv; \
+    XSRETURN(1); \
+  } while (0)
+
+/* About how many primes are in [low,high], for sizing output.  Not a bound. */
+static UV _primes_expect(UV low, UV high)
+{
+  UV wheel = 3 + 8*(high/30 - low/30 + 1);
+  UV est = (low < high/2) ? prime_count_upper(high)
+         : (UV) ((double)(high-low) / (log((double)low) - 1.1)) + 64;
+  return (est < wheel) ? est : wheel;
+}
+
+/* State for reading a prime gap file, kept in a Perl string: the header,
+ * the checkpoint table, then the most recently decoded block. */
+typedef struct {
+  prime_gaps_info_t info;
+  UV block;       /* block number + 1 of the decoded primes, 0 if none */
+  UV nprimes;
+} pgf_head_t;
+#define PGF_TABLE(h)   ((unsigned char*)((h)+1))
+#define PGF_PRIMES(h)  ((UV*)(PGF_TABLE(h) + ((h)->info.ncheck*PRIME_GAPS_CHECK_BYTES + sizeof(UV)-1) / sizeof(UV) * sizeof(UV)))
+
+static PerlIO* _pgf_io(pTHX_ SV* svfh)
+{
+  IO* io = sv_2io(svfh);
+  if (io == 0 || IoIFP(io) == 0)  croak("Prime gap file is not open");
+  return IoIFP(io);
+}
+static pgf_head_t* _pgf_state(pTHX_ SV* state)
+{
+  pgf_head_t* h;
+  if (!SvPOK(state) || SvCUR(state) < sizeof(pgf_head_t))
+    croak("Invalid prime gap file state");
+  h = (pgf_head_t*) _state_pv(aTHX_ state, "Prime gap file state");
+  if ((UV)((char*)(PGF_PRIMES(h) + h->info.interval) - (char*)h) != SvCUR(state))
+    croak("Invalid prime gap file state");
+  return h;
+}
+/* Make sure the block holding index is decoded, returning its offset. */
+static UV _pgf_block(pTHX_ pgf_head_t* h, PerlIO* fp, UV index)
+{
+  UV j = index / h->info.interval;
+  if (h->block != j+1) {
+    UV prime, pindex, offset, end, nbytes, want, dummy;
+    unsigned char* buf;
+    if (!prime_gaps_checkpoint(&h->info, PGF_TABLE(h), j, &prime, &pindex, &offset))
+      croak("Corrupt prime gap file checkpoint");
+    end = h->info.table_offset;
+    if (j+1 < h->info.ncheck &&
+        !prime_gaps_checkpoint(&h->info, PGF_TABLE(h), j+1, &dummy, &pindex, &end))
+      croak("Corrupt prime gap file checkpoint");
+    want = h->info.count - j * h->info.interval;
+    if (want > h->info.interval)  want = h->info.interval;
+    if (end < offset || end - offset > want * ((BITS_PER_WORD+6)/7))
+      croak("Corrupt prime gap file checkpoint");
+    nbytes = end - offset;
+    h->block = 0;
+    New(0, buf, nbytes+1, unsigned char);
+    if (PerlIO_seek(fp, (Off_t)offset, SEEK_SET) != 0 ||
+        (nbytes > 0 && PerlIO_read(fp, buf, nbytes) != (SSize_t)nbytes)) {
+      Safefree(buf);
+      croak("Error reading prime gap file");
+    }
+    h->nprimes = prime_gaps_decode(buf, nbytes, prime, PGF_PRIMES(h), want);
+    Safefree(buf);
+    if (h->nprimes != want)  croak("Corrupt prime gap file block %"UVuf, j);
+    h->block = j+1;
+  }
+  return index - j * h->info.interval;
+}
+
 MODULE = Math::Prime::Util	PACKAGE = Math::Prime::Util
 
 PROTOTYPES: ENABLE
@@ -291,14 +507,47 @@ PPCODE:
   MY_CXT.MPUGMP = NULL;
   MY_CXT.MPUPP = NULL;
   _prime_memfreeall();
+  prime_count_table_free();
   return; /* skip implicit PUTBACK, returning @_ to caller, more efficient*/
 
+int
+prime_cache_save(IN char* filename)
+
+UV
+prime_cache_load(IN char* filename)
+
+int
+prime_count_table_save(IN char* filename, IN UV low, IN UV high, IN UV interval = 30000000)
+  PREINIT:
+    UV ncheck;
+  CODE:
+    if (interval == 0 || interval % 30 != 0)
+      croak("prime_count_table_save: interval must be a positive multiple of 30");
+    RETVAL = prime_count_table_save(filename, low, high, interval, &ncheck);
+  OUTPUT:
+    RETVAL
+
+UV
+prime_count_table_load(IN char* filename)
+
+void
+_get_prime_segment_stats()
+  PREINIT:
+    UV allocs, reuses, pooled;
+  PPCODE:
+    get_prime_segment_stats(&allocs, &reuses, &pooled);
+    EXTEND(SP, 3);
+    PUSHs(sv_2mortal(newSVuv(allocs)));
+    PUSHs(sv_2mortal(newSVuv(reuses)));
+    PUSHs(sv_2mortal(newSVuv(pooled)));
+
 void
 prime_memfree()
   ALIAS:
     _XS_get_verbose = 1
     _XS_get_callgmp = 2
     _get_prime_cache_size = 3
+    _XS_get_segment_size = 4
   PREINIT:
     UV ret;
   PPCODE:
@@ -306,8 +555,9 @@ prime_memfree()
       case 0:  prime_memfree(); goto return_nothing;
       case 1:  ret = _XS_get_verbose(); break;
       case 2:  ret = _XS_get_callgmp(); break;
-      case 3:
-      default: ret = get_prime_cache(0,0); break;
+      case 3:  ret = get_prime_cache(0,0); break;
+      case 4:
+      default: ret = _XS_get_segment_size(); break;
     }
     XSRETURN_UV(ret);
     return_nothing:
@@ -317,16 +567,26 @@ prime_precalc(IN UV n)
   ALIAS:
     _XS_set_verbose = 1
     _XS_set_callgmp = 2
+    _XS_set_threads = 3
+    _XS_set_segment_size = 4
   PPCODE:
     PUTBACK; /* SP is never used again, the 3 next func calls are tailcall
     friendly since this XSUB has nothing to do after the 3 calls return */
     switch (ix) {
       case 0:  prime_precalc(n);    break;
       case 1:  _XS_set_verbose(n);  break;
-      default: _XS_set_callgmp(n);  break;
+      case 2:  _XS_set_callgmp(n);  break;
+      case 3:  _XS_set_threads(n);  break;
+      default: _XS_set_segment_size(n);  break;
     }
     return; /* skip implicit PUTBACK */
 
+UV
+_XS_get_cache_size(IN int level)
+
+void
+_XS_set_cache_size(IN int level, IN UV size)
+
 void
 prime_count(IN SV* svlo, ...)
   ALIAS:
@@ -353,17 +613,35 @@ prime_count(IN SV* svlo, ...)
         if (ix == 2) {
           count = twin_prime_count(lo, hi);
         } else if (ix == 3) {
-          lostatus = sum_primes(lo, hi, &count);
+          UV hisum;
+          if (!sum_primes128(lo, hi, &hisum, &count)) {
+            lostatus = sum_primes(lo, hi, &count);
+          } else if (hisum != 0) {
+            char str[40];
+            sum_primes128_string(hisum, count, str);
+            ST(0) = sv_2mortal(newSVpv(str, 0));
+            PL_stack_sp = PL_stack_base + ax;   /* just the string */
+            (void)_vcallsubn(aTHX_ G_SCALAR, VCALL_ROOT, "_to_bigint", 1);
+            return;
+          }
         } else if (ix == 4) {
-          int fd = (items < 2) ? fileno(stdout) : my_sviv(ST(2));
-          print_primes(lo, hi, fd);
+          int fd = (items < 3) ? fileno(stdout) : my_sviv(ST(2));
+          int format = PRINT_PRIMES_TEXT;
+          if (items >= 4) {
+            const char* fstr = SvPV_nolen(ST(3));
+            if      (strEQ(fstr, "text"))  format = PRINT_PRIMES_TEXT;
+            else if (strEQ(fstr, "le64"))  format = PRINT_PRIMES_LE64;
+            else if (strEQ(fstr, "delta")) format = PRINT_PRIMES_DELTA;
+            else croak("print_primes format must be text, le64, or delta");
+          }
+          print_primes(lo, hi, fd, format);
           XSRETURN_EMPTY;
         } else if (ix == 1 || (hi / (hi-lo+1)) > 100) {
           count = _XS_prime_count(lo, hi);
         } else {
-          count = _XS_LMO_pi(hi);
+          count = _XS_pi(hi);
           if (lo > 2)
-            count -= _XS_LMO_pi(lo-1);
+            count -= _XS_pi(lo-1);
         }
       }
       if (lostatus == 1) XSRETURN_UV(count);
@@ -378,6 +656,39 @@ prime_count(IN SV* svlo, ...)
     }
     return; /* skip implicit PUTBACK */
 
+void
+prime_count_multi(IN SV* svx)
+  ALIAS:
+    nth_prime_multi = 1
+  PREINIT:
+    AV* av;
+    UV i, n, *v, *res;
+  PPCODE:
+    if (!SvROK(svx) || SvTYPE(SvRV(svx)) != SVt_PVAV)
+      croak("%s argument must be an array reference", ix ? "nth_prime_multi" : "prime_count_multi");
+    av = (AV*) SvRV(svx);
+    n = av_len(av) + 1;
+    New(0, v, n+1, UV);
+    for (i = 0; i < n; i++) {
+      SV** psv = av_fetch(av, i, 0);
+      if (psv == 0 || _validate_int(aTHX_ *psv, 0) != 1)  break;
+      v[i] = my_svuv(*psv);
+      if (ix == 1 && v[i] >= MPU_MAX_PRIME_IDX)  break;
+    }
+    if (i < n) {   /* Something is out of range.  Let Perl do them. */
+      Safefree(v);
+      _vcallsubn(aTHX_ G_ARRAY, VCALL_PP, ix ? "nth_prime_multi" : "prime_count_multi", items);
+      return;
+    }
+    New(0, res, n+1, UV);
+    if (ix == 0)  prime_count_multi(n, v, res);
+    else          nth_prime_multi(n, v, res);
+    Safefree(v);
+    EXTEND(SP, (IV)n);
+    for (i = 0; i < n; i++)
+      PUSHs(sv_2mortal(newSVuv(res[i])));
+    Safefree(res);
+
 UV
 _XS_LMO_pi(IN UV n)
   ALIAS:
@@ -385,6 +696,7 @@ _XS_LMO_pi(IN UV n)
     _XS_meissel_pi = 2
     _XS_lehmer_pi = 3
     _XS_LMOS_pi = 4
+    _XS_LMO_easy_pi = 5
   PREINIT:
     UV ret;
   CODE:
@@ -393,50 +705,71 @@ _XS_LMO_pi(IN UV n)
       case 1: ret = _XS_legendre_pi(n); break;
       case 2: ret = _XS_meissel_pi(n); break;
       case 3: ret = _XS_lehmer_pi(n); break;
-      default:ret = _XS_LMOS_pi(n); break;
+      case 4: ret = _XS_LMOS_pi(n); break;
+      default:ret = _XS_LMO_easy_pi(n); break;
     }
     RETVAL = ret;
   OUTPUT:
     RETVAL
 
 void
-sieve_primes(IN UV low, IN UV high)
+sieve_primes(IN UV low, IN UV high, ...)
   ALIAS:
     trial_primes = 1
     erat_primes = 2
     segment_primes = 3
     segment_twin_primes = 4
     _ramanujan_primes = 5
+    _sieve_primes_packed = 8
+    _trial_primes_packed = 9
+    _erat_primes_packed = 10
+    _segment_primes_packed = 11
+    _segment_twin_primes_packed = 12
+    _ramanujan_primes_packed = 13
   PREINIT:
-    AV* av;
+    AV* av = 0;
+    packed_t pk;
+    SV* bufsv = 0;
   PPCODE:
-    av = newAV();
-    {
-      SV * retsv = sv_2mortal(newRV_noinc( (SV*) av ));
-      PUSHs(retsv);
-      PUTBACK;
-      SP = NULL; /* never use SP again, poison */
-    }
-    if ((low <= 2) && (high >= 2) && ix != 4) { av_push(av, newSVuv( 2 )); }
-    if ((low <= 3) && (high >= 3) && ix != 5) { av_push(av, newSVuv( 3 )); }
-    if ((low <= 5) && (high >= 5) && ix != 5) { av_push(av, newSVuv( 5 )); }
+    pk.sv = 0;
+    if (ix >= 8) {                  /* Packed into a string, maybe the caller's */
+      UV lo = (low < 7) ? 7 : low, expect = 3;
+      ix -= 8;
+      if (items > 2 && SvOK(ST(2)))  bufsv = ST(2);
+      if (lo <= high)
+        expect += (ix == 4) ? _primes_expect(lo, high)/8 : _primes_expect(lo, high);
+      _packed_start(aTHX_ &pk, bufsv, expect);
+    } else {
+      av = newAV();
+      {
+        SV * retsv = sv_2mortal(newRV_noinc( (SV*) av ));
+        PUSHs(retsv);
+        PUTBACK;
+        SP = NULL; /* never use SP again, poison */
+      }
+    }
+#define PUSH_RESULT(v) \
+    do { if (av) av_push(av, newSVuv(v)); else PACKED_PUSH(&pk, v); } while (0)
+    if ((low <= 2) && (high >= 2) && ix != 4) { PUSH_RESULT( 2 ); }
+    if ((low <= 3) && (high >= 3) && ix != 5) { PUSH_RESULT( 3 ); }
+    if ((low <= 5) && (high >= 5) && ix != 5) { PUSH_RESULT( 5 ); }
     if (low < 7)  low = 7;
     if (low <= high) {
       if (ix == 4) high += 2;
       if (ix == 0) {                          /* Sieve with primary cache */
         START_DO_FOR_EACH_PRIME(low, high) {
-          av_push(av,newSVuv(p));
+          PUSH_RESULT(p);
         } END_DO_FOR_EACH_PRIME
       } else if (ix == 1) {                   /* Trial */
         for (low = next_prime(low-1);
              low <= high && low != 0;
              low = next_prime(low) ) {
-          av_push(av,newSVuv(low));
+          PUSH_RESULT(low);
         }
       } else if (ix == 2) {                   /* Erat with private memory */
         unsigned char* sieve = sieve_erat30(high);
         START_DO_FOR_EACH_SIEVE_PRIME( sieve, 0, low, high ) {
-           av_push(av,newSVuv(p));
+           PUSH_RESULT(p);
         } END_DO_FOR_EACH_SIEVE_PRIME
         Safefree(sieve);
       } else if (ix == 3 || ix == 4) {        /* Segment */
@@ -445,8 +778,8 @@ sieve_primes(IN UV low, IN UV high)
         void* ctx = start_segment_primes(low, high, &segment);
         while (next_segment_primes(ctx, &seg_base, &seg_low, &seg_high)) {
           START_DO_FOR_EACH_SIEVE_PRIME( segment, seg_base, seg_low, seg_high )
-            if (ix == 3)            av_push(av,newSVuv( p ));
-            else if (lastp+2 == p)  av_push(av,newSVuv( lastp ));
+            if (ix == 3)            PUSH_RESULT( p );
+            else if (lastp+2 == p)  PUSH_RESULT( lastp );
             lastp = p;
           END_DO_FOR_EACH_SIEVE_PRIME
         }
@@ -458,11 +791,16 @@ sieve_primes(IN UV low, IN UV high)
         UV* L = n_range_ramanujan_primes(nlo, nhi);
         for (s = 0; s <= nhi-nlo && L[s] <= high; s++) {
           if (L[s] >= low)
-            av_push(av,newSVuv(L[s]));
+            PUSH_RESULT(L[s]);
         }
         Safefree(L);
       }
     }
+#undef PUSH_RESULT
+    if (av == 0) {
+      _packed_end(aTHX_ &pk, sizeof(UV));
+      PACKED_RETURN(&pk, bufsv);
+    }
     return; /* skip implicit PUTBACK */
 
 void
@@ -1368,6 +1706,42 @@ euler_phi(IN SV* svlo, ...)
       return;
     }
 
+void
+_euler_phi_packed(IN UV lo, IN UV hi, ...)
+  ALIAS:
+    _moebius_packed = 1
+  PREINIT:
+    SV* bufsv;
+    char* res = 0;
+    UV n, size;
+  PPCODE:
+    bufsv = (items > 2) ? ST(2) : 0;
+    n = (lo <= hi) ? hi-lo+1 : 0;
+    size = (ix == 0) ? sizeof(UV) : sizeof(signed char);
+    if (n > 0) {
+      if (ix == 0) {
+        UV  arraylo = (lo < 100)  ?  0  :  lo;
+        UV* totients = _totient_range(arraylo, hi);
+        if (arraylo != lo)
+          memmove(totients, totients + (lo-arraylo), n * sizeof(UV));
+        res = (char*) totients;
+      } else {
+        res = (char*) _moebius_range(lo, hi);
+      }
+    }
+    if (bufsv == 0) {               /* Hand the array to a new string */
+      SV* sv = sv_2mortal(newSV(0));
+      if (res == 0)  sv_setpvn(sv, "", 0);
+      else           sv_usepvn(sv, res, n * size);
+      ST(0) = sv;
+    } else {
+      if (SvREADONLY(bufsv))  croak("Packed output buffer is read-only");
+      sv_setpvn(bufsv, res ? res : "", n * size);
+      if (res)  Safefree(res);
+      ST(0) = sv_2mortal(newSVuv(n));
+    }
+    XSRETURN(1);
+
 void
 carmichael_lambda(IN SV* svn)
   ALIAS:
@@ -1523,7 +1897,7 @@ forprimes (SV* block, IN SV* svbeg, IN SV* svend = 0)
           MULTICALL;
         }
       } else {                      /* MULTICALL segment sieve */
-        void* ctx = start_segment_primes(beg, end, &segment);
+        void* ctx = start_segment_primes_serial(beg, end, &segment);
         while (next_segment_primes(ctx, &seg_base, &seg_low, &seg_high)) {
           int crossuv = (seg_high > IV_MAX) && !SvIsUV(svarg);
           START_DO_FOR_EACH_SIEVE_PRIME( segment, seg_base, seg_low, seg_high )
@@ -1542,7 +1916,7 @@ forprimes (SV* block, IN SV* svbeg, IN SV* svend = 0)
     else
 #endif
     if (beg <= end) {               /* NO-MULTICALL segment sieve */
-      void* ctx = start_segment_primes(beg, end, &segment);
+      void* ctx = start_segment_primes_serial(beg, end, &segment);
       while (next_segment_primes(ctx, &seg_base, &seg_low, &seg_high)) {
         START_DO_FOR_EACH_SIEVE_PRIME( segment, seg_base, seg_low, seg_high )
           sv_setuv(svarg, p);
@@ -1554,6 +1928,74 @@ forprimes (SV* block, IN SV* svbeg, IN SV* svend = 0)
     }
     SvREFCNT_dec(svarg);
 
+void
+forprimes_block (SV* block, IN SV* svbeg, IN SV* svend = 0)
+  PROTOTYPE: &$;$
+  PREINIT:
+    GV *gv;
+    HV *stash;
+    SV* svarg;
+    CV *cv;
+    packed_t pk;
+    unsigned char* segment;
+    UV beg, end, lo, seg_base, seg_low, seg_high;
+  PPCODE:
+    cv = sv_2cv(block, &stash, &gv, 0);
+    if (cv == Nullcv)
+      croak("Not a subroutine reference");
+
+    if (!_validate_int(aTHX_ svbeg, 0) || (items >= 3 && !_validate_int(aTHX_ svend,0))) {
+      _vcallsubn(aTHX_ G_VOID|G_DISCARD, VCALL_ROOT, "_generic_forprimes_block", items);
+      return;
+    }
+
+    if (items < 3) {
+      beg = 2;
+      end = my_svuv(svbeg);
+    } else {
+      beg = my_svuv(svbeg);
+      end = my_svuv(svend);
+    }
+    if (beg < 2)  beg = 2;
+
+    SAVESPTR(GvSV(PL_defgv));
+    svarg = newSVpvn("", 0);
+    GvSV(PL_defgv) = svarg;
+    /* Once per segment, $_ holds its primes packed and @_ its bounds. */
+    lo = beg;
+    if (beg <= end) {
+      void* ctx = start_segment_primes_serial((beg < 7) ? 7 : beg, (end < 7) ? 7 : end, &segment);
+      while (next_segment_primes(ctx, &seg_base, &seg_low, &seg_high)) {
+        UV hi = (seg_high < end) ? seg_high : end;
+        _packed_start(aTHX_ &pk, svarg, (seg_low <= hi) ? _primes_expect(seg_low, hi) : 3);
+        if (lo == beg) {
+          if (beg <= 2 && end >= 2)  PACKED_PUSH(&pk, 2);
+          if (beg <= 3 && end >= 3)  PACKED_PUSH(&pk, 3);
+          if (beg <= 5 && end >= 5)  PACKED_PUSH(&pk, 5);
+        }
+        if (seg_low <= hi) {
+          START_DO_FOR_EACH_SIEVE_PRIME( segment, seg_base, seg_low, hi )
+            PACKED_PUSH(&pk, p);
+          END_DO_FOR_EACH_SIEVE_PRIME
+        }
+        _packed_end(aTHX_ &pk, sizeof(UV));
+        ENTER;
+        SAVETMPS;
+        PUSHMARK(SP);
+        XPUSHs(sv_2mortal(newSVuv(lo)));
+        XPUSHs(sv_2mortal(newSVuv(hi)));
+        PUTBACK;
+        call_sv((SV*)cv, G_VOID|G_DISCARD);
+        SPAGAIN;
+        FREETMPS;
+        LEAVE;
+        if (hi >= end)  break;
+        lo = hi+1;
+      }
+      end_segment_primes(ctx);
+    }
+    SvREFCNT_dec(svarg);
+
 void
 forcomposites (SV* block, IN SV* svbeg, IN SV* svend = 0)
   ALIAS:
@@ -1618,7 +2060,7 @@ forcomposites (SV* block, IN SV* svbeg, IN SV* svend = 0)
         /* beg must be < max_prime, and end >= max_prime is special. */
         prevprime = prev_prime(beg);
         nextprime = (end >= MPU_MAX_PRIME) ? MPU_MAX_PRIME : next_prime(end);
-        ctx = start_segment_primes(beg, nextprime, &segment);
+        ctx = start_segment_primes_serial(beg, nextprime, &segment);
         while (next_segment_primes(ctx, &seg_base, &seg_low, &seg_high)) {
           START_DO_FOR_EACH_SIEVE_PRIME( segment, seg_base, seg_low, seg_high )
             cbeg = prevprime+1;  if (cbeg < beg) cbeg = beg;
@@ -1918,3 +2360,193 @@ CODE:
     ST(0) = ret;
     XSRETURN(1);
 }
+
+
+SV*
+_prime_array_new(IN UV memory, IN UV maxindex)
+  PREINIT:
+    UV size;
+  CODE:
+    size = prime_array_size(memory, maxindex);
+    RETVAL = newSV(size);
+    prime_array_init(SvPVX(RETVAL), memory, maxindex);
+    SvCUR_set(RETVAL, size);
+    SvPOK_only(RETVAL);
+  OUTPUT:
+    RETVAL
+
+UV
+_prime_array_fetch(IN SV* svpa, IN UV index)
+  CODE:
+    if (!SvPOK(svpa) || !prime_array_valid(SvPVX(svpa), SvCUR(svpa)))
+      croak("Invalid prime array state");
+    RETVAL = prime_array_fetch(_state_pv(aTHX_ svpa, "Prime array state"), index);
+  OUTPUT:
+    RETVAL
+
+void
+_prime_gaps_save(IN char* filename, IN UV low, IN UV high, IN UV interval, IN UV first_index)
+  PREINIT:
+    UV count;
+  PPCODE:
+    if (interval == 0 || interval > PRIME_GAPS_MAX_INTERVAL)
+      croak("Prime gap file interval must be from 1 to %lu", (unsigned long)PRIME_GAPS_MAX_INTERVAL);
+    if (!prime_gaps_save(filename, low, high, interval, first_index, &count))
+      XSRETURN_UNDEF;
+    XSRETURN_UV(count);
+
+void
+_prime_gaps_open(IN SV* svfh)
+  PREINIT:
+    PerlIO* fp;
+    Off_t filesize;
+    unsigned char buf[PRIME_GAPS_HEADER];
+    prime_gaps_info_t info;
+    pgf_head_t* h;
+    UV tbytes, size;
+    SV* state;
+  PPCODE:
+    fp = _pgf_io(aTHX_ svfh);
+    if (PerlIO_seek(fp, 0, SEEK_END) != 0 || (filesize = PerlIO_tell(fp)) < PRIME_GAPS_HEADER ||
+        PerlIO_seek(fp, 0, SEEK_SET) != 0 ||
+        PerlIO_read(fp, buf, PRIME_GAPS_HEADER) != PRIME_GAPS_HEADER ||
+        !prime_gaps_header(buf, (UV)filesize, &info))
+      XSRETURN_UNDEF;
+    tbytes = info.ncheck * PRIME_GAPS_CHECK_BYTES;
+    size = sizeof(pgf_head_t) + (tbytes + sizeof(UV)-1) / sizeof(UV) * sizeof(UV)
+         + info.interval * sizeof(UV);
+    state = sv_2mortal(newSV(size));
+    h = (pgf_head_t*) SvPVX(state);
+    h->info = info;
+    h->block = h->nprimes = 0;
+    if (PerlIO_seek(fp, (Off_t)info.table_offset, SEEK_SET) != 0 ||
+        (tbytes > 0 && PerlIO_read(fp, PGF_TABLE(h), tbytes) != (SSize_t)tbytes))
+      XSRETURN_UNDEF;
+    SvCUR_set(state, size);
+    SvPOK_only(state);
+    ST(0) = state;
+    XSRETURN(1);
+
+void
+_prime_gaps_info(IN SV* state)
+  PREINIT:
+    pgf_head_t* h;
+  PPCODE:
+    h = _pgf_state(aTHX_ state);
+    EXTEND(SP, 5);
+    PUSHs(sv_2mortal(newSVuv(h->info.low)));
+    PUSHs(sv_2mortal(newSVuv(h->info.high)));
+    PUSHs(sv_2mortal(newSVuv(h->info.count)));
+    PUSHs(sv_2mortal(newSVuv(h->info.first_index)));
+    PUSHs(sv_2mortal(newSVuv(h->info.interval)));
+
+void
+_prime_gaps_fetch(IN SV* state, IN SV* svfh, IN UV index)
+  PREINIT:
+    pgf_head_t* h;
+  PPCODE:
+    h = _pgf_state(aTHX_ state);
+    if (index >= h->info.count)  XSRETURN_UNDEF;
+    XSRETURN_UV(PGF_PRIMES(h)[_pgf_block(aTHX_ h, _pgf_io(aTHX_ svfh), index)]);
+
+void
+_prime_gaps_packed(IN SV* state, IN SV* svfh, IN UV index, IN UV n)
+  PREINIT:
+    pgf_head_t* h;
+    PerlIO* fp;
+    packed_t pk;
+  PPCODE:
+    h = _pgf_state(aTHX_ state);
+    fp = _pgf_io(aTHX_ svfh);
+    if (index > h->info.count)  index = h->info.count;
+    if (n > h->info.count - index)  n = h->info.count - index;
+    _packed_start(aTHX_ &pk, 0, n);   /* room for all n */
+    while (n > 0) {
+      UV off = _pgf_block(aTHX_ h, fp, index);
+      UV take = h->nprimes - off;
+      if (take > n)  take = n;
+      memcpy(pk.list + pk.n, PGF_PRIMES(h) + off, take * sizeof(UV));
+      pk.n += take;
+      index += take;
+      n -= take;
+    }
+    _packed_end(aTHX_ &pk, sizeof(UV));
+    ST(0) = pk.sv;
+    XSRETURN(1);
+
+MODULE = Math::Prime::Util	PACKAGE = Math::Prime::Util::PrimeIterator
+
+void
+value(IN SV* self)
+  ALIAS:
+    peek = 1
+    iterate = 2
+  PREINIT:
+    iter_head_t* h;
+    UV p;
+  PPCODE:
+    h = _iter_state(aTHX_ self);
+    if (h == 0) {
+      switch (ix) {
+        case 0:  ITER_CALL_PERL(h, "_pp_value");  break;
+        case 1:  ITER_CALL_PERL(h, "_pp_peek");  break;
+        default: ITER_CALL_PERL(h, "_pp_iterate");  break;
+      }
+    }
+    p = ITER_LIST(h)[h->index];
+    if (ix == 1) {
+      if (h->index+1 < h->nprimes)  XSRETURN_UV(ITER_LIST(h)[h->index+1]);
+      if (p >= MPU_MAX_PRIME)  ITER_CALL_PERL(h, "_pp_peek");
+      XSRETURN_UV(next_prime(p));
+    }
+    if (ix == 2 && _iter_next(aTHX_ self, h) == 0)
+      ITER_CALL_PERL(h, "_pp_iterate");
+    XSRETURN_UV(p);
+
+void
+next(IN SV* self)
+  ALIAS:
+    prev = 1
+  PREINIT:
+    iter_head_t* h;
+  PPCODE:
+    h = _iter_state(aTHX_ self);
+    if (ix == 0) {
+      if (h == 0 || _iter_next(aTHX_ self, h) == 0)
+        ITER_CALL_PERL(h, "_pp_next");
+    } else {
+      if (h == 0)
+        ITER_CALL_PERL(h, "_pp_prev");
+      (void)_iter_prev(aTHX_ self, h);
+    }
+    XSRETURN(1);   /* self */
+
+void
+rewind(IN SV* self, IN SV* svn = 0)
+  ALIAS:
+    seek_to_value = 1
+    seek_to_i = 2
+  PREINIT:
+    iter_head_t* h = 0;
+    UV n;
+  PPCODE:
+    if (!SvROK(self))  croak("PrimeIterator method called without an object");
+    if (ix == 1 && svn == 0)  croak("seek_to_value needs a value");
+    if (ix == 2 && svn == 0)  croak("seek_to_i needs an index");
+    if (svn != 0 && SvOK(svn) && _validate_int(aTHX_ svn, 0) != 1) {
+      switch (ix) {
+        case 0:  ITER_CALL_PERL(h, "_pp_rewind");  break;
+        case 1:  ITER_CALL_PERL(h, "_pp_seek_to_value");  break;
+        default: ITER_CALL_PERL(h, "_pp_seek_to_i");  break;
+      }
+    }
+    n = (svn == 0 || !SvOK(svn)) ? 2 : SvUV(svn);
+    if (ix == 2) {
+      if (n > MPU_MAX_PRIME_IDX)  ITER_CALL_PERL(h, "_pp_seek_to_i");
+      n = (n == 0) ? 2 : nth_prime(n);
+    } else {
+      if (n > MPU_MAX_PRIME)  ITER_CALL_PERL(h, "_pp_rewind");
+      n = (n <= 2) ? 2 : next_prime(n-1);
+    }
+    (void)_iter_set(aTHX_ SvRV(self), n);
+    XSRETURN(1);   /* self */
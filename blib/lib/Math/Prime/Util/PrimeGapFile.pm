@@ -0,0 +1,399 @@
+package Math::Prime::Util::PrimeGapFile;
+use strict;
+use warnings;
+
+BEGIN {
+  $Math::Prime::Util::PrimeGapFile::AUTHORITY = 'cpan:DANAJ';
+  $Math::Prime::Util::PrimeGapFile::VERSION = '0.50';
+}
+
+use base qw( Exporter );
+our @EXPORT_OK = qw( );
+our %EXPORT_TAGS = (all => [ @EXPORT_OK ]);
+
+
+use Math::Prime::Util qw/prime_count primes/;
+use Carp qw/croak/;
+
+use constant DEFAULT_INTERVAL => 4096;
+use constant MAX_INTERVAL     => 1 << 20;
+use constant HEADER_BYTES     => 64;
+use constant MAGIC            => "MPUGAP1\0";
+use constant BYTEORDER        => 0x01020304;
+
+# With XS the file is written and decoded in C, and the object holds a
+# string with the header, checkpoint table, and the last decoded block.
+# Without it the same file is handled here with pack and unpack, which
+# needs 64-bit integer support for the header and table.
+
+sub _xs { Math::Prime::Util::prime_get_config->{'xs'} }
+
+sub write {
+  my($class, $filename, $low, $high, %opts) = @_;
+  croak "usage: " . __PACKAGE__ . "->write(filename, low, high [, options])"
+    unless defined $filename && defined $high;
+  Math::Prime::Util::_validate_packed_range($low, $high);
+  my $interval = DEFAULT_INTERVAL;
+  my $index = 1;
+  foreach my $opt (keys %opts) {
+    if ($opt eq 'interval') {
+      $interval = $opts{$opt};
+      croak "interval must be an integer from 1 to " . MAX_INTERVAL
+        unless defined $interval && $interval =~ /^\d+$/
+            && $interval >= 1 && $interval <= MAX_INTERVAL;
+    } elsif ($opt eq 'index') {
+      $index = $opts{$opt};
+    } else {
+      croak "Unknown option '$opt'";
+    }
+  }
+  my $first_index = 0;
+  $first_index = (($low <= 2) ? 0 : prime_count($low-1)) + 1 if $index;
+
+  my $count = _xs()
+    ? Math::Prime::Util::_prime_gaps_save($filename, $low, $high, $interval, $first_index)
+    : _pp_save($filename, $low, $high, $interval, $first_index);
+  croak "Could not write prime gap file $filename" unless defined $count;
+  return $count;
+}
+
+sub new {
+  my($class, $filename) = @_;
+  croak "usage: " . __PACKAGE__ . "->new(filename)" unless defined $filename;
+  open(my $fh, '<:raw', $filename) or croak "Could not open $filename: $!";
+  my $self = bless { fh => $fh, pos => 0 }, $class;
+  if (_xs()) {
+    my $state = Math::Prime::Util::_prime_gaps_open($fh);
+    croak "$filename is not a prime gap file" unless defined $state;
+    $self->{state} = $state;
+    @$self{qw/low high count first_index interval/}
+      = Math::Prime::Util::_prime_gaps_info($state);
+  } else {
+    _pp_open($self) or croak "$filename is not a prime gap file";
+  }
+  return $self;
+}
+
+sub low         { $_[0]->{low} }
+sub high        { $_[0]->{high} }
+sub count       { $_[0]->{count} }
+sub first_index { $_[0]->{first_index} }
+sub interval    { $_[0]->{interval} }
+sub tell        { $_[0]->{pos} }
+
+sub prime_at {
+  my($self, $pos) = @_;
+  return if $pos < 0 || $pos >= $self->{count};
+  return Math::Prime::Util::_prime_gaps_fetch($self->{state}, $self->{fh}, $pos)
+    if defined $self->{state};
+  return _pp_fetch($self, $pos);
+}
+
+sub ith {
+  my($self, $n) = @_;
+  croak "This prime gap file has no prime indices" unless $self->{first_index};
+  return $self->prime_at($n - $self->{first_index});
+}
+
+sub iterate {
+  my $self = shift;
+  return if $self->{pos} >= $self->{count};
+  return $self->prime_at($self->{pos}++);
+}
+
+sub next_packed {
+  my($self, $n) = @_;
+  my $pos = $self->{pos};
+  $n = $self->{count} - $pos if !defined $n || $n > $self->{count} - $pos;
+  $self->{pos} += $n;
+  return Math::Prime::Util::_prime_gaps_packed($self->{state}, $self->{fh}, $pos, $n)
+    if defined $self->{state};
+  return pack("J*", map { _pp_fetch($self, $_) } $pos .. $pos+$n-1);
+}
+
+sub rewind { $_[0]->{pos} = 0; $_[0]; }
+
+sub seek {
+  my($self, $pos) = @_;
+  $pos = 0 if $pos < 0;
+  $pos = $self->{count} if $pos > $self->{count};
+  $self->{pos} = $pos;
+  return $self;
+}
+
+sub seek_to_i {
+  my($self, $n) = @_;
+  croak "This prime gap file has no prime indices" unless $self->{first_index};
+  return $self->seek($n - $self->{first_index});
+}
+
+sub tell_i {
+  my $self = shift;
+  return unless $self->{first_index};
+  return $self->{first_index} + $self->{pos};
+}
+
+################################################################################
+
+sub _pp_check_q {
+  croak "Prime gap files without XS need 64-bit integer support"
+    unless eval { my $q = pack("Q", 1); 1 };
+}
+
+sub _pp_save {
+  my($filename, $low, $high, $interval, $first_index) = @_;
+  _pp_check_q();
+  my $tmpname = "$filename.tmp$$";
+  open(my $fh, '>:raw', $tmpname) or return;
+  my($offset, $count, $prev, @table) = (HEADER_BYTES, 0, 0);
+  my $ok = print $fh "\0" x HEADER_BYTES;
+  for (my $lo = $low; $ok && $lo <= $high; $lo += 1_000_000) {
+    my $hi = ($high - $lo < 1_000_000) ? $high : $lo + 999_999;
+    my @gaps;
+    foreach my $p (@{primes($lo, $hi)}) {
+      if ($count++ % $interval == 0) {
+        if (@gaps) { my $s = pack("w*", @gaps); $ok &&= print $fh $s; $offset += length($s); @gaps = (); }
+        push @table, $p, $first_index + $count - 1, $offset;
+      } else {
+        push @gaps, ($prev == 2) ? 0 : ($p - $prev) >> 1;
+      }
+      $prev = $p;
+    }
+    if (@gaps) { my $s = pack("w*", @gaps); $ok &&= print $fh $s; $offset += length($s); }
+    last if $hi >= $high;
+  }
+  my $ncheck = scalar(@table) / 3;
+  $ok &&= print $fh pack("Q*", @table);
+  $ok &&= CORE::seek($fh, 0, 0);
+  $ok &&= print $fh pack("a8 L L Q6", MAGIC, BYTEORDER, $interval,
+                         $low, $high, $count, $first_index, $ncheck, $offset);
+  $ok = close($fh) && $ok;
+  $ok &&= rename($tmpname, $filename);
+  unlink $tmpname unless $ok;
+  return $ok ? $count : undef;
+}
+
+sub _pp_open {
+  my $self = shift;
+  my $fh = $self->{fh};
+  _pp_check_q();
+  my $filesize = -s $fh;
+  my $buf;
+  return 0 unless defined $filesize && $filesize >= HEADER_BYTES
+               && read($fh, $buf, HEADER_BYTES) == HEADER_BYTES;
+  my($magic, $order, $interval, $low, $high, $count, $first_index, $ncheck, $toff)
+    = unpack("a8 L L Q6", $buf);
+  return 0 unless $magic eq MAGIC && $order == BYTEORDER
+               && $interval >= 1 && $interval <= MAX_INTERVAL
+               && $ncheck == int(($count + $interval - 1) / $interval)
+               && $toff + 24*$ncheck == $filesize;
+  CORE::seek($fh, $toff, 0) or return 0;
+  return 0 unless read($fh, $buf, 24*$ncheck) == 24*$ncheck;
+  $self->{table} = [unpack("Q*", $buf)];
+  $self->{table_offset} = $toff;
+  $self->{block} = -1;
+  @$self{qw/low high count first_index interval/}
+    = ($low, $high, $count, $first_index, $interval);
+  return 1;
+}
+
+sub _pp_fetch {
+  my($self, $pos) = @_;
+  my $j = int($pos / $self->{interval});
+  if ($self->{block} != $j) {
+    my $t = $self->{table};
+    my($prime, $offset) = ($t->[3*$j], $t->[3*$j+2]);
+    my $end = (3*$j+3 < @$t) ? $t->[3*$j+5] : $self->{table_offset};
+    my $buf = '';
+    CORE::seek($self->{fh}, $offset, 0) or croak "Error reading prime gap file";
+    read($self->{fh}, $buf, $end - $offset) == $end - $offset
+      or croak "Error reading prime gap file";
+    my @list = ($prime);
+    foreach my $v (unpack("w*", $buf)) {
+      $prime = ($prime == 2) ? 3 : $prime + 2*$v;
+      push @list, $prime;
+    }
+    $self->{primes} = \@list;
+    $self->{block} = $j;
+  }
+  return $self->{primes}->[$pos - $j * $self->{interval}];
+}
+
+1;
+
+__END__
+
+
+# ABSTRACT: Compact files of primes stored as gaps
+
+=pod
+
+=for stopwords ith varints checkpoint checkpoints
+
+=head1 NAME
+
+Math::Prime::Util::PrimeGapFile - Compact files of primes stored as gaps
+
+
+=head1 VERSION
+
+Version 0.50
+
+
+=head1 SYNOPSIS
+
+  use Math::Prime::Util::PrimeGapFile;
+
+  # Write the primes between 10^12 and 10^12+10^10 (about 1 byte each)
+  my $n = Math::Prime::Util::PrimeGapFile->write("p.gaps", 1e12, 1e12+1e10);
+
+  my $pf = Math::Prime::Util::PrimeGapFile->new("p.gaps");
+  print $pf->count, " primes from ", $pf->low, " to ", $pf->high, "\n";
+
+  # Stream through them
+  while (defined(my $p = $pf->iterate)) { ... }
+
+  # Or a block at a time
+  $pf->rewind;
+  while (length(my $s = $pf->next_packed(100_000))) {
+    my @p = unpack("J*", $s);
+  }
+
+  # Random access
+  my $p = $pf->prime_at(123_456_789);     # by position in the file
+  $p = $pf->ith(37_607_912_019);          # by prime index
+
+=head1 DESCRIPTION
+
+Text lists of primes are slow to read, and raw integers take 8 bytes per
+prime.  This module writes and reads a file holding the primes of a range
+as gaps, which takes just over one byte per prime, along with a table of
+checkpoints that allows decoding any part of the file without reading the
+rest of it.
+
+With XS the file is written straight from the segment sieve and decoded in
+C.  Without it the same format is read and written in Perl, which needs a
+Perl with 64-bit integers.
+
+=head2 Format
+
+The file starts with a 64 byte header:
+the magic C<"MPUGAP1\0">, the byte order mark C<0x01020304> and the interval
+as 32-bit integers, then low, high, count, first index, number of
+checkpoints, and the offset of the checkpoint table, as 64-bit integers.
+The header and the table are native endian, so a file written on a machine
+with a different byte order is rejected (as with sieve files from
+L<Math::Prime::Util/prime_cache_save>).
+
+The primes are in blocks of C<interval> consecutive primes.  The checkpoint
+table at the end of the file holds three 64-bit integers for each block:
+its first prime, that prime's index (the first index plus its position in
+the file), and the file offset of the rest of the block.  The rest of the
+block is the gaps to each following prime, halved, as BER compressed
+integers (C<unpack "w*">).  The gap from 2 to 3 is stored as 0.  Gaps
+below 256 take one byte, and every gap below 2^64 fits in two.
+
+=head1 METHODS
+
+=head2 write
+
+  my $count = Math::Prime::Util::PrimeGapFile->write($filename, $low, $high, %options);
+
+Writes the primes from C<low> to C<high> inclusive to the file, returning
+how many there were.  The file is written to a temporary and renamed, so a
+reader never sees a partial file.  Options are:
+
+=over 4
+
+=item interval
+
+The number of primes per checkpoint, from 1 to 1048576.  Default 4096.
+Random access decodes up to this many primes.
+
+=item index
+
+If true (the default), the index of the first prime is computed with
+L<Math::Prime::Util/prime_count> and stored, so L</ith> and the checkpoint
+indices are prime indices.  Set it to 0 to skip that count, in which case
+the checkpoint indices are positions in the file.
+
+=back
+
+=head2 new
+
+Opens a file for reading, croaking if it isn't a prime gap file.
+
+=head2 low
+
+=head2 high
+
+=head2 count
+
+=head2 first_index
+
+=head2 interval
+
+The range, number of primes, index of the first prime (0 if not stored),
+and checkpoint interval of the file.
+
+=head2 prime_at
+
+Returns the prime at the given 0-based position in the file, or undef if
+past the end.
+
+=head2 ith
+
+Returns the prime with the given index, so C<ith(1)> is 2.  Returns undef
+if that prime is not in the file.  Croaks if the file has no indices.
+
+=head2 iterate
+
+Returns the prime at the current position and moves forward, returning
+undef at the end of the file.
+
+=head2 next_packed
+
+Returns up to the given number of primes from the current position (all of
+the remaining primes with no argument), packed as in
+L<Math::Prime::Util/primes_packed>, and moves past them.  Returns an empty
+string at the end of the file.
+
+=head2 rewind
+
+=head2 seek
+
+=head2 tell
+
+Set the current position to the start or a given 0-based position, or
+return it.
+
+=head2 seek_to_i
+
+=head2 tell_i
+
+Set or return the current position as a prime index.
+
+=head1 PERFORMANCE
+
+Writing runs at about the speed of L<Math::Prime::Util/print_primes>.
+Streaming with L</next_packed> decodes hundreds of millions of primes per
+second, and a random access costs one seek and at most C<interval> primes
+of decoding.
+
+=head1 SEE ALSO
+
+L<Math::Prime::Util>
+
+L<Math::Prime::Util::PrimeArray>
+
+=head1 AUTHORS
+
+Dana Jacobsen E<lt>dana@acm.orgE<gt>
+
+=head1 COPYRIGHT
+
+Copyright 2014 by Dana Jacobsen E<lt>dana@acm.orgE<gt>
+
+This program is free software; you can redistribute it and/or modify it under the same terms as Perl itself.
+
+=cut
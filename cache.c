@@ -6,6 +6,18 @@
 #include "cache.h"
 #include "sieve.h"
 #include "constants.h"   /* _MPU_FILL_EXTRA_N and _MPU_INITIAL_CACHE_SIZE */
+#include "util.h"        /* segment size */
+#include "lmo.h"         /* tables kept between prime counts */
+#include "pctable.h"     /* prime count table lock */
+
+#if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
+  #define MPU_HAVE_MMAP
+  #include <sys/types.h>
+  #include <sys/stat.h>
+  #include <sys/mman.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
 
 #ifdef STANDALONE
   #undef USE_ITHREADS
@@ -30,88 +42,208 @@
  */
 
 static int mutex_init = 0;
-#ifndef USE_ITHREADS
+#ifdef USE_ITHREADS
+ static perl_mutex segment_mutex;
+#endif
 
- #define WRITE_LOCK_START
- #define WRITE_LOCK_END
- #define READ_LOCK_START
- #define READ_LOCK_END
+static UV _padded_cache_size(UV n) {
+  if (n >= (UV_MAX-_MPU_FILL_EXTRA_N))
+    return UV_MAX;
+  return ((n + _MPU_FILL_EXTRA_N)/30)*30;
+}
+
+/* When growing, go at least half again past the current size (up to a
+ * limit), so callers creeping past the end don't extend it every time. */
+#define MAX_GEOMETRIC_GROWTH  UVCONST(1073741824)
+static UV _grown_cache_size(UV n, UV cursize) {
+  UV step = cursize/2;
+  if (step > MAX_GEOMETRIC_GROWTH)  step = MAX_GEOMETRIC_GROWTH;
+  if (cursize > 0 && n > cursize && n - cursize < step && cursize < UV_MAX - step)
+    n = cursize + step;
+  return _padded_cache_size(n);
+}
 
+/* The cache sieve is either ours (map == 0) or mapped from a sieve file. */
+static void _free_cache_sieve(unsigned char* sieve, void* map, size_t maplen) {
+  if (map != 0) {
+#ifdef MPU_HAVE_MMAP
+    munmap(map, maplen);
 #else
+    (void)maplen;
+    Safefree(map);
+#endif
+  } else if (sieve != 0) {
+    Safefree(sieve);
+  }
+}
 
- static perl_mutex segment_mutex;
- static perl_mutex primary_cache_mutex;
- static perl_cond  primary_cache_turn;
- static int        primary_cache_reading;
- static int        primary_cache_writing;
- static int        primary_cache_writers;
-
- #define WRITE_LOCK_START \
-   do { \
-     MUTEX_LOCK(&primary_cache_mutex); \
-     primary_cache_writers++; \
-     while (primary_cache_reading || primary_cache_writing) \
-       COND_WAIT(&primary_cache_turn, &primary_cache_mutex); \
-     primary_cache_writing++; \
-     MUTEX_UNLOCK(&primary_cache_mutex); \
-   } while (0)
-
- #define WRITE_LOCK_END \
-   do { \
-     MUTEX_LOCK(&primary_cache_mutex); \
-     primary_cache_writing--; \
-     primary_cache_writers--; \
-     COND_BROADCAST(&primary_cache_turn); \
-     MUTEX_UNLOCK(&primary_cache_mutex); \
-   } while (0)
-
- #define READ_LOCK_START \
-   do { \
-     MUTEX_LOCK(&primary_cache_mutex); \
-     if (primary_cache_writers) \
-       COND_WAIT(&primary_cache_turn, &primary_cache_mutex); \
-     while (primary_cache_writing) \
-       COND_WAIT(&primary_cache_turn, &primary_cache_mutex); \
-     primary_cache_reading++; \
-     MUTEX_UNLOCK(&primary_cache_mutex); \
-   } while (0)
-
- #define READ_LOCK_END \
-   do { \
-     MUTEX_LOCK(&primary_cache_mutex); \
-     primary_cache_reading--; \
-     COND_BROADCAST(&primary_cache_turn); \
-     MUTEX_UNLOCK(&primary_cache_mutex); \
-   } while (0)
+/* Make the sieve for a cache going from cursize to padded_n. */
+static unsigned char* _new_cache_sieve(const unsigned char* cursieve, UV cursize, UV padded_n) {
+  unsigned char* sieve;
+  /* Growing keeps what we have and sieves only the new part. */
+  sieve = (padded_n > cursize)
+        ? sieve_erat30_extend(cursieve, cursize, padded_n)
+        : sieve_erat30(padded_n);
+  MPUassert(sieve != 0, "sieve returned null");
+  return sieve;
+}
 
-#endif
+#ifndef USE_ITHREADS
 
 static unsigned char* prime_cache_sieve = 0;
 static UV             prime_cache_size = 0;
+static void*          prime_cache_map = 0;
+static size_t         prime_cache_maplen = 0;
+
+static void _set_prime_cache(unsigned char* sieve, UV size, void* map, size_t maplen) {
+  _free_cache_sieve(prime_cache_sieve, prime_cache_map, prime_cache_maplen);
+  prime_cache_sieve = sieve;
+  prime_cache_size = size;
+  prime_cache_map = map;
+  prime_cache_maplen = maplen;
+}
 
 /* Erase the primary cache and fill up to n. */
-/* Note: You must have a write lock before calling this! */
 static void _erase_and_fill_prime_cache(UV n) {
-  UV padded_n;
+  UV padded_n = _grown_cache_size(n, prime_cache_size);
 
-  if (n >= (UV_MAX-_MPU_FILL_EXTRA_N))
-    padded_n = UV_MAX;
+  /* If new size isn't larger or smaller, then we're done. */
+  if (prime_cache_size == padded_n)
+    return;
+
+  if (n == 0)
+    _set_prime_cache(0, 0, 0, 0);
   else
-    padded_n = ((n + _MPU_FILL_EXTRA_N)/30)*30;
+    _set_prime_cache(_new_cache_sieve(prime_cache_sieve, prime_cache_size, padded_n), padded_n, 0, 0);
+}
+
+/*
+ * Get the size and a pointer to the cached prime sieve.
+ * Returns the maximum sieved value available.
+ * Allocates and sieves if needed.
+ *
+ * The sieve holds 30 numbers per byte, using a mod-30 wheel.
+ */
+UV get_prime_cache(UV n, const unsigned char** sieve)
+{
+  if (prime_cache_size < n)
+    _erase_and_fill_prime_cache(n);
+  MPUassert(prime_cache_size >= n, "prime cache is too small!");
+  if (sieve != 0)
+    *sieve = prime_cache_sieve;
+  return prime_cache_size;
+}
+
+static void _free_prime_cache(void) {
+  _set_prime_cache(0, 0, 0, 0);
+}
+
+#else
+
+/*
+ * Readers never take a lock.  The cache is published as one of two
+ * snapshots.  A reader bumps the reference count of the current snapshot,
+ * then checks that it is still current.  If not, it backs off and retries.
+ *
+ * A writer holds primary_cache_mutex while it builds the new sieve, so
+ * readers carry on with the old one.  It then waits for any readers left
+ * on the spare snapshot, installs the new sieve there, and makes it
+ * current.  The last reader to leave a stale snapshot frees its sieve.
+ *
+ * A thread holding the cache must release it before asking for a larger
+ * one, or it may wait on itself.
+ */
+
+#if defined(__GNUC__) && ((__GNUC__ > 4) || (__GNUC__ == 4 && __GNUC_MINOR__ >= 1))
+ #define ATOMIC_ADD(x, v)  __sync_add_and_fetch(&(x), (v))
+ #define MEMORY_BARRIER()  __sync_synchronize()
+#else
+ /* No atomics, so fall back to a mutex.  Still short, and never waits. */
+ #define USE_ATOMIC_MUTEX
+ static perl_mutex atomic_mutex;
+ static int _atomic_add(volatile int* x, int v) {
+   int r;
+   MUTEX_LOCK(&atomic_mutex);
+   r = (*x += v);
+   MUTEX_UNLOCK(&atomic_mutex);
+   return r;
+ }
+ #define ATOMIC_ADD(x, v)  _atomic_add(&(x), (v))
+ #define MEMORY_BARRIER()  do { MUTEX_LOCK(&atomic_mutex); MUTEX_UNLOCK(&atomic_mutex); } while (0)
+#endif
+
+typedef struct {
+  unsigned char* sieve;
+  UV             size;
+  void*          map;
+  size_t         maplen;
+  volatile int   readers;
+} cache_snapshot_t;
+
+static perl_mutex       primary_cache_mutex;
+static perl_cond        primary_cache_turn;
+static cache_snapshot_t cache_snap[2];
+static volatile int     cache_current = 0;
+
+/* Free a stale snapshot if nobody is using it.  Hold the mutex. */
+static void _free_stale_snapshot(int i) {
+  if (i != cache_current && ATOMIC_ADD(cache_snap[i].readers, 0) == 0 &&
+      cache_snap[i].sieve != 0) {
+    _free_cache_sieve(cache_snap[i].sieve, cache_snap[i].map, cache_snap[i].maplen);
+    cache_snap[i].sieve = 0;
+    cache_snap[i].size = 0;
+    cache_snap[i].map = 0;
+  }
+}
+
+/* Publish a new cache sieve.  Hold the mutex. */
+static void _set_prime_cache(unsigned char* sieve, UV size, void* map, size_t maplen) {
+  int cur = cache_current;
+  int next = 1 - cur;
+
+  while (ATOMIC_ADD(cache_snap[next].readers, 0) != 0)
+    COND_WAIT(&primary_cache_turn, &primary_cache_mutex);
+  _free_cache_sieve(cache_snap[next].sieve, cache_snap[next].map, cache_snap[next].maplen);
+  cache_snap[next].sieve = sieve;
+  cache_snap[next].size = size;
+  cache_snap[next].map = map;
+  cache_snap[next].maplen = maplen;
+  MEMORY_BARRIER();
+  cache_current = next;
+  MEMORY_BARRIER();
+  _free_stale_snapshot(cur);
+}
+
+/* Publish a new cache filled up to n.  Hold the mutex. */
+static void _erase_and_fill_prime_cache(UV n) {
+  int cur = cache_current;
+  UV cursize = cache_snap[cur].size;
+  UV padded_n = _grown_cache_size(n, cursize);
 
   /* If new size isn't larger or smaller, then we're done. */
-  if (prime_cache_size == padded_n)
+  if (cursize == padded_n)
     return;
 
-  if (prime_cache_sieve != 0)
-    Safefree(prime_cache_sieve);
-  prime_cache_sieve = 0;
-  prime_cache_size = 0;
+  /* The current snapshot can't go away while we hold the mutex. */
+  if (n == 0)
+    _set_prime_cache(0, 0, 0, 0);
+  else
+    _set_prime_cache(_new_cache_sieve(cache_snap[cur].sieve, cursize, padded_n), padded_n, 0, 0);
+}
+
+static void _fill_prime_cache_to(UV n) {
+  MUTEX_LOCK(&primary_cache_mutex);
+    if (cache_snap[cache_current].size < n)
+      _erase_and_fill_prime_cache(n);
+  MUTEX_UNLOCK(&primary_cache_mutex);
+}
 
-  if (n > 0) {
-    prime_cache_sieve = sieve_erat30(padded_n);
-    MPUassert(prime_cache_sieve != 0, "sieve returned null");
-    prime_cache_size = padded_n;
+static void _release_snapshot(int i) {
+  if (ATOMIC_ADD(cache_snap[i].readers, -1) == 0 && i != cache_current) {
+    MUTEX_LOCK(&primary_cache_mutex);
+      _free_stale_snapshot(i);
+      COND_BROADCAST(&primary_cache_turn);
+    MUTEX_UNLOCK(&primary_cache_mutex);
   }
 }
 
@@ -124,99 +256,139 @@ static void _erase_and_fill_prime_cache(UV n) {
  */
 UV get_prime_cache(UV n, const unsigned char** sieve)
 {
-#ifdef USE_ITHREADS
+  int i;
+
   if (sieve == 0) {
-    if (prime_cache_size < n) {
-      WRITE_LOCK_START;
-        _erase_and_fill_prime_cache(n);
-      WRITE_LOCK_END;
-    }
-    return prime_cache_size;
+    if (cache_snap[cache_current].size < n)
+      _fill_prime_cache_to(n);
+    return cache_snap[cache_current].size;
   }
 
-  /* This could be done more efficiently if we converted a write lock to a
-   * reader after doing the expansion.  But I think this solution is less
-   * error prone (though could lead to starvation in pathological cases).
-   */
-  READ_LOCK_START;
-  while (prime_cache_size < n) {
-    /* The cache isn't big enough.  Expand it. */
-    READ_LOCK_END;
-    /* thread reminder: the world can change right here */
-    WRITE_LOCK_START;
-      if (prime_cache_size < n)
-        _erase_and_fill_prime_cache(n);
-    WRITE_LOCK_END;
-    /* thread reminder: the world can change right here */
-    READ_LOCK_START;
+  while (1) {
+    i = cache_current;
+    ATOMIC_ADD(cache_snap[i].readers, 1);
+    if (i == cache_current && cache_snap[i].size >= n)
+      break;
+    /* Either a writer got in, or the cache isn't big enough. */
+    _release_snapshot(i);
+    if (i == cache_current)
+      _fill_prime_cache_to(n);
   }
-  MPUassert(prime_cache_size >= n, "prime cache is too small!");
 
-  *sieve = prime_cache_sieve;
-  return prime_cache_size;
-#else
-  if (prime_cache_size < n)
-    _erase_and_fill_prime_cache(n);
-  MPUassert(prime_cache_size >= n, "prime cache is too small!");
-  if (sieve != 0)
-    *sieve = prime_cache_sieve;
-  return prime_cache_size;
-#endif
+  *sieve = cache_snap[i].sieve;
+  return cache_snap[i].size;
 }
 
-#ifdef USE_ITHREADS
 void release_prime_cache(const unsigned char* mem) {
-  (void)mem; /* We don't currently care about the pointer */
-  READ_LOCK_END;
+  int i = (mem == cache_snap[0].sieve) ? 0 : 1;
+  MPUassert(mem == cache_snap[i].sieve, "release_prime_cache given unknown pointer");
+  _release_snapshot(i);
 }
-#endif
 
+static void _free_prime_cache(void) {
+  int i;
+  for (i = 0; i < 2; i++) {
+    _free_cache_sieve(cache_snap[i].sieve, cache_snap[i].map, cache_snap[i].maplen);
+    cache_snap[i].sieve = 0;
+    cache_snap[i].map = 0;
+    cache_snap[i].size = 0;
+    cache_snap[i].readers = 0;
+  }
+}
 
+#endif
 
-/* The segment everyone is trying to share */
-#define PRIMARY_SEGMENT_CHUNK_SIZE    UVCONST(256*1024-16)
-static unsigned char* prime_segment = 0;
-static int prime_segment_is_available = 1;
-/* If that's in use, malloc a new one of this size */
-#define SECONDARY_SEGMENT_CHUNK_SIZE  UVCONST(128*1024-16)
+
+/*
+ * Segments come from a small pool of reusable buffers, so concurrent and
+ * repeated segment users don't malloc and fault in a fresh block each time.
+ * Buffers are cache line aligned and sized to fit in L2 (see
+ * _XS_get_segment_size).  A released buffer goes back on the pool unless it
+ * is full; prime_memfree empties it.  If the segment size is changed, old
+ * buffers are replaced as they come off the pool.
+ */
+#define SEGMENT_ALIGN         64
+#define SEGMENT_POOL_MAX      8
+static unsigned char* segment_pool[SEGMENT_POOL_MAX];
+static int segment_pool_count = 0;
+static UV  segment_pool_allocs = 0;
+static UV  segment_pool_reuses = 0;
+
+/* Over-allocate and align.  The real pointer and the size are kept just
+ * before the buffer. */
+#define SEGMENT_HEADER  (sizeof(unsigned char*) + sizeof(UV))
+static unsigned char* _new_segment(UV size) {
+  unsigned char *base, *mem;
+  New(0, base, size + SEGMENT_ALIGN + SEGMENT_HEADER, unsigned char);
+  MPUassert(base != 0, "get_prime_segment allocation failure");
+  mem = base + SEGMENT_HEADER;
+  mem += (SEGMENT_ALIGN - ((UV)mem % SEGMENT_ALIGN)) % SEGMENT_ALIGN;
+  memcpy(mem - SEGMENT_HEADER, &base, sizeof(unsigned char*));
+  memcpy(mem - sizeof(UV), &size, sizeof(UV));
+  return mem;
+}
+static UV _segment_size(const unsigned char* mem) {
+  UV size;
+  memcpy(&size, mem - sizeof(UV), sizeof(UV));
+  return size;
+}
+static void _free_segment(unsigned char* mem) {
+  unsigned char* base;
+  memcpy(&base, mem - SEGMENT_HEADER, sizeof(unsigned char*));
+  Safefree(base);
+}
 
 unsigned char* get_prime_segment(UV *size) {
-  unsigned char* mem;
-  int use_prime_segment = 0;
+  unsigned char* mem = 0;
+  UV want = _XS_get_segment_size();
 
   MPUassert(size != 0, "get_prime_segment given null size pointer");
   MPUassert(mutex_init == 1, "segment mutex has not been initialized");
 
   MUTEX_LOCK(&segment_mutex);
-    if (prime_segment_is_available) {
-      prime_segment_is_available = 0;
-      use_prime_segment = 1;
+    if (segment_pool_count > 0) {
+      mem = segment_pool[--segment_pool_count];
+      segment_pool_reuses++;
+    } else {
+      segment_pool_allocs++;
     }
   MUTEX_UNLOCK(&segment_mutex);
 
-  if (use_prime_segment) {
-    if (prime_segment == 0)
-      New(0, prime_segment, PRIMARY_SEGMENT_CHUNK_SIZE, unsigned char);
-    *size = PRIMARY_SEGMENT_CHUNK_SIZE;
-    mem = prime_segment;
-  } else {
-    New(0, mem, SECONDARY_SEGMENT_CHUNK_SIZE, unsigned char);
-    *size = SECONDARY_SEGMENT_CHUNK_SIZE;
+  if (mem != 0 && _segment_size(mem) != want) {
+    _free_segment(mem);
+    mem = 0;
   }
-  MPUassert(mem != 0, "get_prime_segment allocation failure");
-
+  if (mem == 0)
+    mem = _new_segment(want);
+  *size = want;
   return mem;
 }
 
 void release_prime_segment(unsigned char* mem) {
   MUTEX_LOCK(&segment_mutex);
-    if (mem == prime_segment) {
-      prime_segment_is_available = 1;
+    if (segment_pool_count < SEGMENT_POOL_MAX) {
+      segment_pool[segment_pool_count++] = mem;
       mem = 0;
     }
   MUTEX_UNLOCK(&segment_mutex);
   if (mem)
-    Safefree(mem);
+    _free_segment(mem);
+}
+
+void get_prime_segment_stats(UV* allocs, UV* reuses, UV* pooled) {
+  MUTEX_LOCK(&segment_mutex);
+    *allocs = segment_pool_allocs;
+    *reuses = segment_pool_reuses;
+    *pooled = segment_pool_count;
+  MUTEX_UNLOCK(&segment_mutex);
+}
+
+/* Take every pooled buffer off the pool.  Caller frees them. */
+static int _drain_segment_pool(unsigned char** mems) {
+  int n = segment_pool_count;
+  memcpy(mems, segment_pool, n * sizeof(unsigned char*));
+  segment_pool_count = 0;
+  return n;
 }
 
 
@@ -225,42 +397,53 @@ void prime_precalc(UV n)
 {
   if (!mutex_init) {
     MUTEX_INIT(&segment_mutex);
+#ifdef USE_ITHREADS
     MUTEX_INIT(&primary_cache_mutex);
     COND_INIT(&primary_cache_turn);
+ #ifdef USE_ATOMIC_MUTEX
+    MUTEX_INIT(&atomic_mutex);
+ #endif
+#endif
     mutex_init = 1;
+    sieve_presieve_init();
+    _XS_detect_cache_sizes();
+    lmo_init();
+    prime_count_table_init();
   }
 
   /* On initialization, make a few primes (30k per 1k memory) */
   if (n == 0)
     n = _MPU_INITIAL_CACHE_SIZE;
   get_prime_cache(n, 0);   /* Sieve to n */
-
-  /* TODO: should we prealloc the segment here? */
 }
 
 
 void prime_memfree(void)
 {
-  unsigned char* old_segment = 0;
+  unsigned char* old_segments[SEGMENT_POOL_MAX];
+  int i, nold;
 
   /* This can happen in global destructor, and PL_dirty has porting issues */
   /* MPUassert(mutex_init == 1, "cache mutexes have not been initialized"); */
   if (mutex_init == 0) return;
 
+  /* Segments in use by other threads return to the pool when released */
   MUTEX_LOCK(&segment_mutex);
-  /* Don't free if another thread is using it */
-  if ( (prime_segment != 0) && (prime_segment_is_available) ) {\
-    unsigned char* new_segment = old_segment;
-    old_segment = prime_segment;
-    prime_segment = new_segment; /* Exchanged old_segment / prime_segment */
-  }
+    nold = _drain_segment_pool(old_segments);
   MUTEX_UNLOCK(&segment_mutex);
-  if (old_segment) Safefree(old_segment);
+  for (i = 0; i < nold; i++)
+    _free_segment(old_segments[i]);
 
-  WRITE_LOCK_START;
-    /* Put primary cache back to initial state */
+  lmo_memfree();
+
+  /* Put primary cache back to initial state */
+#ifdef USE_ITHREADS
+  MUTEX_LOCK(&primary_cache_mutex);
     _erase_and_fill_prime_cache(_MPU_INITIAL_CACHE_SIZE);
-  WRITE_LOCK_END;
+  MUTEX_UNLOCK(&primary_cache_mutex);
+#else
+  _erase_and_fill_prime_cache(_MPU_INITIAL_CACHE_SIZE);
+#endif
 }
 
 
@@ -270,15 +453,185 @@ void _prime_memfreeall(void)
   if (mutex_init) {
     mutex_init = 0;
     MUTEX_DESTROY(&segment_mutex);
+#ifdef USE_ITHREADS
     MUTEX_DESTROY(&primary_cache_mutex);
     COND_DESTROY(&primary_cache_turn);
+ #ifdef USE_ATOMIC_MUTEX
+    MUTEX_DESTROY(&atomic_mutex);
+ #endif
+#endif
   }
-  if (prime_cache_sieve != 0)
-    Safefree(prime_cache_sieve);
-  prime_cache_sieve = 0;
-  prime_cache_size = 0;
-
-  if (prime_segment != 0)
-    Safefree(prime_segment);
-  prime_segment = 0;
+  _free_prime_cache();
+  lmo_memfreeall();
+
+  {
+    unsigned char* old_segments[SEGMENT_POOL_MAX];
+    int i, nold = _drain_segment_pool(old_segments);
+    for (i = 0; i < nold; i++)
+      _free_segment(old_segments[i]);
+  }
+}
+
+
+/*
+ * Sieve files let several processes share one primary cache.  A file is a
+ * 64 byte header followed by the wheel-30 sieve bytes exactly as they are
+ * held in memory.  Header fields are native endian; a file from a machine
+ * with a different byte order is rejected.  Loading maps the file read-only
+ * where we can, so the pages are shared through the page cache.
+ */
+#define SIEVE_FILE_MAGIC      "MPUSV30"
+#define SIEVE_FILE_VERSION    1
+#define SIEVE_FILE_BYTEORDER  0x01020304
+#define SIEVE_FILE_HEADER     64
+
+typedef struct {
+  char          magic[8];
+  uint32_t      version;
+  uint32_t      byteorder;
+  uint64_t      limit;
+  uint64_t      nbytes;
+  uint64_t      checksum;
+  unsigned char pad[SIEVE_FILE_HEADER - 40];
+} sieve_file_header_t;
+
+/* Bytes used by a sieve to limit, matching sieve_erat30. */
+static UV _sieve_bytes(UV limit) {
+  UV nbytes = (limit/30) + ((limit%30) != 0);
+  return ((nbytes + sizeof(UV) - 1) / sizeof(UV)) * sizeof(UV);
+}
+
+/* Fletcher style checksum over 32-bit words. */
+static uint64_t _sieve_checksum(const unsigned char* mem, UV nbytes) {
+  uint64_t a = 1, b = 0;
+  UV i;
+  for (i = 0; i+4 <= nbytes; i += 4) {
+    uint32_t w;
+    memcpy(&w, mem+i, 4);
+    a += w;
+    b += a;
+  }
+  for ( ; i < nbytes; i++) {
+    a += mem[i];
+    b += a;
+  }
+  return a ^ (b << 32) ^ (b >> 32);
+}
+
+static int _valid_sieve_header(const sieve_file_header_t* h, UV filesize) {
+  if (memcmp(h->magic, SIEVE_FILE_MAGIC, 8) != 0)  return 0;
+  if (h->version != SIEVE_FILE_VERSION)            return 0;
+  if (h->byteorder != SIEVE_FILE_BYTEORDER)        return 0;
+  if (h->limit == 0 || (uint64_t)(UV)h->limit != h->limit)  return 0;
+  if (h->nbytes < _sieve_bytes((UV)h->limit))      return 0;
+  if (h->nbytes > filesize - SIEVE_FILE_HEADER)    return 0;
+  return 1;
+}
+
+int prime_cache_save(const char* filename)
+{
+  const unsigned char* sieve;
+  sieve_file_header_t h;
+  UV size, nbytes;
+  char* tmpname;
+  FILE* fp;
+  int ok = 0;
+
+  MPUassert(filename != 0, "prime_cache_save given null filename");
+  /* Write to a temporary and rename, so anyone with the old file mapped
+   * keeps a valid mapping. */
+  New(0, tmpname, strlen(filename) + 32, char);
+#ifdef MPU_HAVE_MMAP
+  sprintf(tmpname, "%s.tmp%lu", filename, (unsigned long) getpid());
+#else
+  sprintf(tmpname, "%s.tmp", filename);
+#endif
+
+  size = get_prime_cache(0, &sieve);
+  nbytes = _sieve_bytes(size);
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, SIEVE_FILE_MAGIC, 8);
+  h.version = SIEVE_FILE_VERSION;
+  h.byteorder = SIEVE_FILE_BYTEORDER;
+  h.limit = size;
+  h.nbytes = nbytes;
+  h.checksum = _sieve_checksum(sieve, nbytes);
+
+  fp = fopen(tmpname, "wb");
+  if (fp != 0) {
+    ok = (fwrite(&h, sizeof(h), 1, fp) == 1)
+      && (fwrite(sieve, 1, nbytes, fp) == nbytes);
+    ok = (fclose(fp) == 0) && ok;
+  }
+  release_prime_cache(sieve);
+
+#ifndef MPU_HAVE_MMAP
+  if (ok) remove(filename);   /* rename won't replace on Win32 */
+#endif
+  if (ok) ok = (rename(tmpname, filename) == 0);
+  if (!ok) remove(tmpname);
+  Safefree(tmpname);
+  return ok;
+}
+
+UV prime_cache_load(const char* filename)
+{
+  sieve_file_header_t h;
+  unsigned char* sieve;
+  void* map;
+  size_t maplen;
+
+  MPUassert(filename != 0, "prime_cache_load given null filename");
+  {
+#ifdef MPU_HAVE_MMAP
+    struct stat st;
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)  return 0;
+    if (fstat(fd, &st) != 0 || st.st_size < SIEVE_FILE_HEADER ||
+        (uint64_t)st.st_size != (uint64_t)(size_t)st.st_size) {
+      close(fd);
+      return 0;
+    }
+    maplen = (size_t) st.st_size;
+    map = mmap(0, maplen, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)  return 0;
+    memcpy(&h, map, sizeof(h));
+    if (!_valid_sieve_header(&h, maplen)) {
+      munmap(map, maplen);
+      return 0;
+    }
+#else
+    FILE* fp = fopen(filename, "rb");
+    if (fp == 0)  return 0;
+    if (fread(&h, sizeof(h), 1, fp) != 1 || !_valid_sieve_header(&h, UV_MAX) ||
+        (uint64_t)(size_t)h.nbytes != h.nbytes) {
+      fclose(fp);
+      return 0;
+    }
+    maplen = SIEVE_FILE_HEADER + (size_t)h.nbytes;
+    New(0, map, maplen, unsigned char);
+    memcpy(map, &h, sizeof(h));
+    if (fread((unsigned char*)map + SIEVE_FILE_HEADER, 1, h.nbytes, fp) != h.nbytes) {
+      fclose(fp);
+      Safefree(map);
+      return 0;
+    }
+    fclose(fp);
+#endif
+  }
+  sieve = (unsigned char*)map + SIEVE_FILE_HEADER;
+  if (_sieve_checksum(sieve, h.nbytes) != h.checksum) {
+    _free_cache_sieve(sieve, map, maplen);
+    return 0;
+  }
+
+#ifdef USE_ITHREADS
+  MUTEX_LOCK(&primary_cache_mutex);
+    _set_prime_cache(sieve, (UV)h.limit, map, maplen);
+  MUTEX_UNLOCK(&primary_cache_mutex);
+#else
+  _set_prime_cache(sieve, (UV)h.limit, map, maplen);
+#endif
+  return (UV)h.limit;
 }
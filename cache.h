@@ -35,9 +35,17 @@ extern void release_prime_cache(const unsigned char* sieve);
  #define release_prime_cache(mem)
 #endif
 
+  /* Write the primary cache to a sieve file.  Returns 1 on success. */
+extern int prime_cache_save(const char* filename);
+  /* Replace the primary cache with one from a sieve file, mapping it
+   * read-only if possible.  Returns the new cache size, or 0 on failure. */
+extern UV  prime_cache_load(const char* filename);
+
   /* Get the segment cache.  Set size to its size. */
 extern unsigned char* get_prime_segment(UV* size);
   /* Inform the system we're done using the segment cache. */
 extern void release_prime_segment(unsigned char* segment);
+  /* Segment pool counts: buffers allocated, reused, and now pooled. */
+extern void get_prime_segment_stats(UV* allocs, UV* reuses, UV* pooled);
 
 #endif
@@ -0,0 +1,26 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+use Math::Prime::Util::PrimeGapFile;
+
+# Scan a prime gap file for maximal gaps, without sieving again.  The
+# output is "<gapsize>  <merit>  <P1>", which verify-primegaps.pl reads.
+#
+# Make a file first, e.g.:
+#   perl -MMath::Prime::Util::PrimeGapFile -E \
+#     'Math::Prime::Util::PrimeGapFile->write("p.gaps", 1e12, 1e12+1e10)'
+
+my $file = shift or die "usage: $0 <prime gap file> [min gap]\n";
+my $mingap = shift || 0;
+my $pf = Math::Prime::Util::PrimeGapFile->new($file);
+
+my($prev, $maxgap) = (0, $mingap);
+while (length(my $s = $pf->next_packed(1_000_000))) {
+  foreach my $p (unpack("J*", $s)) {
+    if ($prev && $p - $prev > $maxgap) {
+      $maxgap = $p - $prev;
+      printf "%d  %.2f  %d\n", $maxgap, $maxgap / log($prev), $prev;
+    }
+    $prev = $p;
+  }
+}
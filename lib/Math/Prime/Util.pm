@@ -13,7 +13,8 @@ BEGIN {
 use base qw( Exporter );
 our @EXPORT_OK =
   qw( prime_get_config prime_set_config
-      prime_precalc prime_memfree
+      prime_precalc prime_memfree prime_cache_save prime_cache_load
+      prime_count_table_save prime_count_table_load
       is_prime is_prob_prime is_provable_prime is_provable_prime_with_cert
       prime_certificate verify_prime
       is_pseudoprime is_strong_pseudoprime
@@ -31,13 +32,14 @@ our @EXPORT_OK =
       miller_rabin_random
       lucas_sequence lucasu lucasv
       primes twin_primes ramanujan_primes
-      forprimes forcomposites foroddcomposites fordivisors
+      primes_packed twin_primes_packed ramanujan_primes_packed
+      forprimes forprimes_block forcomposites foroddcomposites fordivisors
       forpart forcomb forperm
       prime_iterator prime_iterator_object
       next_prime  prev_prime
-      prime_count
+      prime_count prime_count_multi
       prime_count_lower prime_count_upper prime_count_approx
-      nth_prime nth_prime_lower nth_prime_upper nth_prime_approx
+      nth_prime nth_prime_multi nth_prime_lower nth_prime_upper nth_prime_approx
       twin_prime_count twin_prime_count_approx
       nth_twin_prime nth_twin_prime_approx
       nth_ramanujan_prime
@@ -50,6 +52,7 @@ our @EXPORT_OK =
       gcd lcm factor factor_exp divisors valuation invmod hammingweight
       vecsum vecmin vecmax vecprod vecreduce vecextract
       moebius mertens euler_phi jordan_totient exp_mangoldt liouville
+      moebius_packed euler_phi_packed
       partitions bernfrac bernreal harmfrac harmreal
       chebyshev_theta chebyshev_psi
       divisor_sum carmichael_lambda kronecker
@@ -139,6 +142,7 @@ $_Config{'assume_rh'}   = 0;
 $_Config{'verbose'}     = 0;
 $_Config{'irand'}       = undef;
 $_Config{'use_primeinc'} = 0;
+$_Config{'threads'}     = 1;
 
 # used for code like:
 #    return _XS_foo($n)  if $n <= $_XS_MAXVAL
@@ -158,6 +162,10 @@ sub prime_get_config {
   $config{'precalc_to'} = ($_Config{'xs'})
                         ? _get_prime_cache_size()
                         : Math::Prime::Util::PP::_get_prime_cache_size();
+  if ($_Config{'xs'}) {
+    $config{"l${_}_cache"} = _XS_get_cache_size($_) for 1..3;
+    $config{'segment_size'} = _XS_get_segment_size();
+  }
 
   return \%config;
 }
@@ -194,6 +202,21 @@ sub prime_set_config {
       $_Config{'verbose'} = $value;
       _XS_set_verbose($value) if $_Config{'xs'};
       Math::Prime::Util::GMP::_GMP_set_verbose($value) if $_Config{'gmp'};
+    } elsif ($param eq 'threads') {
+      croak "Invalid setting for threads.  1, 2, 3, etc."
+        unless defined $value && $value =~ /^\d+$/ && $value >= 1 && $value <= 1024;
+      $_Config{'threads'} = $value;
+      _XS_set_threads($value) if $_Config{'xs'};
+    } elsif ($param =~ /^l([123])_cache$/) {
+      my $level = $1;
+      croak "Invalid setting for $param.  Size in bytes."
+        unless defined $value && $value =~ /^\d+$/ && $value >= 1024;
+      _XS_set_cache_size($level, $value) if $_Config{'xs'};
+    } elsif ($param eq 'segment_size') {
+      croak "Invalid setting for segment_size.  0 or 1024 to 268435456."
+        unless defined $value && $value =~ /^\d+$/
+            && ($value == 0 || ($value >= 1024 && $value <= 268435456));
+      _XS_set_segment_size($value) if $_Config{'xs'};
     } else {
       croak "Unknown or invalid configuration setting: $param\n";
     }
@@ -357,6 +380,62 @@ sub ramanujan_primes {
   return _ramanujan_primes($low, $high);
 }
 
+# Packed versions.  The optional buffer is passed on as $_[2] so the XS code
+# (or _pack_list) writes into the caller's scalar.
+sub _validate_packed_range {
+  my($low,$high) = @_;
+  _validate_num($low) || _validate_positive_integer($low);
+  _validate_num($high) || _validate_positive_integer($high);
+  croak "Packed output is limited to native integers" if $high > ~0;
+}
+sub _pack_list {
+  my($fmt, $aref) = @_;
+  my $str = pack("$fmt*", @$aref);
+  return $str if scalar @_ < 3;
+  $_[2] = $str;
+  return scalar @$aref;
+}
+
+sub primes_packed {
+  my($low,$high) = @_;
+  _validate_packed_range($low,$high);
+  return _pack_list('J', primes($low,$high), @_[2..$#_])
+    if $high > $_XS_MAXVAL;
+  return _trial_primes_packed($low, $high, @_[2..$#_])
+    if ($low+1) >= $high || $high > 10**14 && ($high-$low) < 50000;
+  return _sieve_primes_packed($low, $high, @_[2..$#_])
+    if $high <= (65536*30) || $high <= _get_prime_cache_size();
+  return _segment_primes_packed($low, $high, @_[2..$#_]);
+}
+sub twin_primes_packed {
+  my($low,$high) = @_;
+  _validate_packed_range($low,$high);
+  return _pack_list('J', twin_primes($low,$high), @_[2..$#_])
+    if $high > $_XS_MAXVAL;
+  return _segment_twin_primes_packed($low, $high, @_[2..$#_]);
+}
+sub ramanujan_primes_packed {
+  my($low,$high) = @_;
+  _validate_packed_range($low,$high);
+  return _pack_list('J', ramanujan_primes($low,$high), @_[2..$#_])
+    if $high > $_XS_MAXVAL;
+  return _ramanujan_primes_packed($low, $high, @_[2..$#_]);
+}
+sub euler_phi_packed {
+  my($low,$high) = @_;
+  _validate_packed_range($low,$high);
+  return _pack_list('J', [$low <= $high ? euler_phi($low,$high) : ()], @_[2..$#_])
+    if $high > $_XS_MAXVAL;
+  return _euler_phi_packed($low, $high, @_[2..$#_]);
+}
+sub moebius_packed {
+  my($low,$high) = @_;
+  _validate_packed_range($low,$high);
+  return _pack_list('c', [$low <= $high ? moebius($low,$high) : ()], @_[2..$#_])
+    if $high > $_XS_MAXVAL;
+  return _moebius_packed($low, $high, @_[2..$#_]);
+}
+
 #############################################################################
 # Random primes.  These are front end functions that do input validation,
 # load the RandomPrimes module, and call its function.
@@ -536,6 +615,24 @@ sub _generic_forprimes {
   }
 }
 
+sub _generic_forprimes_block {
+  my($sub, $beg, $end) = @_;
+  if (!defined $end) { $end = $beg; $beg = 2; }
+  _validate_packed_range($beg, $end);
+  $beg = 2 if $beg < 2;
+  {
+    my $pp;
+    local *_ = \$pp;
+    while ($beg <= $end) {
+      my $hi = ($end - $beg < 999_999) ? $end : $beg + 999_999;
+      $pp = primes_packed($beg, $hi);
+      $sub->($beg, $hi);
+      last if $hi >= $end;
+      $beg = $hi+1;
+    }
+  }
+}
+
 sub _generic_forcomposites {
   my($sub, $beg, $end) = @_;
   if (!defined $end) { $end = $beg; $beg = 4; }
@@ -1236,6 +1333,27 @@ or a tied array (L<Math::Prime::Util::PrimeArray>) may be more convenient.
 Objects can be passed to functions, and allow early loop exits.
 
 
+=head2 forprimes_block
+
+  # count primes to 10^10, a sieve segment at a time
+  my $uvsize = length(pack("J",0));
+  $n = 0;  forprimes_block { $n += length($_) / $uvsize } 10**10;
+
+  # largest gap in each segment
+  forprimes_block {
+    my($lo, $hi) = @_;
+    my @p = unpack("J*", $_);
+    my $max = vecmax(map { $p[$_] - $p[$_-1] } 1 .. $#p);
+    say "$lo-$hi: $max" if @p > 1;
+  } 10**9;
+
+Like L</forprimes>, but calls the block once for each sieve segment rather
+than once for each prime.  C<$_> holds all the primes in the segment packed
+as in L</primes_packed>, and the block's arguments are the low and high ends
+of the segment.  The segments cover the range in order with no gaps.  Blocks
+doing aggregate work on the primes (sums, histograms, gaps) avoid the per-prime
+call entirely.  The range must fit in a native integer.
+
 =head2 forcomposites
 
   forcomposites { say } 1000;
@@ -1388,17 +1506,33 @@ is proportional only to C<sqrt(a)>, with total memory use under 1MB for any
 base under C<10^14>.
 
 The extended LMO method has complexity approximately
-C<O(b^(2/3)) + O(a^(2/3))>, and also uses low memory.
+C<O(b^(2/3)) + O(a^(2/3))>, and also uses low memory.  The easy leaves
+(as split by Deléglise and Rivat) are counted from a table of primes
+rather than the phi sieve, but this is LMO, not their full method.
 A calculation of C<Pi(10^14)> completes in a few seconds, C<Pi(10^15)>
 in well under a minute, and C<Pi(10^16)> in about one minute.  In
 contrast, even parallel primesieve would take over a week on a
-similar machine to determine C<Pi(10^16)>.
+similar machine to determine C<Pi(10^16)>.  Setting the C<threads>
+config option spreads the LMO phi sieve over that many threads.
+With a table loaded by L</prime_count_table_load>, counts inside it
+only sieve from the nearest checkpoint.
 
 Also see the function L</prime_count_approx> which gives a very good
 approximation to the prime count, and L</prime_count_lower> and
 L</prime_count_upper> which give tight bounds to the actual prime count.
 These functions return quickly for any input, including bigints.
 
+=head2 prime_count_multi
+
+  my @pi = prime_count_multi([10**9, 2*10**9, 2*10**9+10**6, 17]);
+
+Given an array reference of non-negative integers, returns the list of
+their prime counts in the same order.  This gives the same results as
+calling L</prime_count> on each, but values close together share the
+work: one full count is done for the smallest of them, and the rest are
+found by sieving forward from it.  Values far apart are each counted
+separately.
+
 
 =head2 prime_count_upper
 
@@ -1496,6 +1630,39 @@ like them, returns an array reference.
 Generating Ramanujan primes takes some effort, including overhead to cover
 a range.  This will be substantially slower than generating standard primes.
 
+=head2 primes_packed
+
+  my $str = primes_packed(1, 1_000_000_000);        # 50847534 primes
+  my @first = unpack("J10", $str);
+  my $uvsize = length(pack("J",0));
+  my $p = unpack("J", substr($str, 1000*$uvsize, $uvsize));   # 1001st prime
+  print $fh $str;                                   # straight to a file
+
+  my $n = primes_packed($lo, $hi, $buf);            # fill $buf, get count
+
+Returns the primes between the lower and upper limits (inclusive) packed
+into a string of native-endian unsigned integers, one per prime in the size
+of Perl's UV (the C<J> format of L<perlfunc/pack>).  No Perl scalar is made
+for each prime, so this is much faster and uses about a fifth of the memory
+of L</primes> for large ranges, and the string can go straight to a file,
+L<PDL>, or C<unpack>.  Note that C<vec> reads big-endian values, so it
+does not give the primes on most machines.
+
+If a third argument is given, the primes are written into that scalar, reusing
+its buffer when it is large enough, and the number of primes is returned.
+
+L</twin_primes_packed> and L</ramanujan_primes_packed> work the same way for
+L</twin_primes> and L</ramanujan_primes>.  Both limits must be given, and the
+results must fit in a native integer.
+
+=head2 twin_primes_packed
+
+Like L</primes_packed> for the lesser of twin primes.
+
+=head2 ramanujan_primes_packed
+
+Like L</primes_packed> for Ramanujan primes.
+
 =head2 sum_primes
 
 Returns the summation of primes between the lower and upper limits
@@ -1506,14 +1673,19 @@ essentially similar to either of:
     # or
     vecsum( @{ primes($low,$high) } );
 
-but is somewhat more efficient (about 2-4x compared to forprimes, more
-for vecsum since no large list is created).
+but is much more efficient.  Narrow ranges are sieved, and otherwise a
+sublinear method (Lucy_Hedgehog's, in C with 128-bit sums) is used, taking
+about one second at C<10^12> and half a minute at C<10^14>, with memory
+growing as the square root of the upper limit.  Wide ranges ending past
+C<10^16> are summed by sieving instead.  The result is a
+L<Math::BigInt> object when it doesn't fit in a native integer.
 
 =head2 print_primes
 
   print_primes(1_000_000);             # print the first 1 million primes
   print_primes(1000, 2000);            # print primes in range
   print_primes(2,1000,fileno(STDERR))  # print to a different descriptor
+  print_primes(2,10**9,fileno($fh),"delta")  # compact binary file
 
 With a single argument this prints all primes from 2 to C<n> to standard
 out.  With two arguments it prints primes between C<low> and C<high> to
@@ -1524,10 +1696,37 @@ produce identical output to:
 
     forprimes { say } $low,$high;
 
+An optional fourth argument selects the output format:
+
+=over 4
+
+=item text
+
+The default, one prime per line in decimal.
+
+=item le64
+
+Each prime as a 64-bit little-endian integer.  Read back with
+C<unpack("QE<lt>*", $data)>.
+
+=item delta
+
+The difference of each prime from the one before it (from 0 for the
+first), in the BER compressed integer format of C<pack("w")>.  Most
+differences take one byte.  Read back with
+C<< $p = 0;  @primes = map { $p += $_ } unpack("w*", $data) >>.
+
+=back
+
 The point of this function is just efficiency.  It is over 10x faster
 than using C<say>, C<print>, or C<printf>, though much more limited
-in functionality.  A later version may allow a file handle as the third
-argument.
+in functionality.  With L</prime_set_config> C<threads> set, segments are
+sieved and formatted in parallel and written in order.  A later version may
+allow a file handle as the third argument.
+
+For lists that will be read back many times, or read from the middle, see
+L<Math::Prime::Util::PrimeGapFile>, which stores gaps in the same way along
+with checkpoints for random access.
 
 
 =head2 nth_prime
@@ -1539,8 +1738,8 @@ another way, this returns the smallest C<p> such that C<Pi(p) E<gt>= n>.
 
 For relatively small inputs (below 1 million or so), this does a sieve over
 a range containing the nth prime, then counts up to the number.  This is fairly
-efficient in time and memory.  For larger values, create a low-biased estimate
-using the inverse logarithmic integral, use a fast prime count, then sieve in
+efficient in time and memory.  For larger values, estimate it with the inverse
+of Riemann's R, use a fast prime count, then sieve forwards or backwards over
 the small difference.
 
 While this method is thousands of times faster than generating primes, and
@@ -1556,6 +1755,15 @@ result will take a very long time.  A later version of
 L<Math::Prime::Util::GMP> may include this functionality which would help for
 32-bit machines.
 
+=head2 nth_prime_multi
+
+  my @p = nth_prime_multi([10**8, 10**8+1000, 10**8+5000]);
+
+Given an array reference of non-negative integers, returns the list of
+the nth primes in the same order, the same as calling L</nth_prime> on
+each.  Indices close together share the work, with one L</nth_prime> for
+the smallest and a single sieve forward to the rest.
+
 
 =head2 nth_prime_upper
 
@@ -2467,6 +2675,23 @@ function returns an array with the totient of every n from low to high
 inclusive.
 
 
+=head2 euler_phi_packed
+
+  my $str = euler_phi_packed(0, 10_000_000);
+  my $n = euler_phi_packed($lo, $hi, $buf);
+
+Returns the totients from C<low> to C<high> inclusive as a string of native
+unsigned integers, in the same format as L</primes_packed>.  If a third
+argument is given the result is written into it and the count is returned.
+
+=head2 moebius_packed
+
+  my @mu = unpack("c*", moebius_packed(1, 1000));
+
+Returns the Möbius function from C<low> to C<high> inclusive as a string of
+signed bytes (the C<c> format of L<perlfunc/pack>).  If a third argument is
+given the result is written into it and the count is returned.
+
 =head2 jordan_totient
 
   say "Jordan's totient J_$k($n) is ", jordan_totient($k, $n);
@@ -3049,7 +3274,69 @@ specified number.
 Frees any extra memory the module may have allocated.  Like with
 C<prime_precalc>, it is not necessary to call this, but if you're done
 making calls, or want things cleanup up, you can use this.  The object method
-might be a better choice for complicated uses.
+might be a better choice for complicated uses.  This includes the tables and
+recent results that L</prime_count> keeps between large counts.
+
+=head2 prime_cache_save
+
+  prime_precalc(10_000_000_000);
+  prime_cache_save("/var/tmp/primes.sieve") or die "Could not save sieve";
+
+Writes the cached prime sieve to the given file, with a small header
+giving its limit and a checksum.  Returns 1 on success and 0 on failure.
+The file is written under a temporary name and then renamed, so processes
+that already have the old file loaded are not disturbed.  Without XS there
+is no sieve to save and 0 is returned.
+
+=head2 prime_cache_load
+
+  my $limit = prime_cache_load("/var/tmp/primes.sieve");
+
+Replaces the cached prime sieve with one written by L</prime_cache_save>,
+returning the limit of the new cache, or 0 if the file could not be used.
+The file is memory mapped read-only where the system allows it, so this is
+nearly instant and many processes loading the same file share its pages.
+Files are rejected if the header, byte order, or checksum don't match.
+The cache still grows as needed past the file's limit, and
+L</prime_memfree> will return it to its initial small size.
+
+=head2 prime_count_table_save
+
+  prime_count_table_save("/var/tmp/pi.table", 0, 10**12, 30_000_000) or die;
+
+Computes the prime count at every multiple of the interval (default
+30 million, and always a multiple of 30) from C<lo> to C<hi>, and writes
+them to the file.  Counts are stored as second differences, which take
+about two bytes each, so the table above is about 66k.  The first
+checkpoint is counted directly, and each one after it adds a sieve of its
+interval, except near zero, where counting directly is faster.  Returns 1
+on success and 0 on failure.  The file is written under a temporary name
+and then renamed.
+
+No table is shipped with the module, and the build doesn't make one, so
+until one is saved and loaded, counts past the small built-in tables cost
+a full count.  The F<xt/pctable.pl> script builds a table and checks every
+checkpoint, and is run on a table to C<3 * 10^9> by F<t/53-pctable.t> when
+C<EXTENDED_TESTING> is set.
+
+=head2 prime_count_table_load
+
+  my $last = prime_count_table_load("/var/tmp/pi.table");
+
+Uses a table written by L</prime_count_table_save>, returning its last
+checkpoint, or 0 if the file could not be used.  The file is memory mapped
+read-only where the system allows.  Files with a bad header or byte order
+are rejected, as are files whose counts don't agree with the block index
+or have impossible differences.  The first checkpoint is then counted
+directly and the intervals before eight checkpoints spread over the table
+(including the last) are sieved, so a table of wrong counts is very likely
+rejected, though only the full check in F<xt/pctable.pl> is certain.
+
+After loading, L</prime_count> and L</nth_prime> for values inside the
+table only sieve from the nearest checkpoint, if that is closer than 1%
+of the value, which also speeds up L<Math::Prime::Util::PrimeArray>
+random access.  The table stays loaded until exit, and a new load
+replaces it.
 
 =head2 Math::Prime::Util::MemFree->new
 
@@ -3081,6 +3368,11 @@ the configuration, so changing it has no effect.  The settings include:
   maxprimeidx     the index of maxprime, without bigint
   assume_rh       whether to assume the Riemann hypothesis (default 0)
   use_primeinc    allow the PRIMEINC random prime algorithm
+  threads         number of threads used for sieving and LMO (default 1)
+  l1_cache        data cache sizes in bytes, found when the module loads
+  l2_cache
+  l3_cache
+  segment_size    bytes in a sieve segment, derived from l2_cache
 
 =head2 prime_set_config
 
@@ -3122,6 +3414,27 @@ Allows setting of some parameters.  Currently the only parameters are:
                to be used.  This can be 2-4x faster than the default
                methods, but gives bad uniformity.
 
+  threads      The number of threads used when sieving large ranges in
+               segments, as done by L</prime_count>, L</twin_prime_count>,
+               L</sum_primes>, L</print_primes>, and L</primes>.
+               Segments are sieved by worker threads and handed back in
+               order, so results are unchanged.  The phi sieve of the
+               LMO prime count used for large L</prime_count> and
+               L</nth_prime> values is also split over the threads.
+               This defaults to 1, meaning no extra threads.  It has no
+               effect if the module was built without pthreads.
+
+  l1_cache     The data cache sizes in bytes.  These are read from the
+  l2_cache     system when the module is loaded, with defaults of 32k
+  l3_cache     and 256k for L1 and L2 if they can't be found.  Sieve
+               segments and the LMO phi sieve are sized from l2_cache.
+
+  segment_size The size in bytes of a sieve segment.  Setting this to 0
+               (the default) uses half of l2_cache, but not less than
+               l1_cache or 32k, nor more than 4M.
+               Ranges above 10^11 pick their own size based on the
+               number of sieving primes.
+
 
 =head1 FACTORING FUNCTIONS
 
@@ -69,6 +69,11 @@ sub prime_memfree {
   Math::MPFR::Rmpfr_free_cache() if defined $Math::MPFR::VERSION;
 }
 sub _get_prime_cache_size { $_precalc_size }
+# There is no sieve cache or prime count table to save or load without XS.
+sub prime_cache_save { 0 }
+sub prime_cache_load { 0 }
+sub prime_count_table_save { 0 }
+sub prime_count_table_load { 0 }
 sub _prime_memfreeall { prime_memfree; }
 
 
@@ -1113,6 +1118,16 @@ sub prime_count {
   return $count;
 }
 
+sub prime_count_multi {
+  my($aref) = @_;
+  return map { Math::Prime::Util::prime_count($_) } @$aref;
+}
+
+sub nth_prime_multi {
+  my($aref) = @_;
+  return map { Math::Prime::Util::nth_prime($_) } @$aref;
+}
+
 
 sub nth_prime {
   my($n) = @_;
@@ -1530,20 +1545,31 @@ sub sum_primes {
   $sum;
 }
 sub print_primes {
-  my($low,$high,$fd) = @_;
+  my($low,$high,$fd,$format) = @_;
   if (defined $high) { _validate_positive_integer($low); }
   else               { ($low,$high) = (2, $low);         }
   _validate_positive_integer($high);
+  $format = 'text' unless defined $format;
+  croak "print_primes format must be text, le64, or delta"
+    unless $format =~ /^(text|le64|delta)$/;
 
   $fd = fileno(STDOUT) unless defined $fd;
   open(my $fh, ">>&=", $fd);  # TODO .... or die
+  binmode($fh) if $format ne 'text';
 
   if ($high >= $low) {
-    my $p1 = $low;
+    my($p1, $last) = ($low, 0);
     while ($p1 <= $high) {
       my $p2 = $p1 + 10_000_000;
       $p2 = $high if $p2 > $high;
-      print $fh join("\n", @{primes($p1,$p2)}), "\n";
+      my $list = primes($p1,$p2);
+      if ($format eq 'le64') {
+        print $fh pack("V2" x @$list, map { (int($_ % 4294967296), int($_ / 4294967296)) } @$list);
+      } elsif ($format eq 'delta') {
+        print $fh pack("w*", map { my $d = $_ - $last; $last = $_; $d } @$list);
+      } elsif (@$list) {
+        print $fh join("\n", @$list), "\n";
+      }
       $p1 = $p2+1;
     }
   }
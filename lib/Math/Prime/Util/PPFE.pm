@@ -14,6 +14,10 @@ use Carp qw/carp croak confess/;
 *_prime_memfreeall = \&Math::Prime::Util::PP::_prime_memfreeall;
 *prime_memfree  = \&Math::Prime::Util::PP::prime_memfree;
 *prime_precalc  = \&Math::Prime::Util::PP::prime_precalc;
+*prime_cache_save = \&Math::Prime::Util::PP::prime_cache_save;
+*prime_cache_load = \&Math::Prime::Util::PP::prime_cache_load;
+*prime_count_table_save = \&Math::Prime::Util::PP::prime_count_table_save;
+*prime_count_table_load = \&Math::Prime::Util::PP::prime_count_table_load;
 
 
 sub moebius {
@@ -86,6 +90,18 @@ sub nth_prime {
   _validate_positive_integer($n);
   return Math::Prime::Util::PP::nth_prime($n);
 }
+sub prime_count_multi {
+  my($aref) = @_;
+  croak "prime_count_multi argument must be an array reference"
+    unless ref($aref) eq 'ARRAY';
+  return Math::Prime::Util::PP::prime_count_multi(@_);
+}
+sub nth_prime_multi {
+  my($aref) = @_;
+  croak "nth_prime_multi argument must be an array reference"
+    unless ref($aref) eq 'ARRAY';
+  return Math::Prime::Util::PP::nth_prime_multi(@_);
+}
 sub nth_prime_lower {
   my($n) = @_;
   _validate_positive_integer($n);
@@ -132,8 +148,8 @@ sub sum_primes {
   return Math::Prime::Util::PP::sum_primes($low,$high);
 }
 sub print_primes {
-  my($low,$high,$fd) = @_;
-  return Math::Prime::Util::PP::print_primes($low,$high,$fd);
+  my($low,$high,$fd,$format) = @_;
+  return Math::Prime::Util::PP::print_primes($low,$high,$fd,$format);
 }
 sub twin_prime_count_approx {
   my($n) = @_;
@@ -536,6 +552,10 @@ sub forprimes (&$;$) {    ## no critic qw(ProhibitSubroutinePrototypes)
   }
 }
 
+sub forprimes_block (&$;$) {    ## no critic qw(ProhibitSubroutinePrototypes)
+  return _generic_forprimes_block(@_);
+}
+
 sub forcomposites(&$;$) { ## no critic qw(ProhibitSubroutinePrototypes)
   my($sub, $beg, $end) = @_;
   if (!defined $end) { $end = $beg; $beg = 4; }
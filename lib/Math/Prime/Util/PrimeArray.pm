@@ -19,17 +19,30 @@ use Tie::Array;
 use Carp qw/carp croak confess/;
 
 use constant SEGMENT_SIZE  =>  10_000;
+use constant MAX_INDEX     =>  0x7FFF_FFFF;
+use constant DEFAULT_MEMORY => 1_048_576;
 
 sub TIEARRAY {
-  my $class = shift;
-  if (@_) {
-    croak "usage: tie ARRAY, '" . __PACKAGE__ . "";
+  my ($class, %opts) = @_;
+  my $memory = DEFAULT_MEMORY;
+  foreach my $opt (keys %opts) {
+    if ($opt eq 'memory') {
+      $memory = $opts{$opt};
+      croak "memory must be a positive integer number of bytes"
+        unless defined $memory && $memory =~ /^\d+$/ && $memory > 0;
+    } else {
+      croak "usage: tie ARRAY, '" . __PACKAGE__ . "' [, memory => bytes]";
+    }
   }
   return bless {
     # used to keep track of shift
     SHIFTINDEX => 0,
     # Remove all extra prime memory when we go out of scope
     MEMFREE    => Math::Prime::Util::MemFree->new,
+    # With XS, checkpoints and decoded blocks of primes, kept in a string
+    PA         => (Math::Prime::Util::prime_get_config->{'xs'})
+                  ? Math::Prime::Util::_prime_array_new($memory, MAX_INDEX)
+                  : undef,
     # A chunk of primes
     PRIMES     => [2, 3, 5, 7, 11, 13, 17],
     # What's the index of the first one?
@@ -46,7 +59,7 @@ sub STORESIZE { carp "You cannot write to the prime array"; }
 sub EXISTS    { 1 }
 #sub EXTEND    { my $self = shift; my $count = shift; prime_precalc($count); }
 sub EXTEND    { 1 }
-sub FETCHSIZE { 0x7FFF_FFFF }   # Even on 64-bit
+sub FETCHSIZE { MAX_INDEX }   # Even on 64-bit
 # Simple FETCH:
 # sub FETCH { return nth_prime($_[1]+1); }
 
@@ -55,6 +68,10 @@ sub FETCH {
   # We actually don't get negative indices -- they get turned into big numbers
   croak "Negative index given to prime array" if $index < 0;
   $index += $self->{SHIFTINDEX};  # take into account any shifts
+  if (defined $self->{PA}) {
+    my $p = Math::Prime::Util::_prime_array_fetch($self->{PA}, $index);
+    return $p if $p;   # Otherwise too big for XS
+  }
   my $begidx = $self->{BEG_INDEX};
   my $endidx = $self->{END_INDEX};
 
@@ -180,9 +197,21 @@ An array that acts like the infinite set of primes.  This may be more
 convenient than using L<Math::Prime::Util> directly, and in some cases it can
 be faster than calling C<next_prime> and C<prev_prime>.
 
-If the access pattern is ascending or descending, then a window is sieved and
-results returned from the window as needed.  If the access pattern is random,
-then C<nth_prime> is used.
+With XS, primes are kept in decoded blocks of 1024, along with a table of
+checkpoint primes at regular indices.  Ascending or descending access sieves
+the next block from the end of the previous one.  Random access sieves from
+the nearest checkpoint, which is found with C<nth_prime> the first time it
+is needed.  The memory used is bounded, and can be set when tying:
+
+  tie my @primes, 'Math::Prime::Util::PrimeArray', memory => 4_000_000;
+
+The default is about 1MB, half holding the most recently used blocks and
+half checkpoints.  More memory means more blocks held and closer
+checkpoints.
+
+Without XS, if the access pattern is ascending or descending, then a window
+is sieved and results returned from the window as needed.  If the access
+pattern is random, then C<nth_prime> is used.
 
 Shifting acts like the array is losing elements at the front, so after two
 shifts, C<$primes[0] == 5>.  Unshift will move the internal shift index back
@@ -16,6 +16,11 @@ use Math::Prime::Util qw/next_prime prev_prime is_prime prime_count nth_prime/;
 
 # We're going to use a scalar rather than a hash because there is currently
 # only one data object (the current value) and this makes it little faster.
+#
+# With XS, value, next, prev, iterate, peek, rewind, seek_to_value, and
+# seek_to_i are in C, and for native values the scalar holds a batch of
+# sieved primes instead.  The C methods call the Perl versions below for
+# bigints, so always use $self->value rather than looking in the scalar.
 
 sub new {
   my ($class, $start) = @_;
@@ -33,26 +38,26 @@ sub __iter__ {
   $self;
 }
 
-sub value { ${$_[0]}; }
-sub next {
+sub _pp_value { ${$_[0]}; }
+sub _pp_next {
   #my $self = shift;  $$self = next_prime($$self);  return $self;
   ${$_[0]} = next_prime(${$_[0]});
   return $_[0];
 }
-sub prev {
+sub _pp_prev {
   my $self = shift;
   my $p = $$self;
   $$self = ($p <= 2) ? 2 : prev_prime($p);
   return $self;
 }
-sub iterate {
+sub _pp_iterate {
   #my $self = shift;  my $p = $$self;  $$self = next_prime($p);  return $p;
   my $p = ${$_[0]};
   ${$_[0]} = next_prime(${$_[0]});
   return $p;
 }
 
-sub rewind {
+sub _pp_rewind {
   my ($self, $start) = @_;
   $$self = 2;
   if (defined $start && $start ne '2') {
@@ -63,13 +68,30 @@ sub rewind {
   return $self;
 }
 
-sub peek {
+sub _pp_peek {
   return next_prime(${$_[0]});
 }
 
+sub _pp_seek_to_i {
+  my($self, $n) = @_;
+  $self->rewind( nth_prime($n) );
+}
+sub _pp_seek_to_value {
+  my($self, $n) = @_;
+  $self->rewind($n);
+}
+
+# Without XS, use the Perl methods.
+{
+  no strict 'refs';
+  foreach my $method (qw/value next prev iterate rewind peek seek_to_i seek_to_value/) {
+    *{$method} = \&{"_pp_$method"} unless defined &{$method};
+  }
+}
+
 # Some methods to match Math::NumSeq
 sub tell_i {
-  return prime_count(${$_[0]});
+  return prime_count($_[0]->value);
 }
 sub pred {
   my($self, $n) = @_;
@@ -79,14 +101,6 @@ sub ith {
   my($self, $n) = @_;
   return nth_prime($n);
 }
-sub seek_to_i {
-  my($self, $n) = @_;
-  $self->rewind( nth_prime($n) );
-}
-sub seek_to_value {
-  my($self, $n) = @_;
-  $self->rewind($n);
-}
 sub value_to_i {
   my($self, $n) = @_;
   return unless is_prime($n);
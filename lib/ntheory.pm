@@ -68,14 +68,19 @@ See L<Math::Prime::Util> for complete documentation.
   primes([start,] end)                array ref of primes
   twin_primes([start,] end)           array ref of twin primes
   ramanujan_primes([start,] end)      array ref of Ramanujan primes
+  primes_packed(start, end[, buf])    primes as a string of native UVs
+  twin_primes_packed(start, end[, buf])       twin primes as a string
+  ramanujan_primes_packed(start, end[, buf])  Ramanujan primes as a string
   next_prime(n)                       next prime > n
   prev_prime(n)                       previous prime < n
   prime_count(n)                      count of primes <= n
   prime_count(start, end)             count of primes in range
+  prime_count_multi([n,...])          list of prime counts, sharing one sieve
   prime_count_lower(n)                fast lower bound for prime count
   prime_count_upper(n)                fast upper bound for prime count
   prime_count_approx(n)               fast approximate count of primes
   nth_prime(n)                        the nth prime (n=1 returns 2)
+  nth_prime_multi([n,...])            list of nth primes, sharing one sieve
   nth_prime_lower(n)                  fast lower bound for nth prime
   nth_prime_upper(n)                  fast upper bound for nth prime
   nth_prime_approx(n)                 fast approximate nth prime
@@ -152,9 +157,11 @@ See L<Math::Prime::Util> for complete documentation.
   invmod(a,n)                         inverse of a modulo n
   moebius(n)                          Moebius function of n
   moebius(beg, end)                   array of Moebius in range
+  moebius_packed(beg, end[, buf])     Moebius in range as a string of bytes
   mertens(n)                          sum of Moebius for 1 to n
   euler_phi(n)                        Euler totient of n
   euler_phi(beg, end)                 Euler totient for a range
+  euler_phi_packed(beg, end[, buf])   totients as a string of native UVs
   jordan_totient(n,k)                 Jordan's totient
   carmichael_lambda(n)                Carmichael's Lambda function
   exp_mangoldt                        exponential of Mangoldt function
@@ -187,6 +194,10 @@ See L<Math::Prime::Util> for complete documentation.
   prime_get_config                    gets hash ref of current settings
   prime_set_config(%hash)             sets parameters
   prime_memfree                       frees any cached memory
+  prime_cache_save(file)              writes the prime sieve cache to file
+  prime_cache_load(file)              uses a saved sieve file as the cache
+  prime_count_table_save(file,lo,hi[,iv])  writes pi(x) checkpoints to file
+  prime_count_table_load(file)        seeds prime_count/nth_prime from file
 
 
 =head1 COPYRIGHT
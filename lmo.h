@@ -4,6 +4,15 @@
 #include "ptypes.h"
 
 extern UV _XS_LMO_pi(UV n);
+extern UV _XS_LMO_easy_pi(UV n);
+
+  /* pi(n) by LMO with easy leaves, answering repeated n from the last few
+   * results.  The tables built for a count are kept for the next one. */
+extern UV lmo_prime_count(UV n);
+  /* Set up, empty, or (only at exit) destroy what is kept between counts. */
+extern void lmo_init(void);
+extern void lmo_memfree(void);
+extern void lmo_memfreeall(void);
 
 extern UV legendre_phi(UV n, UV a);
 
@@ -0,0 +1,170 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ptypes.h"
+#include "parallel.h"
+
+#ifdef MPU_HAVE_PTHREADS
+  #include <pthread.h>
+#endif
+
+/*
+ * A small ordered task pipeline.  Workers take tasks in increasing order,
+ * task t always uses slot t % nslots, and the consumer walks the tasks in
+ * order.  Since slots are handed out round-robin, a slot holding a finished
+ * task always holds the task the consumer will want when it gets there.
+ *
+ * All memory is allocated and freed in the calling thread.  The workers
+ * only ever run the task function and touch the context under its mutex.
+ */
+
+#define SLOT_FREE 0   /* waiting for a worker to take the next task */
+#define SLOT_BUSY 1   /* a worker is running the task */
+#define SLOT_DONE 2   /* finished, waiting for the consumer */
+
+typedef struct {
+  parallel_task_fn func;
+  void*           funcarg;
+  void**          slots;
+  unsigned char*  state;
+  UV              ntasks;
+  UV              next_task;     /* next task to give to a worker */
+  UV              next_result;   /* next task to give to the consumer */
+  int             nslots;
+  int             held;          /* slot the consumer is using, or -1 */
+  int             nthreads;      /* 0 means run everything in the caller */
+  int             stop;
+#ifdef MPU_HAVE_PTHREADS
+  pthread_t*      threads;
+  pthread_mutex_t mutex;
+  pthread_cond_t  cond;
+#endif
+} parallel_context_t;
+
+#ifdef MPU_HAVE_PTHREADS
+static void* _parallel_worker(void* vctx)
+{
+  parallel_context_t* ctx = (parallel_context_t*) vctx;
+
+  pthread_mutex_lock(&ctx->mutex);
+  while (!ctx->stop && ctx->next_task < ctx->ntasks) {
+    UV task = ctx->next_task;
+    int k = task % ctx->nslots;
+    if (ctx->state[k] != SLOT_FREE) {
+      pthread_cond_wait(&ctx->cond, &ctx->mutex);
+      continue;
+    }
+    ctx->state[k] = SLOT_BUSY;
+    ctx->next_task++;
+    pthread_mutex_unlock(&ctx->mutex);
+
+    ctx->func(ctx->funcarg, task, ctx->slots[k]);
+
+    pthread_mutex_lock(&ctx->mutex);
+    ctx->state[k] = SLOT_DONE;
+    pthread_cond_broadcast(&ctx->cond);
+  }
+  pthread_mutex_unlock(&ctx->mutex);
+  return 0;
+}
+#endif
+
+void* start_parallel_tasks(int nthreads, UV ntasks, int nslots, void** slots, parallel_task_fn func, void* funcarg)
+{
+  parallel_context_t* ctx;
+
+  MPUassert(nslots >= 1 && slots != 0 && func != 0, "start_parallel_tasks bad arguments");
+  New(0, ctx, 1, parallel_context_t);
+  ctx->func = func;
+  ctx->funcarg = funcarg;
+  ctx->slots = slots;
+  ctx->ntasks = ntasks;
+  ctx->next_task = 0;
+  ctx->next_result = 0;
+  ctx->nslots = nslots;
+  ctx->held = -1;
+  ctx->nthreads = 0;
+  ctx->stop = 0;
+  Newz(0, ctx->state, nslots, unsigned char);
+
+#ifdef MPU_HAVE_PTHREADS
+  ctx->threads = 0;
+  if (nthreads > 0 && ntasks > 0) {
+    int i;
+    if ((UV)nthreads > ntasks) nthreads = (int) ntasks;
+    New(0, ctx->threads, nthreads, pthread_t);
+    pthread_mutex_init(&ctx->mutex, 0);
+    pthread_cond_init(&ctx->cond, 0);
+    for (i = 0; i < nthreads; i++)
+      if (pthread_create(&ctx->threads[i], 0, _parallel_worker, ctx) != 0)
+        break;
+    ctx->nthreads = i;
+    if (i == 0) {                     /* No threads, so run serially. */
+      pthread_cond_destroy(&ctx->cond);
+      pthread_mutex_destroy(&ctx->mutex);
+      Safefree(ctx->threads);
+      ctx->threads = 0;
+    }
+  }
+#else
+  (void)nthreads;
+#endif
+  return (void*) ctx;
+}
+
+void* next_parallel_task(void* vctx, UV* task)
+{
+  parallel_context_t* ctx = (parallel_context_t*) vctx;
+  void* slot = 0;
+
+  if (ctx->nthreads == 0) {
+    if (ctx->next_result >= ctx->ntasks)
+      return 0;
+    *task = ctx->next_result++;
+    ctx->func(ctx->funcarg, *task, ctx->slots[0]);
+    return ctx->slots[0];
+  }
+
+#ifdef MPU_HAVE_PTHREADS
+  pthread_mutex_lock(&ctx->mutex);
+  if (ctx->held >= 0) {               /* Give back the slot we were using */
+    ctx->state[ctx->held] = SLOT_FREE;
+    ctx->held = -1;
+    pthread_cond_broadcast(&ctx->cond);
+  }
+  if (ctx->next_result < ctx->ntasks) {
+    int k = ctx->next_result % ctx->nslots;
+    while (ctx->state[k] != SLOT_DONE)
+      pthread_cond_wait(&ctx->cond, &ctx->mutex);
+    *task = ctx->next_result++;
+    ctx->held = k;
+    slot = ctx->slots[k];
+  }
+  pthread_mutex_unlock(&ctx->mutex);
+#endif
+  return slot;
+}
+
+void end_parallel_tasks(void* vctx)
+{
+  parallel_context_t* ctx = (parallel_context_t*) vctx;
+  MPUassert(ctx != 0, "end_parallel_tasks given a null pointer");
+
+#ifdef MPU_HAVE_PTHREADS
+  if (ctx->nthreads > 0) {
+    int i;
+    pthread_mutex_lock(&ctx->mutex);
+    ctx->stop = 1;
+    pthread_cond_broadcast(&ctx->cond);
+    pthread_mutex_unlock(&ctx->mutex);
+    for (i = 0; i < ctx->nthreads; i++)
+      pthread_join(ctx->threads[i], 0);
+    pthread_cond_destroy(&ctx->cond);
+    pthread_mutex_destroy(&ctx->mutex);
+    Safefree(ctx->threads);
+  }
+#endif
+  Safefree(ctx->state);
+  Safefree(ctx);
+}
@@ -0,0 +1,34 @@
+#ifndef MPU_PARALLEL_H
+#define MPU_PARALLEL_H
+
+#include "ptypes.h"
+
+  /* Run tasks 0 .. ntasks-1 on a pool of worker threads, handing the
+   * finished tasks back to a single consumer in task order.  Each task is
+   * run as func(funcarg, task, slot), where slot is one of the nslots
+   * buffers given by the caller.  A slot is only reused after the consumer
+   * has moved past the task in it, so at most nslots tasks are running or
+   * waiting to be consumed at any time.
+   *
+   * The task function runs outside of Perl, so it must not croak, allocate
+   * with New, or otherwise touch the interpreter.
+   *
+   * Without thread support, or if nthreads < 1, each task is run in the
+   * calling thread when next_parallel_task asks for it.
+   *
+   * Ex:
+   *   void* ctx = start_parallel_tasks(nthreads, ntasks, nslots, slots, f, arg);
+   *   while ( (slot = next_parallel_task(ctx, &task)) != 0 ) {
+   *     .... use result of task in slot ....
+   *   }
+   *   end_parallel_tasks(ctx);
+   */
+typedef void (*parallel_task_fn)(void* funcarg, UV task, void* slot);
+
+extern void* start_parallel_tasks(int nthreads, UV ntasks, int nslots, void** slots, parallel_task_fn func, void* funcarg);
+  /* Returns the slot holding the next task in order, or 0 when done. */
+extern void* next_parallel_task(void* vctx, UV* task);
+  /* Stops the workers.  It is fine to call this before all tasks are seen. */
+extern void  end_parallel_tasks(void* vctx);
+
+#endif
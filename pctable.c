@@ -0,0 +1,434 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ptypes.h"
+#include "pctable.h"
+#include "util.h"
+#include "lmo.h"
+
+#if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
+  #define MPU_HAVE_MMAP
+  #include <sys/types.h>
+  #include <sys/stat.h>
+  #include <sys/mman.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+/*
+ * A file is a 64 byte header, the varint counts, then the block index.  As
+ * with sieve files, the header and index are native endian and a file from
+ * a machine with a different byte order is rejected.
+ *
+ * With d(i) = pi(x_i) - pi(x_(i-1)), checkpoint i is stored as the zigzag
+ * varint of d(i) - d(i-1).  Counts in an interval vary by about their
+ * square root, so this is usually two bytes where d(i) would be three or
+ * four.  The first checkpoint of each block is only in the index, which
+ * also holds its d and the offset of the rest of the block, so any
+ * checkpoint is at most PCTABLE_BLOCK-1 varints from an absolute count.
+ *
+ * Loading decodes the whole table once, checking every block against the
+ * index and the last count against the header, so a damaged file is
+ * rejected rather than giving wrong counts.
+ */
+#define PCTABLE_MAGIC      "MPUPCT1"
+#define PCTABLE_BYTEORDER  0x01020304
+#define PCTABLE_HEADER     64
+#define PCTABLE_INDEX      (3*sizeof(uint64_t))
+
+typedef struct {
+  char          magic[8];
+  uint32_t      byteorder;
+  uint32_t      block;
+  uint64_t      interval;
+  uint64_t      first;
+  uint64_t      ncheck;
+  uint64_t      last_pi;
+  uint64_t      index_offset;
+  unsigned char pad[PCTABLE_HEADER - 56];
+} pctable_file_header_t;
+
+typedef struct pctable_s {
+  unsigned char*     map;
+  size_t             maplen;
+  UV                 interval;
+  UV                 first;
+  UV                 last;
+  UV                 ncheck;
+  const unsigned char* index;
+  struct pctable_s*  prev;         /* tables loaded before, kept until exit */
+} pctable_t;
+
+/* Readers may be using an older table when a new one is loaded, so tables
+ * are only freed at shutdown.  Loads are rare, and take the mutex to add a
+ * table to the list.  Readers just follow it from the head. */
+static pctable_t* pctable = 0;
+
+static int pctable_mutex_init = 0;
+#ifdef USE_ITHREADS
+static perl_mutex pctable_mutex;
+#endif
+
+static UV _zigzag(IV v)  { return (v >= 0) ? 2*(UV)v : 2*(UV)(-(v+1)) + 1; }
+static IV _unzigzag(UV z) { return (z & 1) ? -(IV)(z >> 1) - 1 : (IV)(z >> 1); }
+
+/* Read a varint from buf[*k], not going past end.  Returns 0 if short. */
+static int _get_varint(const unsigned char* buf, UV end, UV* k, UV* v)
+{
+  UV i = *k, r = 0;
+  while (i < end && (buf[i] & 0x80)) {
+    if (r >> (BITS_PER_WORD-7))  return 0;
+    r = (r << 7) | (buf[i++] & 0x7F);
+  }
+  if (i >= end || (r >> (BITS_PER_WORD-7)))  return 0;
+  *v = (r << 7) | buf[i++];
+  *k = i;
+  return 1;
+}
+
+static void _index_entry(const pctable_t* t, UV b, uint64_t e[3])
+{
+  memcpy(e, t->index + b*PCTABLE_INDEX, PCTABLE_INDEX);
+}
+
+/* pi at checkpoint i, which must be < ncheck. */
+static UV _pi_at(const pctable_t* t, UV i)
+{
+  uint64_t e[3];
+  UV j, v, k, pi, d;
+  _index_entry(t, i / PCTABLE_BLOCK, e);
+  pi = e[0];
+  d = e[1];
+  k = e[2];
+  for (j = i % PCTABLE_BLOCK; j > 0; j--) {
+    (void) _get_varint(t->map, t->maplen, &k, &v);
+    d += _unzigzag(v);
+    pi += d;
+  }
+  return pi;
+}
+
+/*****************************************************************************/
+
+typedef struct {
+  unsigned char* buf;
+  UV             nbuf;
+  UV             maxbuf;
+} pct_bytes_t;
+
+static void _put_varint(pct_bytes_t* b, UV v)
+{
+  unsigned char tmp[(BITS_PER_WORD+6)/7];
+  int i, n = 0;
+  if (b->nbuf + sizeof(tmp) > b->maxbuf) {
+    b->maxbuf = 2*b->maxbuf + 1024;
+    Renew(b->buf, b->maxbuf, unsigned char);
+  }
+  do { tmp[n++] = v & 0x7F; } while ((v >>= 7));
+  for (i = n-1; i >= 0; i--)
+    b->buf[b->nbuf++] = tmp[i] | ((i > 0) ? 0x80 : 0);
+}
+
+int prime_count_table_save(const char* filename, UV low, UV high, UV interval, UV* ncheck)
+{
+  pctable_file_header_t h;
+  pct_bytes_t body;
+  uint64_t* index;
+  UV first, n, i, pi, d;
+  char* tmpname;
+  FILE* fp;
+  int ok = 0;
+
+  MPUassert(filename != 0, "prime_count_table_save given null filename");
+  MPUassert(interval > 0 && interval % 30 == 0, "prime_count_table_save given bad interval");
+
+  /* Checkpoints are the multiples of interval in [low, high]. */
+  first = (low / interval) * interval;
+  n = 0;
+  if (first == low || first <= UV_MAX - interval) {
+    if (first < low)  first += interval;
+    if (first <= high)  n = (high - first) / interval + 1;
+  }
+
+  body.buf = 0;
+  body.nbuf = body.maxbuf = 0;
+  New(0, index, 3*((n + PCTABLE_BLOCK - 1) / PCTABLE_BLOCK) + 1, uint64_t);
+  pi = (n > 0) ? _XS_pi(first) : 0;
+  d = 0;
+  for (i = 0; i < n; i++) {
+    UV x = first + i*interval, dnew = 0;
+    if (i > 0) {
+      /* Within 100 intervals of zero a whole LMO count is cheaper than
+       * sieving an interval.  Further out, sieve the interval. */
+      dnew = ((x / interval) > 100) ? _XS_prime_count(x - interval + 1, x)
+                                    : _XS_pi(x) - pi;
+      pi += dnew;
+    }
+    if (i % PCTABLE_BLOCK == 0) {
+      uint64_t* e = index + 3*(i / PCTABLE_BLOCK);
+      e[0] = pi;
+      e[1] = dnew;
+      e[2] = PCTABLE_HEADER + body.nbuf;
+    } else {
+      _put_varint(&body, _zigzag((IV)dnew - (IV)d));
+    }
+    d = dnew;
+  }
+
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, PCTABLE_MAGIC, 8);
+  h.byteorder = PCTABLE_BYTEORDER;
+  h.block = PCTABLE_BLOCK;
+  h.interval = interval;
+  h.first = first;
+  h.ncheck = n;
+  h.last_pi = pi;
+  h.index_offset = PCTABLE_HEADER + body.nbuf;
+
+  /* Write to a temporary and rename, so a mapped old file stays valid. */
+  New(0, tmpname, strlen(filename) + 32, char);
+#ifdef MPU_HAVE_MMAP
+  sprintf(tmpname, "%s.tmp%lu", filename, (unsigned long) getpid());
+#else
+  sprintf(tmpname, "%s.tmp", filename);
+#endif
+  fp = fopen(tmpname, "wb");
+  if (fp != 0) {
+    UV nblocks = (n + PCTABLE_BLOCK - 1) / PCTABLE_BLOCK;
+    ok = (fwrite(&h, sizeof(h), 1, fp) == 1)
+      && (body.nbuf == 0 || fwrite(body.buf, 1, body.nbuf, fp) == body.nbuf)
+      && (nblocks == 0 || fwrite(index, PCTABLE_INDEX, nblocks, fp) == nblocks);
+    ok = (fclose(fp) == 0) && ok;
+  }
+  if (body.buf != 0)  Safefree(body.buf);
+  Safefree(index);
+
+#ifndef MPU_HAVE_MMAP
+  if (ok) remove(filename);   /* rename won't replace on Win32 */
+#endif
+  if (ok) ok = (rename(tmpname, filename) == 0);
+  if (!ok) remove(tmpname);
+  Safefree(tmpname);
+  if (ok && ncheck != 0)  *ncheck = n;
+  return ok;
+}
+
+/*****************************************************************************/
+
+static int _valid_header(const pctable_file_header_t* h, UV filesize)
+{
+  uint64_t nblocks;
+  if (memcmp(h->magic, PCTABLE_MAGIC, 8) != 0)   return 0;
+  if (h->byteorder != PCTABLE_BYTEORDER)         return 0;
+  if (h->block != PCTABLE_BLOCK)                 return 0;
+  if (h->ncheck == 0)                            return 0;
+  if (h->interval == 0 || h->interval % 30 != 0) return 0;
+  if ((uint64_t)(UV)h->interval != h->interval)  return 0;
+  if ((uint64_t)(UV)h->first != h->first)        return 0;
+  if ((h->ncheck-1) > (UV_MAX - h->first) / h->interval)  return 0;
+  if (h->index_offset < PCTABLE_HEADER || h->index_offset > filesize)  return 0;
+  nblocks = (h->ncheck + PCTABLE_BLOCK - 1) / PCTABLE_BLOCK;
+  if (nblocks > (filesize - h->index_offset) / PCTABLE_INDEX)  return 0;
+  if (h->index_offset + nblocks * PCTABLE_INDEX != filesize)   return 0;
+  return 1;
+}
+
+/* Decode every checkpoint, checking that the varints and the index agree
+ * and that no interval has more than half its numbers prime.  This finds
+ * damage, but not a table of consistently wrong counts. */
+static int _valid_table(const pctable_t* t, UV last_pi, UV index_offset)
+{
+  UV i, k = PCTABLE_HEADER, pi = 0, d = 0;
+  for (i = 0; i < t->ncheck; i++) {
+    if (i % PCTABLE_BLOCK == 0) {
+      uint64_t e[3];
+      _index_entry(t, i / PCTABLE_BLOCK, e);
+      if (e[2] != k)  return 0;
+      if (i > 0 && (e[0] != pi + e[1] || e[1] > t->interval/2))  return 0;
+      pi = e[0];
+      d = e[1];
+    } else {
+      UV v;
+      IV dd;
+      if (!_get_varint(t->map, index_offset, &k, &v))  return 0;
+      dd = _unzigzag(v);
+      if ((dd < 0 && (UV)(-(dd+1)) >= d) || (dd > 0 && (UV)dd > t->interval/2 - d))
+        return 0;
+      d += dd;
+      pi += d;
+    }
+  }
+  return (k == index_offset && pi == last_pi);
+}
+
+/* Check the counts themselves: pi at the first checkpoint, and sieving the
+ * interval before each of PCTABLE_SAMPLES checkpoints spread over the
+ * table, including the last. */
+#define PCTABLE_SAMPLES  8
+static int _valid_counts(const pctable_t* t)
+{
+  UV s, i, x;
+  if (_pi_at(t, 0) != lmo_prime_count(t->first))  return 0;
+  for (s = 1; s <= PCTABLE_SAMPLES && s < t->ncheck; s++) {
+    i = (t->ncheck > PCTABLE_SAMPLES)
+      ? 1 + (s * (t->ncheck-2)) / PCTABLE_SAMPLES  :  s;
+    x = t->first + i * t->interval;
+    if (_pi_at(t, i) - _pi_at(t, i-1) != _XS_prime_count(x - t->interval + 1, x))
+      return 0;
+  }
+  return 1;
+}
+
+static void _free_table(pctable_t* t)
+{
+#ifdef MPU_HAVE_MMAP
+  munmap(t->map, t->maplen);
+#else
+  Safefree(t->map);
+#endif
+  Safefree(t);
+}
+
+UV prime_count_table_load(const char* filename)
+{
+  pctable_file_header_t h;
+  pctable_t* t;
+  void* map;
+  size_t maplen;
+
+  MPUassert(filename != 0, "prime_count_table_load given null filename");
+  {
+#ifdef MPU_HAVE_MMAP
+    struct stat st;
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)  return 0;
+    if (fstat(fd, &st) != 0 || st.st_size < PCTABLE_HEADER ||
+        (uint64_t)st.st_size != (uint64_t)(size_t)st.st_size) {
+      close(fd);
+      return 0;
+    }
+    maplen = (size_t) st.st_size;
+    map = mmap(0, maplen, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)  return 0;
+    memcpy(&h, map, sizeof(h));
+    if (!_valid_header(&h, maplen)) {
+      munmap(map, maplen);
+      return 0;
+    }
+#else
+    FILE* fp = fopen(filename, "rb");
+    long filesize;
+    if (fp == 0)  return 0;
+    if (fseek(fp, 0, SEEK_END) != 0 || (filesize = ftell(fp)) < PCTABLE_HEADER ||
+        fseek(fp, 0, SEEK_SET) != 0) {
+      fclose(fp);
+      return 0;
+    }
+    maplen = (size_t) filesize;
+    New(0, map, maplen, unsigned char);
+    if (fread(map, 1, maplen, fp) != maplen) {
+      fclose(fp);
+      Safefree(map);
+      return 0;
+    }
+    fclose(fp);
+    memcpy(&h, map, sizeof(h));
+    if (!_valid_header(&h, maplen)) {
+      Safefree(map);
+      return 0;
+    }
+#endif
+  }
+
+  New(0, t, 1, pctable_t);
+  t->map = (unsigned char*) map;
+  t->maplen = maplen;
+  t->interval = h.interval;
+  t->first = h.first;
+  t->ncheck = h.ncheck;
+  t->last = t->first + (t->ncheck-1) * t->interval;
+  t->index = t->map + h.index_offset;
+  if (!_valid_table(t, h.last_pi, h.index_offset) || !_valid_counts(t)) {
+    _free_table(t);
+    return 0;
+  }
+  MUTEX_LOCK(&pctable_mutex);
+    t->prev = pctable;
+    pctable = t;
+  MUTEX_UNLOCK(&pctable_mutex);
+  return t->last;
+}
+
+void prime_count_table_init(void)
+{
+  if (!pctable_mutex_init) {
+    MUTEX_INIT(&pctable_mutex);
+    pctable_mutex_init = 1;
+  }
+}
+
+void prime_count_table_free(void)
+{
+  /* No locks.  We're shutting everything down. */
+  if (pctable_mutex_init) {
+    pctable_mutex_init = 0;
+    MUTEX_DESTROY(&pctable_mutex);
+  }
+  while (pctable != 0) {
+    pctable_t* t = pctable;
+    pctable = t->prev;
+    _free_table(t);
+  }
+}
+
+/*****************************************************************************/
+
+/* As with prime_count, sieving is only used if the distance is under 1%
+ * of n.  Past that, LMO from scratch is faster. */
+int prime_count_table_pi(UV n, UV* count)
+{
+  const pctable_t* t = pctable;
+  UV i, x, dist, pc;
+
+  if (t == 0 || n < t->first || n > t->last)  return 0;
+  i = (n - t->first) / t->interval;
+  if (i+1 < t->ncheck && (n - t->first) % t->interval > t->interval/2)  i++;
+  x = t->first + i * t->interval;
+  dist = (x <= n) ? n - x : x - n;
+  if (dist > 0 && n / dist <= 100)  return 0;
+
+  pc = _pi_at(t, i);
+  *count = (x <= n) ? pc + _XS_prime_count(x+1, n)
+                    : pc - _XS_prime_count(n+1, x);
+  return 1;
+}
+
+int prime_count_table_nth(UV n, UV* x, UV* count)
+{
+  const pctable_t* t = pctable;
+  UV lo, hi;
+
+  if (t == 0 || t->ncheck < 2)  return 0;
+  lo = 0;
+  hi = t->ncheck-1;
+  if (_pi_at(t, lo) >= n || _pi_at(t, hi) < n)  return 0;
+  while (hi - lo > 1) {   /* pi(x_lo) < n <= pi(x_hi) */
+    UV mid = lo + (hi - lo) / 2;
+    if (_pi_at(t, mid) < n)  lo = mid;
+    else                     hi = mid;
+  }
+  *x = t->first + lo * t->interval;
+  if (*x < 30 || *x / t->interval <= 100)  return 0;
+  *count = _pi_at(t, lo);
+  return 1;
+}
+
+UV _XS_pi(UV n)
+{
+  UV count;
+  if (prime_count_table_pi(n, &count))
+    return count;
+  return lmo_prime_count(n);
+}
@@ -0,0 +1,39 @@
+#ifndef MPU_PCTABLE_H
+#define MPU_PCTABLE_H
+
+#include "ptypes.h"
+
+  /* Prime count tables hold pi(x) at every multiple of an interval over a
+   * range, so a count only has to sieve from the nearest checkpoint.  The
+   * counts are stored as second differences in BER varints, with an index
+   * giving the absolute count every PCTABLE_BLOCK checkpoints.
+   *
+   * Ex:
+   *   prime_count_table_save("pc.table", 0, 1e12, 30000000, &ncheck);
+   *   prime_count_table_load("pc.table");
+   *   if (prime_count_table_pi(n, &count)) ...count is pi(n)...
+   */
+#define PCTABLE_BLOCK  64
+
+  /* Write pi at the multiples of interval (a multiple of 30) from low to
+   * high.  Returns 1 and sets ncheck on success, 0 if the file couldn't be
+   * written. */
+extern int prime_count_table_save(const char* filename, UV low, UV high, UV interval, UV* ncheck);
+  /* Use the table in filename, mapping it read-only if possible.  Returns
+   * its last checkpoint, or 0 if the file could not be used. */
+extern UV  prime_count_table_load(const char* filename);
+  /* Set up the lock for loading, and (only at exit) free every table. */
+extern void prime_count_table_init(void);
+extern void prime_count_table_free(void);
+
+  /* Set count to pi(n) if the loaded table covers n.  Sieves at most half
+   * an interval.  Returns 0 if there is no table for n. */
+extern int prime_count_table_pi(UV n, UV* count);
+  /* Find the last checkpoint x with pi(x) < n, when the table shows the
+   * nth prime is before the next one.  Returns 0 otherwise. */
+extern int prime_count_table_nth(UV n, UV* x, UV* count);
+
+  /* pi(n) using a loaded table if it covers n, else LMO. */
+extern UV _XS_pi(UV n);
+
+#endif
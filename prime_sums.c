@@ -0,0 +1,188 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*****************************************************************************
+ *
+ * Sums of primes using Lucy_Hedgehog's method.
+ *
+ * Copyright (c) 2015 Dana Jacobsen (dana@acm.org)
+ * This is free software; you can redistribute it and/or modify it under
+ * the same terms as the Perl 5 programming language system itself.
+ *
+ * This file is part of the Math::Prime::Util Perl module, but it should
+ * not be difficult to turn it into standalone code.
+ *
+ * S(v,p) is the sum of 2 .. v less those with a prime factor < p that are
+ * not themselves prime.  Starting from S(v,2) = v(v+1)/2 - 1, each prime p
+ * up to sqrt(n) removes the composites with least prime factor p:
+ *
+ *   S(v,p+1) = S(v,p) - p * (S(v/p,p) - S(p-1,p))     for v >= p^2
+ *
+ * Only the values v = n/i are ever needed, so there are 2*sqrt(n) of them,
+ * and updating them in decreasing order needs no second copy.  This is
+ * O(n^(3/4)/log n) time and O(n^(1/2)) memory, between the Lehmer and LMO
+ * prime counts, but the sums need no phi sieve and the loops are simple.
+ * Even numbers are left out from the start, so the 2 pass is skipped.
+ *
+ * Sums for v < 2^33 are below 2^64, so only S(n/i) for i <= n/2^33 are
+ * kept in 128 bits.  The largest, near n^2 / (2 log n), fits for all
+ * 64-bit n.  Memory is about 12*sqrt(n) bytes (380MB at 10^15).
+ *
+ * Timing below is single core.  The sieve sum overflows a UV past 2.95e10.
+ *
+ *  |   n   |  Sieve   |  Lucy    |
+ *  +-------+----------+----------+
+ *  | 10^14 |          |   31.37  |
+ *  | 10^13 |          |    5.521 |
+ *  | 10^12 |          |    1.013 |
+ *  | 10^11 |          |    0.207 |
+ *  | 10^10 |   11.27  |    41ms  |
+ *  | 10^9  |    1.132 |     9ms  |
+ */
+
+#define FUNC_isqrt 1
+#include "ptypes.h"
+#include "prime_sums.h"
+#include "util.h"
+#include "sieve.h"
+
+/* Below this, sieving is faster. */
+#define LUCY_MIN  1000000
+/* Above this, the Lucy arrays would need more than 1.2GB. */
+#define LUCY_MAX  UVCONST(10000000000000000)
+
+#if defined(HAVE_UINT128) && BITS_PER_WORD == 64
+
+static uint128_t _sum_primes_lucy(UV n)
+{
+  UV r, i, i0, p, *small, *large;
+  uint128_t *big, sum;
+  double dn = (double) n;
+  int fastdiv = (n < (UVCONST(1) << 52));
+
+  if (n < 3)  return (n == 2) ? 2 : 0;
+  r = isqrt(n);
+  /* Only odd numbers are counted, so 2 is never sieved, and even v share
+   * the sums of v-1.  small[(v-1)/2] = S(v) for v <= r.  S(n/i) is in
+   * big[i] for i <= i0, where it can pass 2^64, else in large[i]. */
+  i0 = n >> 33;
+  New(0, small, (r+1)/2 + 1, UV);
+  New(0, large, r+1, UV);
+  New(0, big, i0+1, uint128_t);
+  for (i = 0; i <= (r+1)/2; i++)
+    small[i] = (i+1)*(i+1) - 1;            /* 3 + 5 + ... + (2i+1) */
+  for (i = 1; i <= i0; i++) {
+    uint128_t h = ((n/i) + 1) / 2;
+    big[i] = h*h - 1;
+  }
+  for (i = i0+1; i <= r; i++) {
+    UV h = ((n/i) + 1) / 2;
+    large[i] = h*h - 1;                    /* can be 2^64 - 1 */
+  }
+
+  for (p = 3; p <= r; p += 2) {
+    UV sp, p2, imax, imid, v, q;
+    if (small[(p-1)/2] == small[(p-3)/2])  continue;    /* p is not prime */
+    sp = small[(p-3)/2];
+    p2 = p*p;
+    imax = n / p2;
+    if (imax > r)  imax = r;
+
+    /* The big sums, reading big, large, or small. */
+    for (i = 1; i <= i0 && i <= imax; i++) {
+      UV d = i*p;
+      uint128_t sv = (d <= i0) ? big[d]
+                   : (d <= r)  ? (uint128_t) large[d]
+                   : (uint128_t) small[(n/d-1)/2];
+      big[i] -= (uint128_t)p * (sv - sp);
+    }
+    /* Indices whose n/(i*p) is also a large index. */
+    imid = (imax < r/p) ? imax : r/p;
+    for (; i <= imid; i++)
+      large[i] -= p * (large[i*p] - sp);
+    if (fastdiv) {
+      double dnp = dn / (double)p;
+      for (; i <= imax; i++) {
+        q = (UV) (dnp / (double)i);        /* floor(n/(i*p)), maybe off by 1 */
+        if (q*i*p > n)              q--;
+        else if ((q+1)*i*p <= n)    q++;
+        large[i] -= p * (small[(q-1)/2] - sp);
+      }
+    } else {
+      for (; i <= imax; i++)
+        large[i] -= p * (small[(n/(i*p)-1)/2] - sp);
+    }
+    if (p2 <= r) {
+      uint32_t p32 = p;
+      for (v = r - !(r & 1); v >= p2; v -= 2)    /* odd v, down to p^2 */
+        small[(v-1)/2] -= p * (small[(((uint32_t)v / p32) - 1)/2] - sp);
+    }
+  }
+  sum = ((i0 >= 1) ? big[1] : (uint128_t) large[1]) + 2;
+  Safefree(big);
+  Safefree(large);
+  Safefree(small);
+  return sum;
+}
+
+/* Sum the primes in a range by sieving. */
+static uint128_t _sum_primes_sieve(UV low, UV high)
+{
+  uint128_t sum = 0;
+  if ((low <= 2) && (high >= 2)) sum += 2;
+  if ((low <= 3) && (high >= 3)) sum += 3;
+  if ((low <= 5) && (high >= 5)) sum += 5;
+  if (low < 7) low = 7;
+  if (low <= high) {
+    unsigned char* segment;
+    UV seg_base, seg_low, seg_high;
+    void* ctx = start_segment_primes(low, high, &segment);
+    while (next_segment_primes(ctx, &seg_base, &seg_low, &seg_high)) {
+      START_DO_FOR_EACH_SIEVE_PRIME( segment, seg_base, seg_low, seg_high )
+        sum += p;
+      END_DO_FOR_EACH_SIEVE_PRIME
+    }
+    end_segment_primes(ctx);
+  }
+  return sum;
+}
+
+int sum_primes128(UV low, UV high, UV* hi_sum, UV* lo_sum)
+{
+  uint128_t sum;
+  if (low > high)
+    sum = 0;
+  else if (high < LUCY_MIN || (high-low+1 != 0 && (high / (high-low+1)) > 100))
+    sum = _sum_primes_sieve(low, high);
+  else if (high > LUCY_MAX)
+    return 0;
+  else
+    sum = _sum_primes_lucy(high) - ((low <= 2) ? 0 : _sum_primes_lucy(low-1));
+  *hi_sum = (UV) (sum >> 64);
+  *lo_sum = (UV) sum;
+  return 1;
+}
+
+void sum_primes128_string(UV hi_sum, UV lo_sum, char* str)
+{
+  uint128_t sum = ((uint128_t)hi_sum << 64) | lo_sum;
+  char tmp[40], *s = tmp + sizeof(tmp);
+  *--s = '\0';
+  do { *--s = '0' + (int)(sum % 10);  sum /= 10; } while (sum > 0);
+  strcpy(str, s);
+}
+
+#else
+
+int sum_primes128(UV low, UV high, UV* hi_sum, UV* lo_sum)
+{
+  return 0;
+}
+
+void sum_primes128_string(UV hi_sum, UV lo_sum, char* str)
+{
+  croak("sum_primes128_string needs a 128-bit type");
+}
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef MPU_PRIME_SUMS_H
+#define MPU_PRIME_SUMS_H
+
+#include "ptypes.h"
+
+  /* Sum of the primes from low to high as a 128-bit value in two words.
+   * Returns 0 if there is no 128-bit type, or a wide range ends past
+   * 10^16, where the tables would take too much memory. */
+extern int sum_primes128(UV low, UV high, UV* hi_sum, UV* lo_sum);
+  /* Write a sum from sum_primes128 in decimal to str, which must have
+   * room for 40 characters. */
+extern void sum_primes128_string(UV hi_sum, UV lo_sum, char* str);
+
+#endif
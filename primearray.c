@@ -0,0 +1,258 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "ptypes.h"
+#include "primearray.h"
+#include "constants.h"
+#include "sieve.h"
+#include "util.h"
+
+/*
+ * Indices are split into blocks of PA_BLOCK consecutive primes.  A fetch
+ * looks through the decoded blocks first.  A missing block is sieved from
+ * the end of a decoded neighbour if there is one (so walking forward or
+ * backward never needs a prime count), else from the nearest checkpoint
+ * below it.  Checkpoints are the primes at every stride'th index, found
+ * with nth_prime the first time they are needed and then kept, so a random
+ * access costs at most a stride of sieving once its area has been visited.
+ *
+ * The memory is split evenly between decoded blocks (at least 2) and
+ * checkpoints, with the stride chosen so the table covers maxindex.
+ */
+#define PA_BLOCK  1024
+
+typedef struct {
+  UV size;        /* bytes in the whole state */
+  UV maxindex;
+  UV nslots;      /* decoded blocks we can hold */
+  UV ncheck;      /* checkpoint table entries */
+  UV stride;      /* indices between checkpoints, a multiple of PA_BLOCK */
+  UV clock;       /* for LRU */
+  UV recent;      /* slot used last */
+} pa_head_t;
+
+typedef struct {
+  UV block;       /* block number + 1, 0 if empty */
+  UV used;        /* clock when last used */
+  UV n;           /* primes in block, less than PA_BLOCK only at the top */
+} pa_slot_t;
+
+#define PA_SLOT_BYTES   (sizeof(pa_slot_t) + PA_BLOCK*sizeof(UV))
+#define PA_CHECK(h)     ((UV*)((h)+1))
+#define PA_SLOT(h,i)    ((pa_slot_t*)((char*)(PA_CHECK(h)+(h)->ncheck) + (i)*PA_SLOT_BYTES))
+#define PA_PRIMES(s)    ((UV*)((s)+1))
+
+static void _pa_dims(UV memory, UV maxindex, UV* nslots, UV* ncheck)
+{
+  UV nblocks = maxindex/PA_BLOCK + 1;
+  UV ns = (memory / 2) / PA_SLOT_BYTES;
+  UV used, nc;
+  if (ns < 2)  ns = 2;
+  used = sizeof(pa_head_t) + ns * PA_SLOT_BYTES;
+  nc = (memory > used) ? (memory - used) / sizeof(UV) : 0;
+  if (nc < 16)       nc = 16;
+  if (nc > nblocks)  nc = nblocks;
+  *nslots = ns;
+  *ncheck = nc;
+}
+
+UV prime_array_size(UV memory, UV maxindex)
+{
+  UV nslots, ncheck;
+  _pa_dims(memory, maxindex, &nslots, &ncheck);
+  return sizeof(pa_head_t) + ncheck*sizeof(UV) + nslots*PA_SLOT_BYTES;
+}
+
+void prime_array_init(void* mem, UV memory, UV maxindex)
+{
+  pa_head_t* h = (pa_head_t*) mem;
+  UV i, nblocks = maxindex/PA_BLOCK + 1;
+
+  h->size = prime_array_size(memory, maxindex);
+  h->maxindex = maxindex;
+  _pa_dims(memory, maxindex, &(h->nslots), &(h->ncheck));
+  h->stride = PA_BLOCK * ((nblocks + h->ncheck - 1) / h->ncheck);
+  h->clock = 0;
+  h->recent = 0;
+  memset(PA_CHECK(h), 0, h->ncheck * sizeof(UV));
+  PA_CHECK(h)[0] = 2;
+  for (i = 0; i < h->nslots; i++) {
+    pa_slot_t* s = PA_SLOT(h,i);
+    s->block = s->used = s->n = 0;
+  }
+}
+
+int prime_array_valid(const void* mem, UV size)
+{
+  const pa_head_t* h = (const pa_head_t*) mem;
+  return (size >= sizeof(pa_head_t) && h->size == size &&
+          size == sizeof(pa_head_t) + h->ncheck*sizeof(UV) + h->nslots*PA_SLOT_BYTES);
+}
+
+/* Bytes to sieve for about count primes near n. */
+static UV _pa_window(UV n, UV count)
+{
+  UV bytes = (UV) (count * 1.05 * log((double)n + 3.0) / 30.0) + 8;
+  return (bytes < 64) ? 64 : (bytes > 16384) ? 16384 : bytes;
+}
+
+/* Skip skip primes starting with p, then put the next want into out.
+ * Returns how many were found, less than want only at the top. */
+static UV _pa_forward(UV p, UV skip, UV* out, UV want)
+{
+  UV n = 0;
+  while (n < want && p <= MPU_MAX_PRIME) {
+    UV *list, c, bytes = _pa_window(p, skip + want - n);
+    UV hi = (MPU_MAX_PRIME - p < 30*bytes) ? MPU_MAX_PRIME : p + 30*bytes - 1;
+    New(0, list, 3 + 8*(hi/30 - p/30 + 1), UV);
+    c = range_primes(p, hi, list);
+    if (c <= skip) {
+      skip -= c;
+    } else {
+      UV take = (c - skip < want - n) ? c - skip : want - n;
+      memcpy(out + n, list + skip, take * sizeof(UV));
+      n += take;
+      skip = 0;
+    }
+    Safefree(list);
+    if (hi >= MPU_MAX_PRIME) break;
+    p = hi+1;
+  }
+  return n;
+}
+
+/* Put the want primes ending at or below p into out. */
+static UV _pa_backward(UV p, UV* out, UV want)
+{
+  UV n = 0;
+  while (n < want) {
+    UV *list, c, take, bytes = _pa_window(p, want - n);
+    UV lo = (p > 30*bytes) ? p - 30*bytes + 1 : 0;
+    New(0, list, 3 + 8*(p/30 - lo/30 + 1), UV);
+    c = range_primes(lo, p, list);
+    take = (c < want - n) ? c : want - n;
+    memcpy(out + want - n - take, list + c - take, take * sizeof(UV));
+    n += take;
+    Safefree(list);
+    if (lo == 0) break;
+    p = lo-1;
+  }
+  if (n < want)   /* Ran into 2, move them down */
+    memmove(out, out + want - n, n * sizeof(UV));
+  return n;
+}
+
+/* Move p forward past all but a block or so of the skip primes, counting
+ * ranges rather than decoding them. */
+static UV _pa_count_ahead(UV p, UV* skip)
+{
+  while (*skip > 2*PA_BLOCK && p < MPU_MAX_PRIME/2) {
+    double lg = log((double)p + 3.0);
+    UV c, hi, span;
+    if (lg < 3.0)  lg = 3.0;
+    /* Aim short, so we land before the prime we want. */
+    span = (UV) ((*skip - PA_BLOCK) * (lg - 1.2));
+    hi = p + span;
+    c = _XS_prime_count(p, hi);
+    if (c > *skip)  break;
+    *skip -= c;
+    p = hi+1;
+  }
+  return p;
+}
+
+/* The prime at checkpoint j, or 0 if it is too big.  If a checkpoint a
+ * few strides below is known, count up from it filling in the ones between,
+ * as that is about as fast as a single nth_prime. */
+#define PA_MAX_CHECK_WALK 8
+static UV _pa_checkpoint(pa_head_t* h, UV j)
+{
+  UV k, *check = PA_CHECK(h);
+  if (check[j] != 0)
+    return check[j];
+  for (k = j; k > 0 && j-k < PA_MAX_CHECK_WALK && check[k] == 0; k--)
+    ;
+  if (check[k] == 0) {
+    check[j] = nth_prime(j * h->stride + 1);
+  } else {
+    for (; k < j; k++) {
+      UV skip = h->stride;
+      UV p = _pa_count_ahead(check[k], &skip);
+      if (_pa_forward(p, skip, &(check[k+1]), 1) == 0)
+        return 0;
+    }
+  }
+  return check[j];
+}
+
+static pa_slot_t* _pa_decode(pa_head_t* h, UV b)
+{
+  pa_slot_t *s, *prev = 0, *next = 0, *victim = 0;
+  UV i, first, j, lastp = 0, firstp = 0;
+
+  for (i = 0; i < h->nslots; i++) {
+    s = PA_SLOT(h,i);
+    if (b > 0 && s->block == b)             prev = s;
+    if (s->block == b+2 && s->n > 0)        next = s;
+    if (victim == 0 || s->used < victim->used) { victim = s;  h->recent = i; }
+  }
+  /* Read from the neighbours before we possibly overwrite one. */
+  if (prev != 0 && prev->n == PA_BLOCK)  lastp = PA_PRIMES(prev)[PA_BLOCK-1];
+  else if (next != 0)                    firstp = PA_PRIMES(next)[0];
+
+  s = victim;
+  s->block = b+1;
+  first = b * PA_BLOCK;
+  if (lastp != 0) {
+    s->n = (lastp >= MPU_MAX_PRIME) ? 0 : _pa_forward(lastp+1, 0, PA_PRIMES(s), PA_BLOCK);
+  } else if (firstp != 0) {
+    s->n = _pa_backward(firstp-1, PA_PRIMES(s), PA_BLOCK);
+    if (s->n > 0 && first % h->stride == 0)
+      PA_CHECK(h)[first / h->stride] = PA_PRIMES(s)[0];
+  } else {
+    UV p;
+    j = first / h->stride;
+    p = _pa_checkpoint(h, j);
+    if (p != 0) {
+      UV skip = first - j*h->stride;
+      p = _pa_count_ahead(p, &skip);
+      s->n = _pa_forward(p, skip, PA_PRIMES(s), PA_BLOCK);
+    } else {
+      s->n = 0;
+    }
+  }
+  /* Save the next checkpoint if this block ends at one. */
+  if (s->n == PA_BLOCK && (first + PA_BLOCK) % h->stride == 0) {
+    j = (first + PA_BLOCK) / h->stride;
+    lastp = PA_PRIMES(s)[PA_BLOCK-1];
+    if (j < h->ncheck && PA_CHECK(h)[j] == 0 && lastp < MPU_MAX_PRIME)
+      PA_CHECK(h)[j] = next_prime(lastp);
+  }
+  return s;
+}
+
+UV prime_array_fetch(void* mem, UV index)
+{
+  pa_head_t* h = (pa_head_t*) mem;
+  UV b = index / PA_BLOCK, off = index % PA_BLOCK;
+  pa_slot_t* s;
+
+  if (index > h->maxindex)  return 0;
+  s = PA_SLOT(h, h->recent);
+  if (s->block != b+1) {
+    UV i;
+    for (i = 0; i < h->nslots; i++)
+      if (PA_SLOT(h,i)->block == b+1)
+        break;
+    if (i < h->nslots) {
+      h->recent = i;
+      s = PA_SLOT(h,i);
+    } else {
+      s = _pa_decode(h, b);
+    }
+  }
+  s->used = ++h->clock;
+  return (off < s->n) ? PA_PRIMES(s)[off] : 0;
+}
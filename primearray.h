@@ -0,0 +1,27 @@
+#ifndef MPU_PRIMEARRAY_H
+#define MPU_PRIMEARRAY_H
+
+#include "ptypes.h"
+
+  /* Random access to the nth prime, for PrimeArray.  The state is a single
+   * block of memory with no pointers in it, so the caller can keep it in a
+   * Perl string.  It holds a table of checkpoint primes at regular indices
+   * and an LRU set of decoded blocks of consecutive primes.
+   *
+   * Ex:
+   *   size = prime_array_size(memory, maxindex);
+   *   New(0, mem, size, char);
+   *   prime_array_init(mem, memory, maxindex);
+   *   p = prime_array_fetch(mem, 1000);    (p = 7927, the 1001st prime)
+   */
+  /* Bytes needed for a state using about memory bytes, for indices up to
+   * maxindex.  Use the same memory and maxindex for init. */
+extern UV prime_array_size(UV memory, UV maxindex);
+extern void prime_array_init(void* mem, UV memory, UV maxindex);
+  /* Returns 1 if mem looks like a state of this size. */
+extern int prime_array_valid(const void* mem, UV size);
+  /* The prime at 0-based index, or 0 if the index is past maxindex or the
+   * prime doesn't fit in a UV. */
+extern UV prime_array_fetch(void* mem, UV index);
+
+#endif
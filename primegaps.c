@@ -0,0 +1,235 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ptypes.h"
+#include "primegaps.h"
+#include "sieve.h"
+
+#if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
+  #include <unistd.h>
+  #define PG_TMPNAME(buf, name) \
+    sprintf(buf, "%s.tmp%lu", name, (unsigned long) getpid())
+#else
+  #define PG_TMPNAME(buf, name)  sprintf(buf, "%s.tmp", name)
+#endif
+
+/*
+ * A file is a 64 byte header, the blocks of gaps, then the checkpoint
+ * table.  As with sieve files, the header and table are native endian and
+ * a file from a machine with a different byte order is rejected.  The gaps
+ * are bytes, so a reader that checks the byte order itself can walk them
+ * with unpack "w*".
+ *
+ * Each gap is stored as half its size, with the gap from 2 to 3 stored as 0.
+ * The first prime of each block is only in its checkpoint, so any block
+ * can be decoded on its own.
+ */
+#define PRIME_GAPS_MAGIC      "MPUGAP1"
+#define PRIME_GAPS_BYTEORDER  0x01020304
+#define PG_BUFFER             65536
+
+typedef struct {
+  char          magic[8];
+  uint32_t      byteorder;
+  uint32_t      interval;
+  uint64_t      low;
+  uint64_t      high;
+  uint64_t      count;
+  uint64_t      first_index;
+  uint64_t      ncheck;
+  uint64_t      table_offset;
+} prime_gaps_file_header_t;
+
+typedef struct {
+  FILE*         fp;
+  int           ok;
+  UV            nbuf;
+  UV            offset;       /* bytes written so far, including nbuf */
+  uint64_t*     table;        /* prime, index, offset for each block */
+  UV            ncheck;
+  UV            maxcheck;
+  UV            interval;
+  UV            first_index;
+  UV            count;
+  UV            prev;
+  unsigned char buf[PG_BUFFER];
+} pg_writer_t;
+
+static void _pg_flush(pg_writer_t* w) {
+  if (w->ok && w->nbuf > 0)
+    w->ok = (fwrite(w->buf, 1, w->nbuf, w->fp) == w->nbuf);
+  w->nbuf = 0;
+}
+
+static void _pg_add(pg_writer_t* w, UV p) {
+  if (w->count % w->interval == 0) {
+    uint64_t* c;
+    if (w->ncheck == w->maxcheck) {
+      w->maxcheck = 2*w->maxcheck + 16;
+      Renew(w->table, 3*w->maxcheck, uint64_t);
+    }
+    c = w->table + 3*w->ncheck++;
+    c[0] = p;
+    c[1] = w->first_index + w->count;
+    c[2] = w->offset;
+  } else {
+    UV v = (w->prev == 2) ? 0 : (p - w->prev) >> 1;
+    if (v < 0x80) {
+      w->buf[w->nbuf++] = (unsigned char) v;
+      w->offset++;
+    } else {
+      unsigned char tmp[(BITS_PER_WORD+6)/7];
+      int i, n = 0;
+      do { tmp[n++] = v & 0x7F; } while ((v >>= 7));
+      for (i = n-1; i >= 0; i--)
+        w->buf[w->nbuf++] = tmp[i] | ((i > 0) ? 0x80 : 0);
+      w->offset += n;
+    }
+    if (w->nbuf > PG_BUFFER - 16)
+      _pg_flush(w);
+  }
+  w->prev = p;
+  w->count++;
+}
+
+int prime_gaps_save(const char* filename, UV low, UV high, UV interval, UV first_index, UV* count)
+{
+  prime_gaps_file_header_t h;
+  pg_writer_t* w;
+  char* tmpname;
+  int ok;
+
+  MPUassert(filename != 0, "prime_gaps_save given null filename");
+  MPUassert(interval > 0 && interval <= PRIME_GAPS_MAX_INTERVAL, "prime_gaps_save given bad interval");
+
+  /* Write to a temporary and rename, so readers never see a partial file. */
+  New(0, tmpname, strlen(filename) + 32, char);
+  PG_TMPNAME(tmpname, filename);
+  New(0, w, 1, pg_writer_t);
+  w->fp = fopen(tmpname, "wb");
+  if (w->fp == 0) {
+    Safefree(w);
+    Safefree(tmpname);
+    return 0;
+  }
+  w->ok = 1;
+  w->nbuf = 0;
+  w->offset = PRIME_GAPS_HEADER;
+  w->table = 0;
+  w->ncheck = w->maxcheck = 0;
+  w->interval = interval;
+  w->first_index = first_index;
+  w->count = 0;
+  w->prev = 0;
+
+  /* The header is filled in once we know the counts. */
+  memset(&h, 0, sizeof(h));
+  h.low = low;
+  h.high = high;
+  w->ok = (fwrite(&h, sizeof(h), 1, w->fp) == 1);
+
+  if ((low <= 2) && (high >= 2))  _pg_add(w, 2);
+  if ((low <= 3) && (high >= 3))  _pg_add(w, 3);
+  if ((low <= 5) && (high >= 5))  _pg_add(w, 5);
+  if (low < 7)  low = 7;
+  if (w->ok && low <= high) {
+    unsigned char* segment;
+    UV seg_base, seg_low, seg_high;
+    void* ctx = start_segment_primes(low, high, &segment);
+    while (w->ok && next_segment_primes(ctx, &seg_base, &seg_low, &seg_high)) {
+      START_DO_FOR_EACH_SIEVE_PRIME( segment, seg_base, seg_low, seg_high )
+        _pg_add(w, p);
+      END_DO_FOR_EACH_SIEVE_PRIME
+    }
+    end_segment_primes(ctx);
+  }
+  _pg_flush(w);
+
+  memcpy(h.magic, PRIME_GAPS_MAGIC, 8);
+  h.byteorder = PRIME_GAPS_BYTEORDER;
+  h.interval = interval;
+  h.count = w->count;
+  h.first_index = first_index;
+  h.ncheck = w->ncheck;
+  h.table_offset = w->offset;
+  if (w->ok && w->ncheck > 0)
+    w->ok = (fwrite(w->table, 3*sizeof(uint64_t), w->ncheck, w->fp) == w->ncheck);
+  if (w->ok)
+    w->ok = (fseek(w->fp, 0, SEEK_SET) == 0) && (fwrite(&h, sizeof(h), 1, w->fp) == 1);
+  ok = (fclose(w->fp) == 0) && w->ok;
+  if (count != 0)  *count = w->count;
+  if (w->table != 0)  Safefree(w->table);
+  Safefree(w);
+
+#if !(defined(__unix__) || (defined(__APPLE__) && defined(__MACH__)))
+  if (ok) remove(filename);   /* rename won't replace on Win32 */
+#endif
+  if (ok) ok = (rename(tmpname, filename) == 0);
+  if (!ok) remove(tmpname);
+  Safefree(tmpname);
+  return ok;
+}
+
+int prime_gaps_header(const unsigned char* buf, UV filesize, prime_gaps_info_t* info)
+{
+  prime_gaps_file_header_t h;
+  memcpy(&h, buf, sizeof(h));
+  if (memcmp(h.magic, PRIME_GAPS_MAGIC, 8) != 0)  return 0;
+  if (h.byteorder != PRIME_GAPS_BYTEORDER)        return 0;
+  if (h.interval == 0 || h.interval > PRIME_GAPS_MAX_INTERVAL)  return 0;
+  if ((uint64_t)(UV)h.high != h.high || h.low > h.high)  return 0;
+  if ((uint64_t)(UV)h.first_index != h.first_index)      return 0;
+  if (h.ncheck != h.count/h.interval + (h.count % h.interval != 0))  return 0;
+  if (h.table_offset < PRIME_GAPS_HEADER || h.table_offset > filesize)  return 0;
+  if (h.ncheck > (filesize - h.table_offset) / PRIME_GAPS_CHECK_BYTES)  return 0;
+  if (h.table_offset + h.ncheck * PRIME_GAPS_CHECK_BYTES != filesize)   return 0;
+  info->low = h.low;
+  info->high = h.high;
+  info->count = h.count;
+  info->first_index = h.first_index;
+  info->interval = h.interval;
+  info->ncheck = h.ncheck;
+  info->table_offset = h.table_offset;
+  return 1;
+}
+
+int prime_gaps_checkpoint(const prime_gaps_info_t* info, const unsigned char* table, UV j, UV* prime, UV* index, UV* offset)
+{
+  uint64_t c[3];
+  if (j >= info->ncheck)  return 0;
+  memcpy(c, table + j*PRIME_GAPS_CHECK_BYTES, sizeof(c));
+  if (c[0] < info->low || c[0] > info->high)  return 0;
+  if (c[1] != info->first_index + j*info->interval)  return 0;
+  if (c[2] < PRIME_GAPS_HEADER || c[2] > info->table_offset)  return 0;
+  *prime = c[0];
+  *index = c[1];
+  *offset = c[2];
+  return 1;
+}
+
+UV prime_gaps_decode(const unsigned char* buf, UV nbytes, UV first, UV* out, UV n)
+{
+  UV i = 0, k = 0, p = first;
+  if (n == 0)  return 0;
+  out[i++] = p;
+  while (i < n && k < nbytes) {
+    UV v = buf[k++];
+    if (v & 0x80) {
+      v &= 0x7F;
+      while (k < nbytes && (buf[k] & 0x80))
+        v = (v << 7) | (buf[k++] & 0x7F);
+      if (k >= nbytes)  break;
+      v = (v << 7) | buf[k++];
+    }
+    if (p == 2) {
+      if (v != 0)  break;
+      p = 3;
+    } else {
+      if (v == 0 || v > (UV_MAX - p) >> 1)  break;
+      p += 2*v;
+    }
+    out[i++] = p;
+  }
+  return i;
+}
@@ -0,0 +1,45 @@
+#ifndef MPU_PRIMEGAPS_H
+#define MPU_PRIMEGAPS_H
+
+#include "ptypes.h"
+
+  /* Prime gap files hold the primes in a range compactly, for archiving
+   * lists that are re-read often.  Primes are split into blocks of interval
+   * consecutive primes.  A table at the end of the file holds a checkpoint
+   * for each block: its first prime, that prime's index, and the offset of
+   * the rest of the block, which is stored as half-gaps in BER varints
+   * (as pack "w").  Nearly every gap takes one byte.
+   *
+   * Ex:
+   *   prime_gaps_save("p.gaps", 1e9, 2e9, 4096, prime_count(1e9)+1, &count);
+   *   ...read PRIME_GAPS_HEADER bytes from the file into buf...
+   *   if (!prime_gaps_header(buf, filesize, &info)) ...not a gap file...
+   */
+#define PRIME_GAPS_HEADER       64
+#define PRIME_GAPS_CHECK_BYTES  24
+#define PRIME_GAPS_MAX_INTERVAL (1U << 20)
+
+typedef struct {
+  UV low;
+  UV high;
+  UV count;         /* primes in the file */
+  UV first_index;   /* pi(first prime), or 0 if not recorded */
+  UV interval;      /* primes per block */
+  UV ncheck;        /* blocks */
+  UV table_offset;  /* file offset of the checkpoint table */
+} prime_gaps_info_t;
+
+  /* Write the primes from low to high to filename.  Returns 1 and sets
+   * count on success, 0 if the file couldn't be written. */
+extern int prime_gaps_save(const char* filename, UV low, UV high, UV interval, UV first_index, UV* count);
+  /* Fill info from the header in buf, checking it against the file size.
+   * Returns 0 if it isn't a valid header for this machine. */
+extern int prime_gaps_header(const unsigned char* buf, UV filesize, prime_gaps_info_t* info);
+  /* Read checkpoint j from the table.  Returns 0 if it is inconsistent. */
+extern int prime_gaps_checkpoint(const prime_gaps_info_t* info, const unsigned char* table, UV j, UV* prime, UV* index, UV* offset);
+  /* Decode a block starting with first from the nbytes gaps in buf, putting
+   * n primes in out.  Returns the number decoded, less than n if buf is
+   * short or bad. */
+extern UV prime_gaps_decode(const unsigned char* buf, UV nbytes, UV first, UV* out, UV n);
+
+#endif
@@ -10,6 +10,7 @@
 #define FUNC_isqrt 1
 #include "util.h"
 #include "primality.h"
+#include "parallel.h"
 
 /* Is it better to do a partial sieve + primality tests vs. full sieve? */
 static int do_partial_sieve(UV startp, UV endp) {
@@ -214,6 +215,43 @@ static const int wheel2xmap[30] =     /* (2*p)%30 => 2,14,22,26,4,8,16,28 */
 static const UV max_sieve_prime = (BITS_PER_WORD==64) ? 4294967291U : 65521U;
 
 
+/* Wider presieve patterns, built once by sieve_presieve_init.  presieve17
+ * marks 7, 11, 13, and 17, presieve23 marks 19 and 23, and presieve31 marks
+ * 29 and 31.  Each is followed by a copy of its first word so a whole word
+ * can be read at any offset.  Filling is a single pass ORing the three
+ * patterns a word at a time, which is cheaper than sieving 17 through 31. */
+#define PRESIEVE17_SIZE (7*11*13*17)
+#define PRESIEVE23_SIZE (19*23)
+#define PRESIEVE31_SIZE (29*31)
+static unsigned char presieve17[PRESIEVE17_SIZE + sizeof(UV)];
+static unsigned char presieve23[PRESIEVE23_SIZE + sizeof(UV)];
+static unsigned char presieve31[PRESIEVE31_SIZE + sizeof(UV)];
+static int presieve_ready = 0;
+
+static void _make_presieve(unsigned char* pat, UV size, UV p1, UV p2, UV p3, UV p4)
+{
+  UV d;
+  int i;
+  for (d = 0; d < size; d++) {
+    pat[d] = 0;
+    for (i = 0; i < 8; i++) {
+      UV n = 30*d + wheel30[i];
+      if (n%p1 == 0 || n%p2 == 0 || (p3 && n%p3 == 0) || (p4 && n%p4 == 0))
+        pat[d] |= (1 << i);
+    }
+  }
+  memcpy(pat + size, pat, sizeof(UV));
+}
+
+void sieve_presieve_init(void)
+{
+  if (presieve_ready) return;
+  _make_presieve(presieve17, PRESIEVE17_SIZE, 7, 11, 13, 17);
+  _make_presieve(presieve23, PRESIEVE23_SIZE, 19, 23, 0, 0);
+  _make_presieve(presieve31, PRESIEVE31_SIZE, 29, 31, 0, 0);
+  presieve_ready = 1;
+}
+
 static void memtile(unsigned char* src, UV from, UV to) {
   while (from < to) {
     UV bytes = (2*from > to) ? to-from : from;
@@ -228,6 +266,35 @@ static UV sieve_prefill(unsigned char* mem, UV startd, UV endd)
   UV nbytes = endd - startd + 1;
   MPUassert( (mem != 0) && (endd >= startd), "sieve_prefill bad arguments");
 
+  if (presieve_ready) {
+    UV i;
+    UV o17 = startd % PRESIEVE17_SIZE;
+    UV o23 = startd % PRESIEVE23_SIZE;
+    UV o31 = startd % PRESIEVE31_SIZE;
+    for (i = 0; i + sizeof(UV) <= nbytes; i += sizeof(UV)) {
+      UV w, w23, w31;
+      memcpy(&w,   presieve17 + o17, sizeof(UV));
+      memcpy(&w23, presieve23 + o23, sizeof(UV));
+      memcpy(&w31, presieve31 + o31, sizeof(UV));
+      w |= w23 | w31;
+      memcpy(mem + i, &w, sizeof(UV));
+      o17 += sizeof(UV);  if (o17 >= PRESIEVE17_SIZE) o17 -= PRESIEVE17_SIZE;
+      o23 += sizeof(UV);  if (o23 >= PRESIEVE23_SIZE) o23 -= PRESIEVE23_SIZE;
+      o31 += sizeof(UV);  if (o31 >= PRESIEVE31_SIZE) o31 -= PRESIEVE31_SIZE;
+    }
+    for ( ; i < nbytes; i++) {
+      mem[i] = presieve17[o17] | presieve23[o23] | presieve31[o31];
+      if (++o17 >= PRESIEVE17_SIZE) o17 = 0;
+      if (++o23 >= PRESIEVE23_SIZE) o23 = 0;
+      if (++o31 >= PRESIEVE31_SIZE) o31 = 0;
+    }
+    if (startd == 0)             /* Correct the first bytes */
+      mem[0] = 0x01;
+    if (startd <= 1 && endd >= 1)   /* 31 is prime */
+      mem[1-startd] &= ~0x01;
+    return 37;
+  }
+
   if (startd != 0) {
     UV pstartd = startd % PRESIEVE_SIZE;
     UV tailbytes = PRESIEVE_SIZE - pstartd;
@@ -241,7 +308,6 @@ static UV sieve_prefill(unsigned char* mem, UV startd, UV endd)
     memtile(mem, PRESIEVE_SIZE, nbytes);
     if (startd == 0) mem[0] = 0x01; /* Correct first byte */
   }
-  /* Leaving option open to tile 17 out and sieve, then return 19 */
   return vnext_prime;
 }
 
@@ -256,7 +322,7 @@ unsigned char* sieve_erat30(UV end)
   max_buf = ((max_buf + sizeof(UV) - 1) / sizeof(UV)) * sizeof(UV);
   New(0, mem, max_buf, unsigned char );
 
-  /* Fill buffer with marked 7, 11, and 13 */
+  /* Fill buffer with the small primes marked */
   prime = sieve_prefill(mem, 0, max_buf-1);
 
   limit = isqrt(end);  /* prime*prime can overflow */
@@ -304,40 +370,26 @@ unsigned char* sieve_erat30(UV end)
 
 
 
-int sieve_segment(unsigned char* mem, UV startd, UV endd)
+/* The largest sieving prime needed for the segment, and the (possibly
+ * smaller) one we will sieve to before finishing with primality tests. */
+static UV _segment_sieve_limit(UV startp, UV endp, UV* slimit)
 {
-  const unsigned char* sieve;
-  UV limit, slimit, start_base_prime, sieve_size;
-  UV startp = 30*startd;
-  UV endp = (endd >= (UV_MAX/30))  ?  UV_MAX-2  :  30*endd+29;
-
-  MPUassert( (mem != 0) && (endd >= startd) && (endp >= startp),
-             "sieve_segment bad arguments");
-
-  /* It's possible we can just use the primary cache */
-  sieve_size = get_prime_cache(0, &sieve);
-  if (sieve_size >= endp) {
-    memcpy(mem, sieve+startd, endd-startd+1);
-    release_prime_cache(sieve);
-    return 1;
-  }
-
-  /* Fill buffer with marked 7, 11, and 13 */
-  start_base_prime = sieve_prefill(mem, startd, endd);
-
-  limit = isqrt(endp);  /* floor(sqrt(n)), will include p if p*p=endp */
+  UV limit = isqrt(endp);  /* floor(sqrt(n)), will include p if p*p=endp */
   /* Don't use a sieve prime such that p*p > UV_MAX */
   if (limit > max_sieve_prime)  limit = max_sieve_prime;
-  slimit = limit;
+  *slimit = limit;
   if (do_partial_sieve(startp, endp))
-    slimit >>= ((startp < (UV)1e16) ? 8 : 10);
-  /* printf("segment sieve from %"UVuf" to %"UVuf" (aux sieve to %"UVuf")\n", startp, endp, slimit); */
-  if (slimit > sieve_size) {
-    release_prime_cache(sieve);
-    get_prime_cache(slimit, &sieve);
-  }
+    *slimit >>= ((startp < (UV)1e16) ? 8 : 10);
+  return limit;
+}
+
+/* Mark the multiples of the primes from plo to phi in mem. */
+static void _sieve_prime_range(unsigned char* mem, UV startd, UV endd, const unsigned char* sieve, UV plo, UV phi)
+{
+  UV startp = 30*startd;
+  UV endp = (endd >= (UV_MAX/30))  ?  UV_MAX-2  :  30*endd+29;
 
-  START_DO_FOR_EACH_SIEVE_PRIME(sieve, 0, start_base_prime, slimit)
+  START_DO_FOR_EACH_SIEVE_PRIME(sieve, 0, plo, phi)
   {
     /* p increments from 17 to at most sqrt(endp).  Note on overflow:
      * 32-bit: limit=     65535, max p =      65521, p*p = ~0-1965854
@@ -398,7 +450,28 @@ int sieve_segment(unsigned char* mem, UV startd, UV endd)
     }
   }
   END_DO_FOR_EACH_SIEVE_PRIME;
-  release_prime_cache(sieve);
+}
+
+/* Sieve mem from startd to endd using the primes up to slimit in sieve,
+ * except for any from skiplo to skiphi (which the caller handles).
+ * If slimit is less than limit, finish with primality tests. */
+static void _sieve_segment_with(unsigned char* mem, UV startd, UV endd, const unsigned char* sieve, UV limit, UV slimit, UV skiplo, UV skiphi)
+{
+  UV start_base_prime;
+  UV startp = 30*startd;
+  UV endp = (endd >= (UV_MAX/30))  ?  UV_MAX-2  :  30*endd+29;
+
+  /* Fill buffer with the small primes marked */
+  start_base_prime = sieve_prefill(mem, startd, endd);
+
+  if (skiphi < skiplo || skiplo > slimit || skiphi < start_base_prime) {
+    _sieve_prime_range(mem, startd, endd, sieve, start_base_prime, slimit);
+  } else {
+    if (skiplo > start_base_prime)
+      _sieve_prime_range(mem, startd, endd, sieve, start_base_prime, skiplo-1);
+    if (skiphi < slimit)
+      _sieve_prime_range(mem, startd, endd, sieve, skiphi+1, slimit);
+  }
 
   if (limit > slimit) { /* We've sieved out most composites, but not all. */
     START_DO_FOR_EACH_SIEVE_PRIME(mem, 0, 0, endp-startp) {
@@ -406,6 +479,69 @@ int sieve_segment(unsigned char* mem, UV startd, UV endd)
         mem[d_] |= mask_;           /* mark the sieve location.       */
     } END_DO_FOR_EACH_SIEVE_PRIME;
   }
+}
+
+/* Extend a sieve.  The first oldend/30 bytes are copied from old, and the
+ * rest is segment sieved using old for the base primes.  If old doesn't
+ * go to sqrt(end) we just sieve from scratch. */
+#define EXTEND_SEGMENT_BYTES  (128*1024)
+unsigned char* sieve_erat30_extend(const unsigned char* old, UV oldend, UV end)
+{
+  unsigned char* mem;
+  UV max_buf, startd, limit;
+
+  limit = isqrt(end);
+  if (limit > max_sieve_prime)  limit = max_sieve_prime;
+  if (old == 0 || oldend >= end || limit > oldend)
+    return sieve_erat30(end);
+
+  max_buf = (end/30) + ((end%30) != 0);
+  max_buf = ((max_buf + sizeof(UV) - 1) / sizeof(UV)) * sizeof(UV);
+  New(0, mem, max_buf, unsigned char );
+
+  startd = oldend/30;
+  memcpy(mem, old, startd);
+  while (startd < max_buf) {
+    UV endd = (max_buf-startd > EXTEND_SEGMENT_BYTES)
+            ? startd + EXTEND_SEGMENT_BYTES - 1
+            : max_buf-1;
+    _sieve_segment_with(mem+startd, startd, endd, old, limit, limit, 1, 0);
+    startd = endd+1;
+  }
+  return mem;
+}
+
+static void _sieve_segment(unsigned char* mem, UV startd, UV endd, UV skiplo, UV skiphi)
+{
+  const unsigned char* sieve;
+  UV limit, slimit, sieve_size;
+  UV startp = 30*startd;
+  UV endp = (endd >= (UV_MAX/30))  ?  UV_MAX-2  :  30*endd+29;
+
+  MPUassert( (mem != 0) && (endd >= startd) && (endp >= startp),
+             "sieve_segment bad arguments");
+
+  /* It's possible we can just use the primary cache */
+  sieve_size = get_prime_cache(0, &sieve);
+  if (sieve_size >= endp) {
+    memcpy(mem, sieve+startd, endd-startd+1);
+    release_prime_cache(sieve);
+    return;
+  }
+
+  limit = _segment_sieve_limit(startp, endp, &slimit);
+  /* printf("segment sieve from %"UVuf" to %"UVuf" (aux sieve to %"UVuf")\n", startp, endp, slimit); */
+  if (slimit > sieve_size) {
+    release_prime_cache(sieve);
+    get_prime_cache(slimit, &sieve);
+  }
+  _sieve_segment_with(mem, startd, endd, sieve, limit, slimit, skiplo, skiphi);
+  release_prime_cache(sieve);
+}
+
+int sieve_segment(unsigned char* mem, UV startd, UV endd)
+{
+  _sieve_segment(mem, startd, endd, 1, 0);
   return 1;
 }
 
@@ -418,10 +554,159 @@ typedef struct {
   UV high;
   UV endp;
   UV segment_size;
+  int segment_is_pooled;   /* from get_prime_segment rather than New */
+  int reverse;             /* segments are returned from high to low */
   unsigned char* segment;
   unsigned char* base;
+  /* Used when sieving segments with multiple threads */
+  unsigned char** segmentmem;
+  void* pipe;
+  void** slots;
+  int nslots;
+  unsigned char* basesieve;
+  UV limit;
+  UV slimit;
+  /* Bucket sieve for large primes, used when sieving serially */
+  struct bucket_s* buckets;
+  UV nbuckets;
+  UV nsegments;
+  UV segnum;
+  UV bucket_plo;
+  UV bucket_phi;
+  /* Per-segment work run where the segment was sieved */
+  segment_work_fn work;
+  void* workarg;
+  unsigned char* worksegment;
+  UV outoff;                 /* the work output follows the segment */
+  UV slotbytes;
 } segment_context_t;
 
+/*
+ * Bucket sieve (in the style of Oliveira e Silva) for sieving primes that
+ * are much larger than the segment.  Each such prime hits a segment at most
+ * once, so rather than looking at every one of them for every segment, we
+ * file each prime under the next segment it hits.  When that segment comes
+ * up we mark the hit and file it again under its following segment.
+ *
+ * Entries hold the prime and its next hit as a byte offset into that
+ * segment, with the wheel position in the top bits.  The buckets are used
+ * circularly, since no prime can skip further ahead than nbuckets.
+ *
+ * Only primes with p*p below the start of the range are used, so each one
+ * starts within the bucket window.  Memory is capped by keeping just the
+ * largest primes, which are the ones that gain the most.  Filling the
+ * buckets costs about one segment's worth of work, so short ranges skip it.
+ */
+#define BUCKET_POS_BITS     29
+#define BUCKET_POS_MASK     ((UVCONST(1) << BUCKET_POS_BITS) - 1)
+#define BUCKET_MAX_ENTRIES  (UVCONST(32)*1024*1024)   /* 256MB */
+#define BUCKET_MIN_SEGMENTS 4
+
+typedef struct {
+  uint32_t p;
+  uint32_t pos;
+} bucket_entry_t;
+
+typedef struct bucket_s {
+  bucket_entry_t* e;
+  UV n;
+  UV alloc;
+} bucket_t;
+
+/* File prime p under the segment holding byte offset off (from lod) */
+static void _bucket_add(segment_context_t* ctx, UV p, UV off, int w)
+{
+  UV seg = off / ctx->segment_size;
+  bucket_t* b;
+  if (seg >= ctx->nsegments) return;
+  b = &(ctx->buckets[seg % ctx->nbuckets]);
+  if (b->n >= b->alloc) {
+    b->alloc = (b->alloc == 0) ? 1024 : 2*b->alloc;
+    Renew(b->e, b->alloc, bucket_entry_t);
+  }
+  b->e[b->n].p = (uint32_t) p;
+  b->e[b->n].pos = (uint32_t) ((off - seg*ctx->segment_size) | ((UV)w << BUCKET_POS_BITS));
+  b->n++;
+}
+
+static void _start_buckets(segment_context_t* ctx)
+{
+  const unsigned char* sieve;
+  UV size = ctx->segment_size;
+  UV startp = 30*ctx->lod;
+  UV limit, slimit, plo, phi, maxstep;
+
+  ctx->buckets = 0;
+  ctx->nsegments = (ctx->hid - ctx->lod) / size + 1;
+  if (ctx->nsegments < BUCKET_MIN_SEGMENTS || size > BUCKET_POS_MASK)
+    return;
+  if (get_prime_cache(0, 0) >= ctx->endp)  /* Segments come from the cache */
+    return;
+  limit = _segment_sieve_limit(startp, ctx->endp, &slimit);
+  if (slimit < limit)
+    return;
+  /* 2p/30 > size means no more than one hit per segment */
+  plo = 15*size + 30;
+  phi = isqrt(startp);
+  if (phi > limit)  phi = limit;
+  if (plo >= phi)
+    return;
+  {
+    double span = (double)BUCKET_MAX_ENTRIES * log((double)phi);
+    if ((double)(phi-plo) > span)  plo = phi - (UV)span;
+  }
+
+  maxstep = (6*phi)/30 + 4;
+  ctx->nbuckets = maxstep/size + 2;
+  Newz(0, ctx->buckets, ctx->nbuckets, bucket_t);
+  ctx->segnum = 0;
+  ctx->bucket_plo = plo;
+  ctx->bucket_phi = phi;
+
+  get_prime_cache(phi, &sieve);
+  START_DO_FOR_EACH_SIEVE_PRIME(sieve, 0, plo, phi) {
+    UV f = 1+(startp-1)/p;                      /* p*p <= startp */
+    UV p2 = p * (f + distancewheel30[f%30]);
+    if (p2 >= startp && p2 <= ctx->endp)
+      _bucket_add(ctx, p, p2/30 - ctx->lod, wheelmap[p2%30]);
+  } END_DO_FOR_EACH_SIEVE_PRIME;
+  release_prime_cache(sieve);
+}
+
+/* Mark this segment's hits from the bucket and refile each prime. */
+static void _apply_bucket(segment_context_t* ctx, unsigned char* mem, UV nbytes)
+{
+  bucket_t* b = &(ctx->buckets[ctx->segnum % ctx->nbuckets]);
+  UV segoff = ctx->segnum * ctx->segment_size;
+  UV i, n = b->n;
+
+  b->n = 0;   /* Entries always move to a later bucket */
+  for (i = 0; i < n; i++) {
+    UV p = b->e[i].p;
+    UV off = b->e[i].pos & BUCKET_POS_MASK;
+    int w = b->e[i].pos >> BUCKET_POS_BITS;
+    const unsigned char* steps;
+    int v;
+    if (off >= nbytes)  continue;               /* Past the end of the range */
+    mem[off] |= (1 << w);
+    steps = stepdata[w][wheel2xmap[(2*p) % 30]];
+    v = steps[0];
+    off += ((2*p)/30) * (v>>5) + ((v>>3) & 0x3);
+    _bucket_add(ctx, p, segoff + off, steps[1] & 0x7);
+  }
+  ctx->segnum++;
+}
+
+static void _end_buckets(segment_context_t* ctx)
+{
+  UV i;
+  for (i = 0; i < ctx->nbuckets; i++)
+    if (ctx->buckets[i].e != 0)
+      Safefree(ctx->buckets[i].e);
+  Safefree(ctx->buckets);
+  ctx->buckets = 0;
+}
+
 /*
  * unsigned char* segment;
  * UV seg_base, seg_low, seg_high;
@@ -437,9 +722,67 @@ typedef struct {
  *   END_DO_FOR_EACH_SIEVE_PRIME
  * }
  * end_segment_primes(ctx);
+ *
+ * When using multiple threads, segment will point to a different buffer
+ * after each call to next_segment_primes, so it must not be saved.
  */
 
-void* start_segment_primes(UV low, UV high, unsigned char** segmentmem)
+/* The bytes and values covered by segment task when sieving in parallel
+ * or in reverse.  Reverse tasks count down from the last segment. */
+static void _segment_task_range(const segment_context_t* ctx, UV task, UV* lod, UV* hid, UV* low, UV* high)
+{
+  if (ctx->reverse)  task = ctx->nsegments - 1 - task;
+  *lod = ctx->lod + task * ctx->segment_size;
+  *hid = ((ctx->hid - *lod) < ctx->segment_size)
+       ? ctx->hid
+       : (*lod + ctx->segment_size - 1);
+  *low = (task == 0) ? ctx->low : *lod*30 + 1;
+  *high = (*hid == ctx->hid) ? ctx->high : (*hid*30 + 29);
+}
+
+/* Runs in a worker thread.  Only looks at the read-only context fields. */
+static void _sieve_segment_task(void* vctx, UV task, void* slot)
+{
+  segment_context_t* ctx = (segment_context_t*) vctx;
+  unsigned char* seg = (unsigned char*) slot;
+  UV lod, hid, low, high;
+  _segment_task_range(ctx, task, &lod, &hid, &low, &high);
+  _sieve_segment_with(seg, lod, hid, ctx->basesieve, ctx->limit, ctx->slimit, 1, 0);
+  if (ctx->work != 0)
+    ctx->work(ctx->workarg, seg, lod*30, low, high, seg + ctx->outoff);
+}
+
+static void _start_parallel_segments(segment_context_t* ctx, int nthreads)
+{
+  const unsigned char* sieve;
+  UV nsegments = (ctx->hid - ctx->lod) / ctx->segment_size + 1;
+  UV nbytes;
+  int i;
+
+  if ((UV)nthreads > nsegments)  nthreads = (int) nsegments;
+  ctx->limit = _segment_sieve_limit(30*ctx->lod, ctx->endp, &(ctx->slimit));
+
+  /* The workers get a private copy of the base primes, so nobody can
+   * resize or free the primary cache out from under them. */
+  nbytes = ctx->slimit/30 + 1;
+  get_prime_cache(ctx->slimit, &sieve);
+  New(0, ctx->basesieve, nbytes, unsigned char);
+  memcpy(ctx->basesieve, sieve, nbytes);
+  release_prime_cache(sieve);
+
+  /* Two buffers per thread lets the workers stay ahead of the consumer. */
+  ctx->nslots = (2*(UV)nthreads < nsegments) ? 2*nthreads : (int) nsegments;
+  New(0, ctx->slots, ctx->nslots, void*);
+  ctx->slots[0] = ctx->segment;
+  for (i = 1; i < ctx->nslots; i++)
+    New(0, ctx->slots[i], ctx->slotbytes, unsigned char);
+
+  if (_XS_get_verbose() >= 2)
+    printf("segment sieve: %lu segments using %d threads\n", (unsigned long)nsegments, nthreads);
+  ctx->pipe = start_parallel_tasks(nthreads, nsegments, ctx->nslots, ctx->slots, _sieve_segment_task, ctx);
+}
+
+static void* _start_segment_primes(UV low, UV high, unsigned char** segmentmem, int nthreads, int reverse, UV segbytes, UV outsize, segment_work_fn work, void* workarg)
 {
   segment_context_t* ctx;
   UV slimit;
@@ -451,10 +794,28 @@ void* start_segment_primes(UV low, UV high, unsigned char** segmentmem)
   ctx->lod = low / 30;
   ctx->hid = high / 30;
   ctx->endp = (ctx->hid >= (UV_MAX/30))  ?  UV_MAX-2  :  30*ctx->hid+29;
-
+  ctx->segmentmem = (segmentmem != 0) ? segmentmem : &(ctx->worksegment);
+  ctx->buckets = 0;
+  ctx->pipe = 0;
+  ctx->slots = 0;
+  ctx->nslots = 0;
+  ctx->basesieve = 0;
+  ctx->work = work;
+  ctx->workarg = workarg;
+  ctx->outoff = 0;
+  ctx->reverse = reverse;
+
+  if (work != 0) {
+    ctx->segment_size = segbytes;
+    ctx->outoff = (segbytes + 15) & ~(UV)15;
+    ctx->slotbytes = ctx->outoff + outsize;
+    New(0, ctx->segment, ctx->slotbytes, unsigned char);
+    ctx->segment_is_pooled = 0;
+  } else
 #if BITS_PER_WORD == 64
-  if (high > 1e11 && high-low > 1e6) {
-    UV range = (high-low+29)/30;
+  /* Reverse walks usually stop early, so they keep small segments. */
+  if (!reverse && high > 1e11 && high-low > 1e6) {
+    UV range = ctx->hid - ctx->lod + 1;
     /* Select what we think would be a good segment size */
     UV size = isqrt(isqrt(high)) * ((high < 1e15) ? 500 : 250);
     /* Evenly split the range into segments */
@@ -464,25 +825,90 @@ void* start_segment_primes(UV low, UV high, unsigned char** segmentmem)
       printf("segment sieve: byte range %lu split into %lu segments of size %lu\n", (unsigned long)range, (unsigned long)div, (unsigned long)size);
     ctx->segment_size = size;
     New(0, ctx->segment, size, unsigned char);
+    ctx->segment_is_pooled = 0;
   } else
 #endif
-  ctx->segment = get_prime_segment( &(ctx->segment_size) );
-  *segmentmem = ctx->segment;
+  {
+    ctx->segment = get_prime_segment( &(ctx->segment_size) );
+    ctx->segment_is_pooled = 1;
+  }
+  if (work == 0)
+    ctx->slotbytes = ctx->segment_size;
+  *(ctx->segmentmem) = ctx->segment;
 
   ctx->base = 0;
+  ctx->nsegments = (ctx->hid - ctx->lod) / ctx->segment_size + 1;
+  ctx->segnum = 0;
+
+  /* Split the work over threads if we have more than one segment to sieve,
+   * unless the primary cache already covers the range. */
+  if (nthreads > 1 && (ctx->hid - ctx->lod) >= ctx->segment_size
+                   && get_prime_cache(0, 0) < ctx->endp) {
+    _start_parallel_segments(ctx, nthreads);
+    return (void*) ctx;
+  }
+
   /* Expand primary cache so we won't regen each call */
   slimit = isqrt(ctx->endp)+1;
   if (do_partial_sieve(low, high))  slimit >>= 8;
   get_prime_cache( slimit, 0);
 
+  if (!reverse)  _start_buckets(ctx);
+
   return (void*) ctx;
 }
 
+void* start_segment_primes(UV low, UV high, unsigned char** segmentmem)
+{
+  return _start_segment_primes(low, high, segmentmem, _XS_get_threads(), 0, 0, 0, 0, 0);
+}
+
+void* start_segment_primes_serial(UV low, UV high, unsigned char** segmentmem)
+{
+  return _start_segment_primes(low, high, segmentmem, 1, 0, 0, 0, 0, 0);
+}
+
+void* start_segment_primes_reverse(UV low, UV high, unsigned char** segmentmem)
+{
+  return _start_segment_primes(low, high, segmentmem, _XS_get_threads(), 1, 0, 0, 0, 0);
+}
+
+void* start_segment_work(UV low, UV high, UV segbytes, UV outsize, segment_work_fn work, void* workarg)
+{
+  MPUassert( work != 0 && segbytes > 0, "start_segment_work bad arguments");
+  return _start_segment_primes(low, high, 0, _XS_get_threads(), 0, segbytes, outsize, work, workarg);
+}
+
+void* segment_work_output(void* vctx)
+{
+  segment_context_t* ctx = (segment_context_t*) vctx;
+  return *(ctx->segmentmem) + ctx->outoff;
+}
+
 int next_segment_primes(void* vctx, UV* base, UV* low, UV* high)
 {
   UV seghigh_d, range_d;
   segment_context_t* ctx = (segment_context_t*) vctx;
 
+  if (ctx->pipe != 0) {
+    UV task, lod;
+    unsigned char* seg = (unsigned char*) next_parallel_task(ctx->pipe, &task);
+    if (seg == 0) return 0;
+    _segment_task_range(ctx, task, &lod, &seghigh_d, low, high);
+    *base = lod * 30;
+    *(ctx->segmentmem) = seg;
+    return 1;
+  }
+
+  if (ctx->reverse) {
+    UV lod;
+    if (ctx->segnum >= ctx->nsegments) return 0;
+    _segment_task_range(ctx, ctx->segnum++, &lod, &seghigh_d, low, high);
+    *base = lod * 30;
+    sieve_segment(ctx->segment, lod, seghigh_d);
+    return 1;
+  }
+
   if (ctx->lod > ctx->hid) return 0;
 
   seghigh_d = ((ctx->hid - ctx->lod) < ctx->segment_size)
@@ -496,7 +922,14 @@ int next_segment_primes(void* vctx, UV* base, UV* low, UV* high)
   MPUassert( seghigh_d >= ctx->lod, "next_segment_primes: highd < lowd");
   MPUassert( range_d <= ctx->segment_size, "next_segment_primes: range > segment size");
 
-  sieve_segment(ctx->segment, ctx->lod, seghigh_d);
+  if (ctx->buckets != 0) {
+    _sieve_segment(ctx->segment, ctx->lod, seghigh_d, ctx->bucket_plo, ctx->bucket_phi);
+    _apply_bucket(ctx, ctx->segment, range_d);
+  } else {
+    sieve_segment(ctx->segment, ctx->lod, seghigh_d);
+  }
+  if (ctx->work != 0)
+    ctx->work(ctx->workarg, ctx->segment, *base, *low, *high, ctx->segment + ctx->outoff);
 
   ctx->lod += range_d;
   ctx->low = *high + 2;
@@ -504,12 +937,56 @@ int next_segment_primes(void* vctx, UV* base, UV* low, UV* high)
   return 1;
 }
 
+int next_each_prime_segment(void* vctx, const unsigned char** sieve, UV* base, UV* lastd)
+{
+  segment_context_t* ctx = (segment_context_t*) vctx;
+  UV seg_low, seg_high;
+  if (!next_segment_primes(vctx, base, &seg_low, &seg_high))
+    return 0;
+  *sieve = ctx->segment;
+  *lastd = (seg_high - *base) / 30;
+  return 1;
+}
+
+void* start_each_prime_segments(UV low, UV high, UV* first, const unsigned char** sieve, UV* base, UV* lastd)
+{
+  unsigned char* segment;
+  UV seg_base, seg_low, seg_high;
+  void* ctx = start_segment_primes_serial(low, high, &segment);
+  *first = 0;
+  while (next_segment_primes(ctx, &seg_base, &seg_low, &seg_high)) {
+    START_DO_FOR_EACH_SIEVE_PRIME( segment, seg_base, seg_low, seg_high )
+      *first = p;
+      break;
+    END_DO_FOR_EACH_SIEVE_PRIME
+    if (*first != 0) {
+      *sieve = segment;
+      *base = seg_base;
+      *lastd = (seg_high - seg_base) / 30;
+      break;
+    }
+  }
+  return ctx;
+}
+
 void end_segment_primes(void* vctx)
 {
   segment_context_t* ctx = (segment_context_t*) vctx;
   MPUassert(ctx != 0, "end_segment_primes given a null pointer");
+  if (ctx->buckets != 0)
+    _end_buckets(ctx);
+  if (ctx->pipe != 0) {
+    int i;
+    end_parallel_tasks(ctx->pipe);
+    ctx->pipe = 0;
+    for (i = 1; i < ctx->nslots; i++)
+      Safefree(ctx->slots[i]);
+    Safefree(ctx->slots);
+    Safefree(ctx->basesieve);
+  }
   if (ctx->segment != 0) {
-    release_prime_segment(ctx->segment);
+    if (ctx->segment_is_pooled)  release_prime_segment(ctx->segment);
+    else                         Safefree(ctx->segment);
     ctx->segment = 0;
   }
   if (ctx->base != 0) {
@@ -518,3 +995,24 @@ void end_segment_primes(void* vctx)
   }
   Safefree(ctx);
 }
+
+UV range_primes(UV low, UV high, UV* list)
+{
+  UV n = 0;
+  if ((low <= 2) && (high >= 2)) list[n++] = 2;
+  if ((low <= 3) && (high >= 3)) list[n++] = 3;
+  if ((low <= 5) && (high >= 5)) list[n++] = 5;
+  if (low < 7)  low = 7;
+  if (low <= high) {
+    unsigned char* segment;
+    UV seg_base, seg_low, seg_high;
+    void* ctx = start_segment_primes_serial(low, high, &segment);
+    while (next_segment_primes(ctx, &seg_base, &seg_low, &seg_high)) {
+      START_DO_FOR_EACH_SIEVE_PRIME( segment, seg_base, seg_low, seg_high )
+        list[n++] = p;
+      END_DO_FOR_EACH_SIEVE_PRIME
+    }
+    end_segment_primes(ctx);
+  }
+  return n;
+}
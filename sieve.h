@@ -3,12 +3,39 @@
 
 #include "ptypes.h"
 
+/* Builds the wider presieve tables.  Call once before using threads. */
+extern void sieve_presieve_init(void);
 extern unsigned char* sieve_erat30(UV end);
+extern unsigned char* sieve_erat30_extend(const unsigned char* old, UV oldend, UV end);
 extern int sieve_segment(unsigned char* mem, UV startd, UV endd);
 extern void* start_segment_primes(UV low, UV high, unsigned char** segmentmem);
+/* Never uses threads.  For callers that may longjmp out of the loop. */
+extern void* start_segment_primes_serial(UV low, UV high, unsigned char** segmentmem);
+/* Segments come back from the top of the range down.  Only the segments
+ * asked for are sieved, so low can be a loose bound. */
+extern void* start_segment_primes_reverse(UV low, UV high, unsigned char** segmentmem);
 extern int next_segment_primes(void* vctx, UV* base, UV* low, UV* high);
 extern void end_segment_primes(void* vctx);
 
+/* Sieve in segments of segbytes bytes, also running work on each segment
+ * in the thread that sieved it.  work gets outsize bytes of its own to write
+ * results to, which segment_work_output returns after each call to
+ * next_segment_primes.  Like any parallel task, work runs outside of Perl
+ * (see parallel.h). */
+typedef void (*segment_work_fn)(void* arg, const unsigned char* segment, UV base, UV low, UV high, void* out);
+extern void* start_segment_work(UV low, UV high, UV segbytes, UV outsize, segment_work_fn work, void* workarg);
+extern void* segment_work_output(void* vctx);
+
+/* Segment walk used by START_DO_FOR_EACH_PRIME past the cache.  Start finds
+ * the first prime from low to high (0 if none) and the segment holding it,
+ * next moves to the following segment.  Finish with end_segment_primes. */
+extern void* start_each_prime_segments(UV low, UV high, UV* first, const unsigned char** sieve, UV* base, UV* lastd);
+extern int next_each_prime_segment(void* vctx, const unsigned char** sieve, UV* base, UV* lastd);
+
+/* Put the primes from low to high in list, returning how many.  The list
+ * must have room for 3 + 8*(high/30 - low/30 + 1) entries. */
+extern UV range_primes(UV low, UV high, UV* list);
+
 
 static const UV wheel30[] = {1, 7, 11, 13, 17, 19, 23, 29};
 /* Used for moving between primes */
@@ -113,29 +140,54 @@ static UV prev_prime_in_sieve(const unsigned char* sieve, UV p) {
     } \
   }
 
+/* Walk the primes from a to b.  Ranges inside the primary cache, or small
+ * enough that growing it is cheap, use the cache.  Larger ones are segment
+ * sieved so memory stays bounded.  The body may use break, and must use
+ * RETURN_FROM_EACH_PRIME to return. */
+#define EACH_PRIME_CACHE_MAX  UVCONST(10000000)
+
 #define START_DO_FOR_EACH_PRIME(a, b) \
   { \
     const unsigned char* sieve_; \
+    void* ctx_ = 0; \
     UV p  = a; \
     UV l_ = b; \
-    UV d_ = p/30; \
-    UV s_, mask_ = 2; \
+    UV base_ = 0; \
+    UV d_, s_, mask_ = 2; \
     UV lastd_ = l_/30; \
-    get_prime_cache(l_, &sieve_); \
-    s_ = sieve_[d_]; \
-    if (p <= 5) { \
-      p = (p <= 2) ? 2 : (p <= 3) ? 3 : 5; \
-    } else if (p != 7) { \
-      mask_ = masktab30[ p-d_*30 + distancewheel30[ p-d_*30 ] ]; \
-      while (d_ <= lastd_ && (s_ & mask_)) { \
-        mask_ <<= 1;  if (mask_ > 128) { s_ = sieve_[++d_]; mask_ = 1; } \
+    if (l_ <= EACH_PRIME_CACHE_MAX || get_prime_cache(0, 0) >= l_) { \
+      get_prime_cache(l_, &sieve_); \
+      d_ = p/30; \
+      s_ = sieve_[d_]; \
+      if (p <= 5) { \
+        p = (p <= 2) ? 2 : (p <= 3) ? 3 : 5; \
+      } else if (p != 7) { \
+        mask_ = masktab30[ p-d_*30 + distancewheel30[ p-d_*30 ] ]; \
+        while (d_ <= lastd_ && (s_ & mask_)) { \
+          mask_ <<= 1;  if (mask_ > 128) { s_ = sieve_[++d_]; mask_ = 1; } \
+        } \
+        p = d_*30 + imask30[mask_]; \
+      } \
+    } else { \
+      UV first_; \
+      ctx_ = start_each_prime_segments((p <= 7) ? 7 : p, l_, &first_, &sieve_, &base_, &lastd_); \
+      if (first_ == 0) {             /* No primes in the range */ \
+        p = 1;  l_ = 0; \
+      } else { \
+        d_ = (first_ - base_) / 30; \
+        mask_ = masktab30[first_ - base_ - d_*30]; \
+        s_ = sieve_[d_]; \
+        p = (p > 5) ? first_ : (p <= 2) ? 2 : (p <= 3) ? 3 : 5; \
       } \
-      p = d_*30 + imask30[mask_]; \
     } \
     while ( p <= l_ ) {
 
+#define END_EACH_PRIME_CLEANUP \
+    if (ctx_ != 0) { end_segment_primes(ctx_); } \
+    else           { release_prime_cache(sieve_); }
+
 #define RETURN_FROM_EACH_PRIME(retstmt) \
-    do { release_prime_cache(sieve_); retstmt; } while (0)
+    do { END_EACH_PRIME_CLEANUP  retstmt; } while (0)
 
 #define END_DO_FOR_EACH_PRIME \
       if (p < 7) { \
@@ -144,15 +196,20 @@ static UV prev_prime_in_sieve(const unsigned char* sieve, UV p) {
         do { \
           mask_ <<= 1; \
           if (mask_ > 128) { \
-            if (++d_ > lastd_) break; \
+            if (++d_ > lastd_) { \
+              if (ctx_ == 0 || !next_each_prime_segment(ctx_, &sieve_, &base_, &lastd_)) \
+                break; \
+              d_ = 0; \
+            } \
             s_ = sieve_[d_]; \
             mask_ = 1; \
           } \
         } while (s_ & mask_); \
-        p = d_*30 + imask30[mask_]; \
+        if (d_ > lastd_) break; \
+        p = base_ + d_*30 + imask30[mask_]; \
       } \
     } \
-    release_prime_cache(sieve_); \
+    END_EACH_PRIME_CLEANUP \
   }
 
 #endif
@@ -7,7 +7,8 @@ use Test::More  tests => 1;
 
 my @functions =  qw(
       prime_get_config prime_set_config
-      prime_precalc prime_memfree
+      prime_precalc prime_memfree prime_cache_save prime_cache_load
+      prime_count_table_save prime_count_table_load
       is_prime is_prob_prime is_provable_prime is_provable_prime_with_cert
       prime_certificate verify_prime
       is_pseudoprime is_strong_pseudoprime
@@ -25,13 +26,14 @@ my @functions =  qw(
       miller_rabin_random
       lucas_sequence lucasu lucasv
       primes twin_primes ramanujan_primes
-      forprimes forcomposites foroddcomposites fordivisors
+      primes_packed twin_primes_packed ramanujan_primes_packed
+      forprimes forprimes_block forcomposites foroddcomposites fordivisors
       forpart forcomb forperm
       prime_iterator prime_iterator_object
       next_prime  prev_prime
-      prime_count
+      prime_count prime_count_multi
       prime_count_lower prime_count_upper prime_count_approx
-      nth_prime nth_prime_lower nth_prime_upper nth_prime_approx
+      nth_prime nth_prime_multi nth_prime_lower nth_prime_upper nth_prime_approx
       twin_prime_count twin_prime_count_approx
       nth_twin_prime nth_twin_prime_approx
       nth_ramanujan_prime
@@ -44,6 +46,7 @@ my @functions =  qw(
       gcd lcm factor factor_exp divisors valuation invmod hammingweight
       vecsum vecmin vecmax vecprod vecreduce
       moebius mertens euler_phi jordan_totient exp_mangoldt liouville
+      moebius_packed euler_phi_packed
       partitions bernfrac bernreal harmfrac harmreal
       chebyshev_theta chebyshev_psi
       divisor_sum carmichael_lambda kronecker
@@ -1,9 +1,12 @@
 #!/usr/bin/env perl
 use strict;
 use warnings;
-use Math::Prime::Util qw/prime_precalc prime_memfree prime_get_config/;
+use Math::Prime::Util qw/prime_precalc prime_memfree prime_get_config
+                         prime_count primes prime_cache_save prime_cache_load
+                         prime_set_config/;
+use File::Temp qw/tempfile/;
 
-use Test::More  tests => 3 + 3 + 3 + 6;
+use Test::More  tests => 3 + 3 + 3 + 6 + 2 + 5 + 3 + 2 + 5;
 
 
 my $bigsize = 10_000_000;
@@ -67,3 +70,77 @@ prime_memfree;
 
 eval { my $mf = Math::Prime::Util::MemFree->new; prime_precalc($bigsize); cmp_ok( prime_get_config->{'precalc_to'}, '>', $init_size, "Internal space grew after large precalc" ); die; };
 is( prime_get_config->{'precalc_to'}, $init_size, "Memory is freed after eval die using object scoper");
+
+# Growing the cache in steps extends the existing sieve.
+{
+  prime_precalc(100_000);
+  prime_precalc(1_000_000);
+  prime_precalc(3_000_000);
+  is( prime_count(3_000_000), 216816, "prime_count correct after stepped precalc" );
+  my $sum = 0;  $sum += $_ for @{primes(2_000_000, 3_000_000)};
+  is( $sum, 169557243343, "sum of primes 2M to 3M correct after stepped precalc" );
+  prime_memfree;
+}
+
+# Save the cache to a sieve file and load it back.
+SKIP: {
+  skip "sieve files need XS", 5 unless prime_get_config->{xs};
+  my($fh, $file) = tempfile(UNLINK => 1);
+  close($fh);
+  prime_precalc(2_000_000);
+  my $saved_size = prime_get_config->{'precalc_to'};
+  ok( prime_cache_save($file), "prime_cache_save wrote sieve file" );
+  prime_memfree;
+  is( prime_cache_load($file), $saved_size, "prime_cache_load returns saved limit" );
+  is( prime_count(2_000_000), 148933, "prime_count correct using loaded sieve" );
+  prime_memfree;
+  is( prime_get_config->{'precalc_to'}, $init_size, "memfree after load goes back to initial size" );
+  # Flip a byte in the sieve and make sure it is rejected
+  open(my $rw, '+<', $file) or die "Can't open $file: $!";
+  binmode $rw;
+  seek($rw, 1000, 0);  print $rw "\x55";  close($rw);
+  is( prime_cache_load($file), 0, "corrupted sieve file is rejected" );
+}
+
+# Segment buffers are pooled and reused, and memfree releases the pool.
+SKIP: {
+  skip "segment pool needs XS", 3 unless prime_get_config->{xs};
+  primes(1_000_000_000, 1_000_100_000);
+  my($allocs, $reuses) = Math::Prime::Util::_get_prime_segment_stats();
+  primes(1_000_000_000, 1_000_100_000);
+  my($allocs2, $reuses2, $pooled) = Math::Prime::Util::_get_prime_segment_stats();
+  is( $allocs2, $allocs, "second segment sieve allocated no new buffer" );
+  cmp_ok( $reuses2, '>', $reuses, "second segment sieve reused a pooled buffer" );
+  prime_memfree;
+  is( (Math::Prime::Util::_get_prime_segment_stats())[2], 0, "memfree empties the segment pool" );
+}
+
+# Internal prime loops past the cache are segmented, not grown into the cache.
+SKIP: {
+  skip "internal prime loops need XS", 2 unless prime_get_config->{xs};
+  prime_memfree;
+  my $p = Math::Prime::Util::sieve_primes(30_000_000, 30_010_000);
+  is( scalar(@$p), 594, "cache prime walk past the cache finds all primes" );
+  is( prime_get_config->{'precalc_to'}, $init_size, "walking primes to 3e7 did not grow the cache" );
+}
+
+# Segment sizes come from the L2 size and can be overridden.
+SKIP: {
+  skip "segment sizing needs XS", 5 unless prime_get_config->{xs};
+  my($l1, $l2) = @{prime_get_config()}{qw/l1_cache l2_cache/};
+  my $want = $l2/2;
+  $want = $l1 if $want < $l1;
+  $want = 32*1024 if $want < 32*1024;
+  $want = 4*1024*1024 if $want > 4*1024*1024;
+  is( prime_get_config->{'segment_size'}, $want-16, "default segment size is half of L2" );
+  prime_set_config(l1_cache => 32*1024, l2_cache => 128*1024);
+  is( prime_get_config->{'segment_size'}, 64*1024-16, "a 128k L2 gives 64k segments" );
+  prime_set_config(l2_cache => 48*1024);
+  is( prime_get_config->{'segment_size'}, 32*1024-16, "segments are at least 32k" );
+  prime_set_config(l1_cache => $l1, l2_cache => $l2);
+  prime_set_config(segment_size => 65536);
+  is( prime_get_config->{'segment_size'}, 65536, "segment_size override is used" );
+  my $p = primes(1_000_000_000, 1_010_000_000);
+  prime_set_config(segment_size => 0);
+  is( scalar(@$p), 482449, "segment sieve with overridden segment size" );
+}
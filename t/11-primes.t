@@ -3,7 +3,7 @@ use strict;
 use warnings;
 
 use Test::More;
-use Math::Prime::Util qw/primes prime_count/;
+use Math::Prime::Util qw/primes primes_packed twin_primes_packed prime_count print_primes/;
 
 my $use64 = Math::Prime::Util::prime_get_config->{'maxbits'} > 32;
 $use64 = 0 if 18446744073709550592 == ~0;
@@ -15,11 +15,12 @@ my %primesubs = (
   segment => \&Math::Prime::Util::segment_primes,
   sieve   => \&Math::Prime::Util::sieve_primes,
   primes  => \&Math::Prime::Util::primes,
+  packed  => sub { [unpack "J*", primes_packed(@_)] },
 );
 # Don't test the private XS methods if we're not using XS.
 delete @primesubs{qw/trial erat segment sieve/} unless $usexs;
 
-plan tests => 12+3 + 12 + 1 + 19 + ($use64 ? 1 : 0) + 1 + 13*scalar(keys(%primesubs));
+plan tests => 12+3 + 12 + 1 + 20 + ($use64 ? 1 : 0) + 1 + 13*scalar(keys(%primesubs)) + 3 + 3;
 
 ok(!eval { primes(undef); },   "primes(undef)");
 ok(!eval { primes("a"); },     "primes(a)");
@@ -106,6 +107,7 @@ my %small_range = (
   "3088 to 3164" => [3089,3109,3119,3121,3137,3163],
   "3089 to 3163" => [3089,3109,3119,3121,3137,3163],
   "3090 to 3162" => [3109,3119,3121,3137],
+  "510480 to 510540" => [510481,510529],   # crosses 30*7*11*13*17
   "3842610773 to 3842611109" => [3842610773,3842611109],
   "3842610774 to 3842611108" => [],
 );
@@ -140,3 +142,31 @@ while (my($method, $sub) = each (%primesubs)) {
   is_deeply( $sub->(3089, 3163), [3089,3109,3119,3121,3137,3163], "$method(3089, 3163)" );
   is_deeply( $sub->(3090, 3162), [3109,3119,3121,3137], "$method(3090, 3162)" );
 }
+
+{
+  my $buf = "x" x 10;
+  my $n = primes_packed(2010733, 2010733+148, $buf);
+  is_deeply( [$n, unpack("J*", $buf)], [2, 2010733, 2010733+148], "primes_packed into a buffer" );
+  is_deeply( [unpack "J*", twin_primes_packed(1000, 1100)], [1019,1031,1049,1061,1091], "twin_primes_packed(1000,1100)" );
+  my $str = "head:" . ("x" x 8) . ":tail";
+  primes_packed(2010733, 2010733+148, substr($str, 5, 8));
+  ok( $str eq "head:" . pack("J*", 2010733, 2010733+148) . ":tail", "primes_packed into a substr lvalue" );
+}
+
+{
+  require File::Temp;
+  my $expect = primes(1000, 2_100_000);   # a few print segments
+  my %decode = (
+    text  => sub { [split /\n/, $_[0]] },
+    le64  => sub { [unpack "(Vx4)*", $_[0]] },    # values are under 2^32
+    delta => sub { my $p = 0; [map { $p += $_ } unpack "w*", $_[0]] },
+  );
+  for my $format (qw/text le64 delta/) {
+    my $fh = File::Temp->new;
+    binmode $fh;
+    print_primes(1000, 2_100_000, fileno($fh), $format);
+    seek($fh, 0, 0);
+    my $data = do { local $/; <$fh> };
+    is_deeply( $decode{$format}->($data), $expect, "print_primes 1000 .. 2.1M as $format" );
+  }
+}
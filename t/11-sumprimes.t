@@ -5,6 +5,10 @@ use warnings;
 use Test::More;
 use Math::Prime::Util qw/sum_primes vecsum primes/;
 
+my $use64 = Math::Prime::Util::prime_get_config->{'maxbits'} > 32;
+my $usexs = Math::Prime::Util::prime_get_config->{'xs'};
+my $extra = defined $ENV{EXTENDED_TESTING} && $ENV{EXTENDED_TESTING};
+
 my %sums = (
   "189695660 to 189695892" => 0,
   "0 to 300000" => 3709507114,
@@ -12,7 +16,20 @@ my %sums = (
   "10000000 to 10001000" => 610034659,
 );
 
-plan tests => 1 + scalar(keys %sums);
+# These use the sublinear method with XS.
+my %bigsums = (
+  "500000 to 30000000" => "26932891683771",
+  "0 to 1000000000" => "24739512092254535",
+  "0 to 29505444490" => "18446744057541225032",
+  "999999000000 to 1000000000000" => "36399981770340822",
+);
+# Sums past 2^64.
+my %hugesums = (
+  "0 to 29505444491" => "18446744087046669523",
+  "0 to 1000000000000" => "18435588552550705911377",
+);
+
+plan tests => 1 + scalar(keys %sums) + scalar(keys %bigsums) + scalar(keys %hugesums);
 
 {
   my @sum;
@@ -27,3 +44,18 @@ while (my($range, $expect) = each (%sums)) {
   my($low,$high) = $range =~ /(\d+) to (\d+)/;
   is( sum_primes($low,$high), $expect, "sum primes from $low to $high" );
 }
+
+SKIP: {
+  skip "large sums need 64-bit XS", scalar(keys %bigsums) unless $use64 && $usexs;
+  while (my($range, $expect) = each (%bigsums)) {
+    my($low,$high) = $range =~ /(\d+) to (\d+)/;
+    is( "".sum_primes($low,$high), $expect, "sum primes from $low to $high" );
+  }
+}
+SKIP: {
+  skip "sums past 2^64 need EXTENDED_TESTING and 64-bit XS", scalar(keys %hugesums) unless $use64 && $usexs && $extra;
+  while (my($range, $expect) = each (%hugesums)) {
+    my($low,$high) = $range =~ /(\d+) to (\d+)/;
+    is( "".sum_primes($low,$high), $expect, "sum primes from $low to $high" );
+  }
+}
@@ -3,11 +3,11 @@ use strict;
 use warnings;
 
 use Test::More;
-use Math::Prime::Util qw/next_prime prev_prime/;
+use Math::Prime::Util qw/next_prime prev_prime primes/;
 
 my $use64 = Math::Prime::Util::prime_get_config->{'maxbits'} > 32;
 
-plan tests => 2 + 3*2 + 6 + 2 + 148 + 148 + 1;
+plan tests => 2 + 3*2 + 6 + 2 + 148 + 148 + 1 + 2;
 
 my @small_primes = qw/
 2 3 5 7 11 13 17 19 23 29 31 37 41 43 47 53 59 61 67 71
@@ -94,3 +94,17 @@ foreach my $n (2010734 .. 2010881) {
 }
 # Similar test case to 2010870, where m=0 and next_prime is at m=1
 is(next_prime(1234567890), 1234567891, "next_prime(1234567890) == 1234567891)");
+
+# Walking consecutive primes past the cache uses a sieved window, which is
+# refilled several times here.  Compare with a segment sieve.
+{
+  my $start = $use64 ? 1000000000000 : 3000000000;
+  my @walk = ($start);
+  push @walk, next_prime($walk[-1]) for 1 .. 20000;
+  shift @walk;
+  is_deeply( \@walk, primes($start, $walk[-1]), "next_prime walk of 20000 primes from $start" );
+  my @back = ($walk[-1]+1);
+  push @back, prev_prime($back[-1]) for 1 .. 20000;
+  shift @back;
+  is_deeply( [reverse @back], \@walk, "prev_prime walk back over the same primes" );
+}
@@ -3,7 +3,7 @@ use strict;
 use warnings;
 
 use Test::More;
-use Math::Prime::Util qw/prime_count twin_prime_count
+use Math::Prime::Util qw/prime_count prime_count_multi twin_prime_count
                          prime_count_lower prime_count_upper
                          prime_count_approx twin_prime_count_approx/;
 
@@ -100,6 +100,12 @@ plan tests => 0 + 1
                 + scalar(keys %intervals)
                 + 1
                 + 5 + 2*$extra # prime count specific methods
+                + 4            # threaded segment sieve
+                + 1            # LMO easy leaf count
+                + 3            # threaded LMO
+                + 2            # kept LMO tables and counts
+                + 1            # bucket sieve
+                + 3            # prime_count_multi
                 + 3 + (($isxs && $use64) ? 1+2*scalar(keys %tpcs) : 0);# twin pc
 
 ok( eval { prime_count(13); 1; }, "prime_count in void context");
@@ -135,6 +141,17 @@ while (my($range, $expect) = each (%intervals)) {
 # Defect found in prime binary search
 is( prime_count(130066574), 7381740, "prime_count(130066574) = 7381740");
 
+{
+  my @n = reverse sort { $a <=> $b } keys %pivals_small;
+  push @n, $n[0], 0, 2;
+  is_deeply( [prime_count_multi(\@n)], [map { prime_count($_) } @n],
+             "prime_count_multi unsorted with duplicates" );
+  my @dense = map { 1_000_000 + 7919*$_ } reverse 0 .. 40;
+  is_deeply( [prime_count_multi(\@dense)], [map { prime_count($_) } @dense],
+             "prime_count_multi with close values" );
+  is_deeply( [prime_count_multi([])], [], "prime_count_multi of nothing" );
+}
+
 sub parse_range {
   my($range) = @_;
   my($low,$high);
@@ -169,16 +186,57 @@ sub parse_range {
 
 # Make sure each specific algorithm isn't broken.
 SKIP: {
-  skip "Not XS -- skipping direct primecount tests", 2 unless $isxs;
+  skip "Not XS -- skipping direct primecount tests", 3 unless $isxs;
   # This has to be above SIEVE_LIMIT in lehmer.c and lmo.c or nothing happens.
   #is(Math::Prime::Util::_XS_lehmer_pi  (66123456),3903023,"XS Lehmer count");
   #is(Math::Prime::Util::_XS_meissel_pi (66123456),3903023,"XS Meissel count");
   #is(Math::Prime::Util::_XS_legendre_pi(66123456),3903023,"XS Legendre count");
   #is(Math::Prime::Util::_XS_LMOS_pi    (66123456),3903023,"XS LMOS count");
   is(Math::Prime::Util::_XS_LMO_pi     (66123456), 3903023,"XS LMO count");
+  is(Math::Prime::Util::_XS_LMO_easy_pi(66123456), 3903023,"XS LMO easy leaf count");
   is(Math::Prime::Util::_XS_segment_pi (66123456), 3903023,"XS segment count");
 }
 
+# Segments sieved by worker threads must be handed back in order.
+{
+  Math::Prime::Util::prime_set_config(threads => 3);
+  is(prime_count(1000000000,1030000000), 1446784, "threaded prime_count 10^9 to +3e7");
+  is(twin_prime_count(1000000000,1030000000), 91942, "threaded twin_prime_count 10^9 to +3e7");
+  is(prime_count(1000000000000,1000050000000), 1808833, "threaded prime_count 10^12 to +5e7");
+  # Pairs split across small segments are joined from the segment edges.
+  Math::Prime::Util::prime_set_config(segment_size => 1024);
+  is(twin_prime_count(1000000000,1030000000), 91942, "threaded twin_prime_count with small segments");
+  Math::Prime::Util::prime_set_config(threads => 1, segment_size => 0);
+}
+
+# LMO splits its phi sieve into chunks and k slices for the threads.
+SKIP: {
+  skip "threaded LMO needs 64-bit XS", 3 unless $isxs && $use64;
+  Math::Prime::Util::prime_set_config(threads => 4);
+  is(Math::Prime::Util::_XS_LMO_pi(66123456), 3903023, "threaded XS LMO count");
+  is(Math::Prime::Util::_XS_LMO_pi(123456789012), 5040193425, "threaded XS LMO count 123456789012");
+  is(Math::Prime::Util::_XS_LMO_easy_pi(123456789012), 5040193425, "threaded XS LMO easy leaf count 123456789012");
+  Math::Prime::Util::prime_set_config(threads => 1);
+}
+
+# LMO keeps the tables from one count for the next, and recent results.
+SKIP: {
+  skip "kept LMO tables need XS", 2 unless $isxs;
+  is_deeply( [Math::Prime::Util::_XS_LMO_easy_pi(1000000000),
+              Math::Prime::Util::_XS_LMO_easy_pi(66123456),
+              prime_count(1000000000), prime_count(1000000000)],
+             [50847534, 3903023, 50847534, 50847534],
+             "smaller and repeated counts with kept LMO tables" );
+  Math::Prime::Util::prime_memfree();
+  is(Math::Prime::Util::_XS_LMO_easy_pi(66123456), 3903023, "XS LMO easy leaf count after prime_memfree");
+}
+
+# Large ranges high up put the biggest sieving primes in buckets.
+SKIP: {
+  skip "bucket sieve test needs 64-bit XS", 1 unless $isxs && $use64;
+  is(prime_count("1000000000000000","1000000200000000"), 5788545, "prime_count 10^15 to +2e8");
+}
+
 require_ok 'Math::Prime::Util::PP';
 is(Math::Prime::Util::PP::_lehmer_pi   (1456789), 111119, "PP Lehmer count");
 is(Math::Prime::Util::PP::_sieve_prime_count(145678), 13478, "PP sieve count");
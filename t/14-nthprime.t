@@ -3,7 +3,7 @@ use strict;
 use warnings;
 
 use Test::More;
-use Math::Prime::Util qw/primes nth_prime nth_twin_prime
+use Math::Prime::Util qw/primes nth_prime nth_prime_multi nth_twin_prime
                          nth_prime_lower nth_prime_upper
                          nth_prime_approx nth_twin_prime_approx/;
 
@@ -82,8 +82,10 @@ plan tests => 0 + 2*scalar(keys %pivals32)
                 + scalar(keys %nthprimes_small)
                 + $use64 * 3 * scalar(keys %nthprimes64)
                 + 3   # nth_prime_lower with max index
-                + 3   # nth_twin_prime
+                + 4   # nth_twin_prime
                 + scalar(keys %ntpcs)   # nth_twin_prime_approx
+                + 2   # nth_prime sieving backwards
+                + 2   # nth_prime_multi
                 + (($extra && $use64 && $usexs) ? 1 : 0);
 
 
@@ -135,11 +137,40 @@ if ($extra && $use64 && $usexs) {
   is( nth_prime(21234567890), 551990503367, "nth_prime(21234567890)" );
 }
 
+# The estimate for these is high, so nth_prime sieves back to them.  Small
+# segments make the walk cross segments.
+SKIP: {
+  skip "backwards nth_prime needs XS", 2 unless $usexs;
+  my %back = (125121115 => 2579608531, 125731504 => 2592832111,
+              125654909 => 2591174939, 126190428 => 2602783699);
+  my @n = sort { $a <=> $b } keys %back;
+  Math::Prime::Util::prime_set_config(segment_size => 1024);
+  is_deeply( [map { nth_prime($_) } @n], [@back{@n}], "nth_prime sieving backwards" );
+  Math::Prime::Util::prime_set_config(threads => 3);
+  is_deeply( [map { nth_prime($_) } @n], [@back{@n}], "nth_prime sieving backwards with threads" );
+  Math::Prime::Util::prime_set_config(threads => 1, segment_size => 0);
+}
+
+{
+  my @n = reverse sort { $a <=> $b } keys %nthprimes_small;
+  push @n, $n[0], 0;
+  is_deeply( [nth_prime_multi(\@n)], [map { nth_prime($_) } @n],
+             "nth_prime_multi unsorted with duplicates" );
+  my @dense = map { 200_000 + 1009*$_ } reverse 0 .. 40;
+  is_deeply( [nth_prime_multi(\@dense)], [map { nth_prime($_) } @dense],
+             "nth_prime_multi with close indices" );
+}
+
 ####################################3
 
 is( nth_twin_prime(0), 0, "nth_twin_prime(0) = 0" );
 is( nth_twin_prime(17), 239, "239 = 17th twin prime" );
 is( nth_twin_prime(1234), 101207, "101207 = 1234'th twin prime" );
+{
+  Math::Prime::Util::prime_set_config(threads => 3, segment_size => 1024);
+  is( nth_twin_prime(2000000), 548782061, "nth_twin_prime with threads and small segments" );
+  Math::Prime::Util::prime_set_config(threads => 1, segment_size => 0);
+}
 
 while (my($n, $nthtpc) = each (%ntpcs)) {
   my $approx = nth_twin_prime_approx($n);
@@ -9,6 +9,7 @@ use Math::Prime::Util
       znprimroot znlog kronecker legendre_phi gcd lcm is_power valuation
       invmod vecsum vecprod binomial gcdext chinese vecmin vecmax factorial
       hammingweight vecreduce vecextract sqrtint
+      moebius_packed euler_phi_packed
      /;
 
 my $extra = defined $ENV{EXTENDED_TESTING} && $ENV{EXTENDED_TESTING};
@@ -577,9 +578,11 @@ if ($use64) {
 
 plan tests => 0 + 1
                 + 1 # Small Moebius
+                + 2 # Packed Moebius
                 + 3*scalar(keys %mertens)
                 + 1*scalar(keys %big_mertens)
                 + 2 # Small Phi
+                + 3 # Packed Phi
                 + 9 + scalar(keys %totients)
                 + 1 # Small Carmichael Lambda
                 + scalar(@kroneckers)
@@ -618,6 +621,12 @@ ok(!eval { moebius(0); }, "moebius(0)");
 {
   my @moebius = map { moebius($_) } (1 .. scalar @moeb_vals);
   is_deeply( \@moebius, \@moeb_vals, "moebius 1 .. " . scalar @moeb_vals );
+  is_deeply( [unpack("c*", moebius_packed(1, scalar @moeb_vals))], \@moeb_vals,
+             "moebius_packed 1 .. " . scalar @moeb_vals );
+  my $buf = "x" x 10000;
+  my $n = moebius_packed(1000, 1999, $buf);
+  is_deeply( [$n, unpack("c*", $buf)], [1000, moebius(1000, 1999)],
+             "moebius_packed into a buffer" );
 }
 
 while (my($n, $mertens) = each (%mertens)) {
@@ -642,6 +651,13 @@ while (my($n, $mertens) = each (%big_mertens)) {
 {
   my @phi = euler_phi(0, $#A000010);
   is_deeply( \@phi, \@A000010, "euler_phi with range: 0, $#A000010" );
+  is_deeply( [unpack("J*", euler_phi_packed(0, $#A000010))], \@A000010,
+             "euler_phi_packed 0, $#A000010" );
+  my $buf;
+  my $n = euler_phi_packed(1513, 3000, $buf);
+  is_deeply( [$n, unpack("J*", $buf)], [1488, euler_phi(1513, 3000)],
+             "euler_phi_packed into a buffer" );
+  is( euler_phi_packed(5, 4), "", "euler_phi_packed with end < start" );
 }
 {
   my $s = 0;
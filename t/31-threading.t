@@ -17,7 +17,7 @@ BEGIN {
 
 # Math::Pari + threads = crossing the streams.  Instant segfault.
 use Math::BigInt lib=>"Calc";
-use Test::More 'tests' => 10;
+use Test::More 'tests' => 11;
 use Math::Prime::Util ":all";
 
 my $extra = defined $ENV{EXTENDED_TESTING} && $ENV{EXTENDED_TESTING};
@@ -74,6 +74,10 @@ SKIP: {
     $numthreads, "sum prime_count with overlapping memfree calls");
 }
 
+thread_test(
+  sub { my $sum = 0;  for (@randn) { prime_precalc(30*$_); $sum += is_prime($_) + next_prime(20*$_); } return $sum;},
+  $numthreads, "is_prime and next_prime while others grow the cache");
+
 thread_test(
   sub { my $sum = 0; for my $d (@randn) { for my $f (factor($d)) { $sum += $f; } } return $sum; },
   $numthreads, "factor");
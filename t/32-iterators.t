@@ -4,7 +4,8 @@ use warnings;
 
 use Test::More;
 use Math::Prime::Util qw/primes prev_prime next_prime
-                         forprimes forcomposites fordivisors
+                         forprimes forprimes_block primes_packed
+                         forcomposites fordivisors
                          prime_iterator prime_iterator_object/;
 use Math::BigInt try => "GMP,Pari";
 use Math::BigFloat;
@@ -14,6 +15,7 @@ my $broken64 = (18446744073709550592 == ~0);
 
 plan tests => 8        # forprimes errors
             + 12 + 7   # forprimes simple
+            + 4        # forprimes_block
             + 3        # forcomposites simple
             + 2        # fordivisors simple
             + 3        # iterator errors
@@ -24,6 +26,8 @@ plan tests => 8        # forprimes errors
             + 3        # oo iterator errors
             + 7        # oo iterator simple
             + 25       # oo iterator methods
+            + 2        # oo iterator batches
+            + 1        # oo iterator state copy
             + 0;
 
 ok(!eval { forprimes { 1 } undef; },   "forprimes undef");
@@ -71,6 +75,23 @@ ok(!eval { forprimes { 1 } 5.6; },   "forprimes abc");
 { my @t; forprimes { push @t, $_ } 3842610774,3842611326;
   is_deeply( [@t], [3842611109,3842611139,3842611163,3842611181,3842611211,3842611229,3842611249,3842611259,3842611261,3842611291,3842611301], "forprimes 3842610774,3842611326" );
 }
+{ my @t; forprimes_block { push @t, [@_, unpack("J*",$_)] } 20;
+  is_deeply( [@t], [[2,20,2,3,5,7,11,13,17,19]], "forprimes_block 20" );
+}
+{ my @t; forprimes_block { push @t, [@_, unpack("J*",$_)] } 31398, 31468;
+  is_deeply( [@t], [[31398,31468]], "forprimes_block 31398,31468 (empty region)" );
+}
+{ my @t; forprimes_block { push @t, unpack("J*",$_) } 3842610774,3842611326;
+  is_deeply( [@t], [3842611109,3842611139,3842611163,3842611181,3842611211,3842611229,3842611249,3842611259,3842611261,3842611291,3842611301], "forprimes_block 3842610774,3842611326" );
+}
+{ # Cover a few sieve segments
+  my $segsize = Math::Prime::Util::prime_get_config->{'segment_size'};
+  my $end = defined $segsize ? 75*$segsize : 2_500_000;
+  my($str, $next, $ok) = ("", 3, 1);
+  forprimes_block { $ok = 0 if $_[0] != $next;  $next = $_[1]+1;  $str .= $_; } 3, $end;
+  ok( $ok && $next == $end+1 && $str eq primes_packed(3, $end),
+      "forprimes_block segments cover 3 .. $end in order" );
+}
 { my @t; forcomposites { push @t, $_ } 2147483647,2147483659;
   is_deeply( [@t], [qw/2147483648 2147483649 2147483650 2147483651 2147483652 2147483653 2147483654 2147483655 2147483656 2147483657 2147483658/], "forcomposites 2147483647,2147483659" );
 }
@@ -245,3 +266,23 @@ ok(!eval { prime_iterator_object(4.5); }, "iterator 4.5");
   ok( ($est > ($act-500)) && ($est < ($act+500)),
       "iterator object value_to_i_estimage is in range");
 }
+
+# Long walks cross several sieved batches of primes.
+{
+  my $it = prime_iterator_object(999_000_000);
+  my @fwd = map { $it->iterate() } 1..30000;
+  is_deeply( \@fwd, primes(999_000_000, $fwd[-1]), "iterator object 30000 primes from 999000000" );
+  $it->prev;  # iterate left us one past the end
+  my @back = map { my $v = $it->value; $it->prev; $v } 1..30000;
+  is_deeply( [reverse @back], \@fwd, "iterator object prev over the same primes" );
+}
+
+# Stepping changes the object's scalar, but not a copy of it.
+{
+  my $it = prime_iterator_object(1000);
+  $it->next;
+  my $copy = $$it;
+  my $saved = unpack("H*", $copy);
+  $it->next for 1..3;
+  ok( unpack("H*", $copy) eq $saved, "iterator object steps leave a copy of its state alone" );
+}
@@ -4,6 +4,7 @@ use warnings;
 
 use Test::More;
 use Math::Prime::Util::PrimeArray;
+use Math::Prime::Util qw/nth_prime/;
 
 # From List::Util
 sub shuffle (@) {
@@ -60,7 +61,7 @@ my %test_indices = (
 );
 
 
-plan tests => 3 + 2 + scalar(keys %test_indices) + 8;
+plan tests => 3 + 2 + scalar(keys %test_indices) + 8 + 3 + 2;
 
 {
   my @primes;  tie @primes, 'Math::Prime::Util::PrimeArray';
@@ -112,3 +113,27 @@ plan tests => 3 + 2 + scalar(keys %test_indices) + 8;
   unshift @primes, 3;
   is( $primes[0], 3, "3 after unshift 3");
 }
+
+# A small memory forces blocks out and checkpoints to be walked
+{
+  my @primes;  tie @primes, 'Math::Prime::Util::PrimeArray', memory => 40_000;
+  my @idx = (150_000, 3_000, 90_000, 150_001, 2_999, 60_000, 149_999, 1_000_000);
+  is_deeply( [map { $primes[$_] } @idx], [map { nth_prime($_+1) } @idx],
+             "scattered indices with small memory" );
+  my @got = map { $primes[$_] } reverse 200_000 .. 203_000;
+  is_deeply( \@got, [map { nth_prime($_+1) } reverse 200_000 .. 203_000],
+             "walk backward across blocks with small memory" );
+}
+ok( !eval { my @p; tie @p, 'Math::Prime::Util::PrimeArray', memory => 'lots'; 1 },
+    "invalid memory option croaks" );
+
+# The state string is changed by fetches, which must not reach a copy of it.
+SKIP: {
+  skip "prime array state needs XS", 2 unless Math::Prime::Util::prime_get_config->{'xs'};
+  my $pa = tie my @primes, 'Math::Prime::Util::PrimeArray', memory => 40_000;
+  my $p = $primes[150_000];
+  my $copy = $pa->{PA};
+  my $saved = unpack("H*", $copy);
+  is( $primes[3_000], nth_prime(3_001), "fetch after copying the state" );
+  ok( unpack("H*", $copy) eq $saved, "copy of the state is unchanged" );
+}
@@ -0,0 +1,112 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+
+use Test::More;
+use File::Temp;
+use Math::Prime::Util::PrimeGapFile;
+use Math::Prime::Util qw/primes primes_packed prime_count nth_prime/;
+
+my $use64 = eval { my $q = pack("Q", 1); 1 };
+my $usexs = Math::Prime::Util::prime_get_config->{'xs'};
+
+plan tests => 10 + 2 + 1;
+
+my $dir = File::Temp::tempdir(CLEANUP => 1);
+my $PGF = 'Math::Prime::Util::PrimeGapFile';
+
+{
+  my $file = "$dir/small.gaps";
+  my $n = $PGF->write($file, 0, 100, interval => 7);
+  my $pf = $PGF->new($file);
+  my @got;
+  while (defined(my $p = $pf->iterate)) { push @got, $p; }
+  is_deeply( [$n, $pf->count, $pf->first_index, \@got],
+             [25, 25, 1, primes(100)],
+             "write and iterate primes to 100 with interval 7" );
+}
+
+{
+  my $file = "$dir/mid.gaps";
+  my($lo, $hi) = (1_000_000, 3_000_000);
+  $PGF->write($file, $lo, $hi, interval => 1000);
+  my $pf = $PGF->new($file);
+  is_deeply( [$pf->low, $pf->high, $pf->count, $pf->first_index, $pf->interval],
+             [$lo, $hi, prime_count($lo,$hi), prime_count($lo-1)+1, 1000],
+             "header of 1M .. 3M file" );
+  my $s = $pf->next_packed(5000) . $pf->next_packed;
+  ok( $s eq primes_packed($lo, $hi), "next_packed returns the primes from 1M to 3M" );
+  is( length($pf->next_packed), 0, "next_packed returns empty string at end" );
+
+  my @idx = (0, 999, 1000, 1001, 12345, 67000, $pf->count-1, 5);
+  my $list = primes($lo, $hi);
+  is_deeply( [map { scalar $pf->prime_at($_) } @idx, $pf->count],
+             [(map { $list->[$_] } @idx), undef],
+             "prime_at random positions" );
+  my $i = $pf->first_index + 54321;
+  $pf->seek_to_i($i);
+  is_deeply( [$pf->ith($i), $pf->tell_i, $pf->iterate, $pf->tell],
+             [nth_prime($i), $i, nth_prime($i), 54322],
+             "ith, seek_to_i, and tell_i use prime indices" );
+
+  # The body after the header is the half-gaps as BER integers.
+  open(my $fh, '<:raw', $file) or die;
+  read($fh, my $buf, 64 + 20);
+  my @half = unpack("w*", substr($buf, 64));
+  is_deeply( [@half[0..9]],
+             [map { ($list->[$_+1] - $list->[$_]) / 2 } 0..9],
+             "gaps are stored halved as BER integers" );
+}
+
+{
+  my $file = "$dir/empty.gaps";
+  my $n = $PGF->write($file, 24, 28, index => 0);
+  my $pf = $PGF->new($file);
+  is_deeply( [$n, $pf->count, $pf->first_index, scalar $pf->iterate, scalar $pf->prime_at(0)],
+             [0, 0, 0, undef, undef],
+             "empty range" );
+}
+
+{
+  my $file = "$dir/bad.gaps";
+  open(my $fh, '>:raw', $file) or die;
+  print $fh "not a prime gap file\n" x 10;
+  close($fh);
+  eval { $PGF->new($file); };
+  like( $@, qr/not a prime gap file/, "new croaks on a file of another type" );
+  eval { $PGF->write($file, 1, 100, interval => 0); };
+  like( $@, qr/interval must be/, "write croaks on a bad interval" );
+}
+
+# Decoding a block changes the state string, but not a copy of it.
+SKIP: {
+  skip "prime gap file state needs XS", 1 unless $usexs;
+  my $file = "$dir/copy.gaps";
+  $PGF->write($file, 1_000_000, 1_100_000, interval => 100);
+  my $pf = $PGF->new($file);
+  my $p = $pf->prime_at(10);
+  my $copy = $pf->{state};
+  my $saved = unpack("H*", $copy);
+  $p = $pf->prime_at(5000);
+  ok( unpack("H*", $copy) eq $saved, "copy of the state is unchanged" );
+}
+
+SKIP: {
+  skip "Perl and XS files need XS and 64-bit Perl", 2 unless $usexs && $use64;
+  my($lo, $hi) = (2_000_000, 2_300_000);
+  my $xsfile = "$dir/xs.gaps";
+  my $ppfile = "$dir/pp.gaps";
+  $PGF->write($xsfile, $lo, $hi, interval => 333);
+  my($pfxs, $pfpp);
+  {
+    no warnings 'redefine';
+    local *Math::Prime::Util::PrimeGapFile::_xs = sub { 0 };
+    $PGF->write($ppfile, $lo, $hi, interval => 333);
+    $pfpp = $PGF->new($xsfile);
+  }
+  ok( -s $xsfile == -s $ppfile && $PGF->new($ppfile)->next_packed eq primes_packed($lo,$hi),
+      "file written in Perl reads back with XS" );
+  is_deeply( [map { $pfpp->prime_at($_) } 0, 332, 333, 10000, $pfpp->count-1],
+             [map { $_->[0], $_->[332], $_->[333], $_->[10000], $_->[-1] } primes($lo,$hi)],
+             "file written with XS reads back in Perl" );
+}
@@ -0,0 +1,78 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+
+use Test::More;
+use File::Temp;
+use Math::Prime::Util qw/prime_count_table_save prime_count_table_load
+                         prime_count nth_prime/;
+
+my $usexs = Math::Prime::Util::prime_get_config->{'xs'};
+my $extra = 0+(defined $ENV{EXTENDED_TESTING} && $ENV{EXTENDED_TESTING});
+
+plan skip_all => "prime count tables need XS" unless $usexs;
+plan tests => 8 + 1;
+
+my $dir = File::Temp::tempdir(CLEANUP => 1);
+my($lo, $hi, $iv) = (3_000_000, 30_000_000, 30_000);
+
+# Reference values, found before any table is loaded.
+my @n = (3_030_001, 4_567_890, 12_345_678, 29_999_999, 30_000_000, 29_975_000);
+my @pc = map { prime_count($_) } @n;
+my @k = (216_817, 500_000, 1_000_000, 1_857_000);
+my @nth = map { nth_prime($_) } @k;
+my @range = (prime_count(5_000_000, 25_000_000), prime_count(12_000_000, 12_500_000));
+
+my $file = "$dir/pc.table";
+ok( prime_count_table_save($file, $lo, $hi, $iv), "save table from 3M to 30M" );
+is( prime_count_table_load($file), $hi, "load returns the last checkpoint" );
+is_deeply( [map { prime_count($_) } @n], \@pc, "prime_count with a table" );
+is_deeply( [map { nth_prime($_) } @k], \@nth, "nth_prime with a table" );
+is_deeply( [prime_count(5_000_000, 25_000_000), prime_count(12_000_000, 12_500_000)],
+           \@range, "ranged prime_count with a table" );
+
+{
+  # Change one varint in the body, and the load has to fail.
+  open(my $fh, '<:raw', $file) or die;
+  local $/;
+  my $buf = <$fh>;
+  close($fh);
+  substr($buf, 100, 1) = chr(ord(substr($buf, 100, 1)) ^ 0x02);
+  my $badfile = "$dir/bad.table";
+  open($fh, '>:raw', $badfile) or die;
+  print $fh $buf;
+  close($fh);
+  is( prime_count_table_load($badfile), 0, "damaged table is rejected" );
+}
+
+SKIP: {
+  skip "editing a table needs 64-bit Perl", 1 unless eval { pack("Q", 1); 1 };
+  # Add one to every absolute count, so the table agrees with itself but
+  # is wrong.  The counts checked on loading have to catch it.
+  open(my $fh, '<:raw', $file) or die;
+  local $/;
+  my $buf = <$fh>;
+  close($fh);
+  my($ncheck, $last_pi, $index_offset) = unpack("Q3", substr($buf, 32, 24));
+  substr($buf, 40, 8) = pack("Q", $last_pi + 1);
+  for (my $off = $index_offset; $off < length($buf); $off += 24) {
+    substr($buf, $off, 8) = pack("Q", unpack("Q", substr($buf, $off, 8)) + 1);
+  }
+  my $badfile = "$dir/off.table";
+  open($fh, '>:raw', $badfile) or die;
+  print $fh $buf;
+  close($fh);
+  is( prime_count_table_load($badfile), 0, "table with wrong but consistent counts is rejected" );
+}
+
+# Build a larger table and run the verification script on it.
+SKIP: {
+  skip "building and checking a 3e9 table needs EXTENDED_TESTING", 1 unless $extra;
+  my $script = "xt/pctable.pl";
+  skip "no $script", 1 unless -e $script;
+  my $out = `"$^X" -Mblib $script "$dir/big.table" 0 3000000000 3000000 10 2>&1`;
+  is( $?, 0, "xt/pctable.pl builds and checks a table to 3e9" ) or diag $out;
+}
+
+eval { prime_count_table_save("$dir/x.table", 0, 1000, 100); };
+like( $@, qr/interval must be/, "save croaks on an interval not a multiple of 30" );
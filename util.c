@@ -86,10 +86,12 @@
 #define FUNC_prev_prime_in_sieve 1
 #define FUNC_is_prime_in_sieve 1
 #include "util.h"
+#include "prime_sums.h"
 #include "sieve.h"
 #include "primality.h"
 #include "cache.h"
 #include "lmo.h"
+#include "pctable.h"
 #include "factor.h"
 #include "mulmod.h"
 #include "constants.h"
@@ -101,6 +103,90 @@ int _XS_get_verbose(void) { return _verbose; }
 static int _call_gmp = 0;
 void _XS_set_callgmp(int v) { _call_gmp = v; }
 int  _XS_get_callgmp(void) { return _call_gmp; }
+static int _threads = 1;
+void _XS_set_threads(int n) { _threads = (n < 1) ? 1 : n; }
+int  _XS_get_threads(void) { return _threads; }
+
+/* Data cache sizes in bytes for levels 1-3, found once at load time and
+ * used to size sieve segments.  The defaults are used when we can't tell.
+ * A nonzero segment size overrides the one derived from them. */
+static UV _cache_sizes[4] = {0, 32*1024, 256*1024, 0};
+static UV _segment_size = 0;
+
+#if defined(__linux__)
+static UV _sysfs_cache_size(int level) {
+  char path[80], buf[32];
+  UV size = 0;
+  int idx;
+  for (idx = 0; idx < 8 && size == 0; idx++) {
+    FILE* f;
+    int lvl = 0;
+    sprintf(path, "/sys/devices/system/cpu/cpu0/cache/index%d/level", idx);
+    if ((f = fopen(path, "r")) == 0) break;
+    if (fscanf(f, "%d", &lvl) != 1) lvl = 0;
+    fclose(f);
+    if (lvl != level) continue;
+    sprintf(path, "/sys/devices/system/cpu/cpu0/cache/index%d/type", idx);
+    if ((f = fopen(path, "r")) == 0) continue;
+    if (fgets(buf, sizeof(buf), f) == 0 || buf[0] == 'I') buf[0] = '\0';
+    fclose(f);
+    if (buf[0] == '\0') continue;          /* Skip instruction caches */
+    sprintf(path, "/sys/devices/system/cpu/cpu0/cache/index%d/size", idx);
+    if ((f = fopen(path, "r")) == 0) continue;
+    if (fgets(buf, sizeof(buf), f) != 0) {
+      char* end;
+      size = strtoul(buf, &end, 10);
+      if (*end == 'K') size *= 1024;
+      if (*end == 'M') size *= 1024*1024;
+    }
+    fclose(f);
+  }
+  return size;
+}
+#endif
+
+void _XS_detect_cache_sizes(void) {
+  int level;
+  for (level = 1; level <= 3; level++) {
+    long size = 0;
+#if defined(_SC_LEVEL1_DCACHE_SIZE) && defined(_SC_LEVEL2_CACHE_SIZE) && defined(_SC_LEVEL3_CACHE_SIZE)
+    size = sysconf( (level == 1) ? _SC_LEVEL1_DCACHE_SIZE :
+                    (level == 2) ? _SC_LEVEL2_CACHE_SIZE : _SC_LEVEL3_CACHE_SIZE );
+#endif
+#if defined(__linux__)
+    if (size <= 0)  size = _sysfs_cache_size(level);
+#endif
+    if (size > 0)  _cache_sizes[level] = size;
+  }
+}
+UV   _XS_get_cache_size(int level) {
+  return (level >= 1 && level <= 3) ? _cache_sizes[level] : 0;
+}
+void _XS_set_cache_size(int level, UV size) {
+  if (level >= 1 && level <= 3)  _cache_sizes[level] = size;
+}
+void _XS_set_segment_size(UV size) { _segment_size = size; }
+
+/* Bytes in a standard sieve segment: half of L2 less a little for malloc,
+ * leaving the other half for the sieving primes.  Measured on a 2MB L2, the
+ * whole cache was a little slower.  Never smaller than L1 or 32k. */
+UV _XS_get_segment_size(void) {
+  UV size = _segment_size;
+  if (size == 0) {
+    size = _cache_sizes[2] / 2;
+    if (size < _cache_sizes[1])  size = _cache_sizes[1];
+    if (size < 32*1024)          size = 32*1024;
+    if (size > 4*1024*1024)      size = 4*1024*1024;
+    size -= 16;
+  }
+  return size;
+}
+
+/* How many times bigger than 256k our segments are, 1 to 16. */
+UV _XS_get_l2_scale(void) {
+  UV scale = (_XS_get_segment_size() + 16) / (256*1024);
+  return (scale < 1) ? 1 : (scale > 16) ? 16 : scale;
+}
 
 /* GCC 3.4 - 4.1 has broken 64-bit popcount.
  * GCC 4.2+ can generate awful code when it doesn't have asm (GCC bug 36041).
@@ -142,6 +228,188 @@ static const unsigned char byte_zeros[256] =
    6,5,5,4,5,4,4,3,5,4,4,3,4,3,3,2,5,4,4,3,4,3,3,2,4,3,3,2,3,2,2,1,
    6,5,5,4,5,4,4,3,5,4,4,3,4,3,3,2,5,4,4,3,4,3,3,2,4,3,3,2,3,2,2,1,
    5,4,4,3,4,3,3,2,4,3,3,2,3,2,2,1,4,3,3,2,3,2,2,1,3,2,2,1,2,1,1,0};
+/* Counting the set bits in whole words is the inner loop of prime counting,
+ * so on x86-64 we pick the widest kernel the CPU supports at run time.
+ * These need GCC 4.9+ (target attributes), and 8+ for AVX-512 VPOPCNTDQ,
+ * which GCC 7 can compile but __builtin_cpu_supports can't detect.
+ * Everything else uses the portable popcnt above. */
+#if BITS_PER_WORD == 64 && defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+ #define POPCNT_DISPATCH 1
+ #include <immintrin.h>
+ #if __GNUC__ >= 8
+  #define POPCNT_AVX512 1
+ #endif
+#endif
+
+static UV _popcount_words(const UV* w, UV nwords) {
+  UV ones = 0;
+  while (nwords--)
+    ones += popcnt(*w++);
+  return ones;
+}
+
+#ifdef POPCNT_DISPATCH
+__attribute__((target("popcnt")))
+static UV _popcount_words_popcnt(const UV* w, UV nwords) {
+  UV ones = 0;
+  while (nwords--)
+    ones += __builtin_popcountll(*w++);
+  return ones;
+}
+
+/* Nibble lookup with byte shuffles (Mula), summed with SAD every 31 rounds
+ * so the byte counters can't overflow. */
+__attribute__((target("avx2,popcnt")))
+static UV _popcount_words_avx2(const UV* w, UV nwords) {
+  const __m256i lookup = _mm256_setr_epi8(0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4,
+                                          0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4);
+  const __m256i lomask = _mm256_set1_epi8(0x0f);
+  __m256i acc = _mm256_setzero_si256();
+  UV i = 0, ones;
+  while (i+4 <= nwords) {
+    __m256i bytes = _mm256_setzero_si256();
+    UV rounds = (nwords-i)/4;
+    if (rounds > 31) rounds = 31;
+    for ( ; rounds > 0; rounds--, i += 4) {
+      __m256i v  = _mm256_loadu_si256((const __m256i*)(w+i));
+      __m256i lo = _mm256_and_si256(v, lomask);
+      __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), lomask);
+      bytes = _mm256_add_epi8(bytes, _mm256_shuffle_epi8(lookup, lo));
+      bytes = _mm256_add_epi8(bytes, _mm256_shuffle_epi8(lookup, hi));
+    }
+    acc = _mm256_add_epi64(acc, _mm256_sad_epu8(bytes, _mm256_setzero_si256()));
+  }
+  ones = _mm256_extract_epi64(acc, 0) + _mm256_extract_epi64(acc, 1)
+       + _mm256_extract_epi64(acc, 2) + _mm256_extract_epi64(acc, 3);
+  for ( ; i < nwords; i++)
+    ones += __builtin_popcountll(w[i]);
+  return ones;
+}
+
+#ifdef POPCNT_AVX512
+__attribute__((target("avx512f,avx512vpopcntdq,popcnt")))
+static UV _popcount_words_avx512(const UV* w, UV nwords) {
+  __m512i acc = _mm512_setzero_si512();
+  UV i, ones;
+  for (i = 0; i+8 <= nwords; i += 8)
+    acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(_mm512_loadu_si512((const void*)(w+i))));
+  ones = _mm512_reduce_add_epi64(acc);
+  for ( ; i < nwords; i++)
+    ones += __builtin_popcountll(w[i]);
+  return ones;
+}
+#endif
+#endif
+
+/* Twin prime pairs in a sieve: the lower members 11, 17, and 29 are bits 2,
+ * 4, and 7 of a byte, and each one's partner is the next bit up.  For 29
+ * that is bit 0 of the following byte, which is bit 7 of the next byte's
+ * value shifted up 7.  So with the byte after each also loaded, a pair
+ * starts wherever this is set (primes are zero bits):
+ *
+ *   ~(b | ((b >> 1) & 0x14) | ((next << 7) & 0x80)) & 0x94
+ *
+ * The shifts stay inside each byte, so the same thing works on a word of
+ * bytes and its copy one byte on, with no carries between words.  That
+ * needs byte 0 in the low bits, so the word kernels are little-endian. */
+#define TWIN_PAIRS(b, next, m14, m80, m94) \
+  (~((b) | (((b) >> 1) & (m14)) | (((next) << 7) & (m80))) & (m94))
+#define TWIN_BYTE_PAIRS(b, next)  \
+  (TWIN_PAIRS((unsigned int)(b), (unsigned int)(next), 0x14U, 0x80U, 0x94U))
+
+#if BITS_PER_WORD == 64 && ( (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) || defined(__x86_64__) || defined(_M_X64) )
+ #define TWIN_WORDS 1
+
+/* Count twin pairs starting in nwords*8 bytes of s, reading one byte more. */
+static UV _twin_pairs_words(const unsigned char* s, UV nwords) {
+  const UV m14 = UVCONST(0x1414141414141414), m80 = UVCONST(0x8080808080808080),
+           m94 = UVCONST(0x9494949494949494);
+  UV w, next, pairs = 0;
+  for ( ; nwords > 0; nwords--, s += sizeof(UV)) {
+    memcpy(&w, s, sizeof(UV));
+    memcpy(&next, s+1, sizeof(UV));
+    pairs += popcnt(TWIN_PAIRS(w, next, m14, m80, m94));
+  }
+  return pairs;
+}
+
+#ifdef POPCNT_DISPATCH
+__attribute__((target("popcnt")))
+static UV _twin_pairs_words_popcnt(const unsigned char* s, UV nwords) {
+  const UV m14 = UVCONST(0x1414141414141414), m80 = UVCONST(0x8080808080808080),
+           m94 = UVCONST(0x9494949494949494);
+  UV w, next, pairs = 0;
+  for ( ; nwords > 0; nwords--, s += sizeof(UV)) {
+    memcpy(&w, s, sizeof(UV));
+    memcpy(&next, s+1, sizeof(UV));
+    pairs += __builtin_popcountll(TWIN_PAIRS(w, next, m14, m80, m94));
+  }
+  return pairs;
+}
+
+/* Four words at a time, with the pair bits counted by nibble lookup as in
+ * _popcount_words_avx2.  A byte has at most 3 pairs, so 31 rounds fit. */
+__attribute__((target("avx2,popcnt")))
+static UV _twin_pairs_words_avx2(const unsigned char* s, UV nwords) {
+  const __m256i lookup = _mm256_setr_epi8(0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4,
+                                          0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4);
+  const __m256i lomask = _mm256_set1_epi8(0x0f);
+  const __m256i m14 = _mm256_set1_epi8(0x14);
+  const __m256i m80 = _mm256_set1_epi8((char)0x80);
+  const __m256i m94 = _mm256_set1_epi8((char)0x94);
+  __m256i acc = _mm256_setzero_si256();
+  UV i = 0, pairs;
+  while (i+4 <= nwords) {
+    __m256i bytes = _mm256_setzero_si256();
+    UV rounds = (nwords-i)/4;
+    if (rounds > 31) rounds = 31;
+    for ( ; rounds > 0; rounds--, i += 4) {
+      __m256i w    = _mm256_loadu_si256((const __m256i*)(s+8*i));
+      __m256i next = _mm256_loadu_si256((const __m256i*)(s+8*i+1));
+      __m256i comp = _mm256_or_si256(w, _mm256_or_si256(
+                       _mm256_and_si256(_mm256_srli_epi64(w, 1), m14),
+                       _mm256_and_si256(_mm256_slli_epi64(next, 7), m80)));
+      __m256i v  = _mm256_andnot_si256(comp, m94);
+      __m256i lo = _mm256_and_si256(v, lomask);
+      __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), lomask);
+      bytes = _mm256_add_epi8(bytes, _mm256_shuffle_epi8(lookup, lo));
+      bytes = _mm256_add_epi8(bytes, _mm256_shuffle_epi8(lookup, hi));
+    }
+    acc = _mm256_add_epi64(acc, _mm256_sad_epu8(bytes, _mm256_setzero_si256()));
+  }
+  pairs = _mm256_extract_epi64(acc, 0) + _mm256_extract_epi64(acc, 1)
+        + _mm256_extract_epi64(acc, 2) + _mm256_extract_epi64(acc, 3);
+  return pairs + _twin_pairs_words_popcnt(s+8*i, nwords-i);
+}
+#endif
+
+static UV (*twin_pairs_words)(const unsigned char*, UV) = 0;
+#endif
+
+/* Every thread picks the same kernels, so racing on this is harmless. */
+static UV (*popcount_words)(const UV*, UV) = 0;
+
+static void _select_count_kernels(void) {
+  UV (*f)(const UV*, UV) = _popcount_words;
+#ifdef TWIN_WORDS
+  UV (*t)(const unsigned char*, UV) = _twin_pairs_words;
+#endif
+#ifdef POPCNT_DISPATCH
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("popcnt"))  f = _popcount_words_popcnt;
+  if (__builtin_cpu_supports("avx2"))    f = _popcount_words_avx2;
+ #ifdef POPCNT_AVX512
+  if (__builtin_cpu_supports("avx512vpopcntdq"))  f = _popcount_words_avx512;
+ #endif
+  if (__builtin_cpu_supports("popcnt"))  t = _twin_pairs_words_popcnt;
+  if (__builtin_cpu_supports("avx2"))    t = _twin_pairs_words_avx2;
+#endif
+#ifdef TWIN_WORDS
+  twin_pairs_words = t;
+#endif
+  popcount_words = f;
+}
+
 static UV count_zero_bits(const unsigned char* m, UV nbytes)
 {
   UV count = 0;
@@ -150,14 +418,11 @@ static UV count_zero_bits(const unsigned char* m, UV nbytes)
     while ( word_unaligned(m,sizeof(UV)) && nbytes--)
       count += byte_zeros[*m++];
     if (nbytes >= 8) {
-      UV* wordptr = (UV*)m;
       UV nwords = nbytes / 8;
-      UV nzeros = nwords * 64;
+      if (popcount_words == 0)  _select_count_kernels();
+      count += nwords * 64 - popcount_words((const UV*)m, nwords);
       m += nwords * 8;
       nbytes %= 8;
-      while (nwords--)
-        nzeros -= popcnt(*wordptr++);
-      count += nzeros;
     }
   }
 #endif
@@ -166,6 +431,45 @@ static UV count_zero_bits(const unsigned char* m, UV nbytes)
   return count;
 }
 
+/* Count zero bits from the start of m, stopping before the byte that would
+ * bring the count to maxcount.  The number of bytes counted is put in
+ * *nbytes_counted.  Whole blocks are counted with the fast kernel, then
+ * words, then bytes as we close in on maxcount. */
+#define ZERO_COUNT_BLOCK 256
+static UV count_zero_bits_to(const unsigned char* m, UV nbytes, UV maxcount, UV* nbytes_counted)
+{
+  const unsigned char* start = m;
+  const unsigned char* end = m + nbytes;
+  UV count = 0;
+
+  while (m < end && word_unaligned(m,sizeof(UV)) && count + byte_zeros[*m] < maxcount)
+    count += byte_zeros[*m++];
+  if (m < end && !word_unaligned(m,sizeof(UV))) {
+    while ((UV)(end-m) >= ZERO_COUNT_BLOCK && count + 8*ZERO_COUNT_BLOCK < maxcount) {
+      count += count_zero_bits(m, ZERO_COUNT_BLOCK);
+      m += ZERO_COUNT_BLOCK;
+    }
+    while ((UV)(end-m) >= ZERO_COUNT_BLOCK) {
+      UV zeros = count_zero_bits(m, ZERO_COUNT_BLOCK);
+      if (count + zeros >= maxcount) break;
+      count += zeros;
+      m += ZERO_COUNT_BLOCK;
+    }
+#if BITS_PER_WORD == 64
+    while ((UV)(end-m) >= sizeof(UV)) {
+      UV zeros = 64 - popcnt(*(const UV*)m);
+      if (count + zeros >= maxcount) break;
+      count += zeros;
+      m += sizeof(UV);
+    }
+#endif
+  }
+  while (m < end && count + byte_zeros[*m] < maxcount)
+    count += byte_zeros[*m++];
+  *nbytes_counted = m - start;
+  return count;
+}
+
 
 
 /* We'll use this little static sieve to quickly answer small values of
@@ -234,6 +538,65 @@ int _XS_is_prime(UV n)
 }
 
 
+/* A small sieved window for next_prime and prev_prime past the cache, so a
+ * walk through consecutive primes costs sieving rather than a BPSW test
+ * for every wheel candidate.  The window is only filled when a call lands
+ * near the previous one, so isolated calls don't pay for a sieve.  It is
+ * per thread, so needs compiler support for thread-local storage. */
+#if defined(__GNUC__) || defined(__clang__)
+  #define NP_WINDOW_TLS __thread
+#elif defined(_MSC_VER)
+  #define NP_WINDOW_TLS __declspec(thread)
+#endif
+
+#ifdef NP_WINDOW_TLS
+#define NP_WINDOW_BYTES 16384
+static NP_WINDOW_TLS UV _npw_lod = 0;   /* window holds bytes lod to hid-1 */
+static NP_WINDOW_TLS UV _npw_hid = 0;
+static NP_WINDOW_TLS UV _npw_last = 0;  /* last n we were asked about */
+static NP_WINDOW_TLS unsigned char _npw_sieve[NP_WINDOW_BYTES];
+
+/* Is n close to the last call?  Always remembers n. */
+static int _npw_near(UV n) {
+  UV dist = (n > _npw_last) ? n - _npw_last : _npw_last - n;
+  _npw_last = n;
+  return dist < 30*NP_WINDOW_BYTES;
+}
+static void _npw_fill(UV lod) {
+  if (lod > UV_MAX/30 - NP_WINDOW_BYTES)  lod = UV_MAX/30 - NP_WINDOW_BYTES;
+  _npw_hid = 0;
+  sieve_segment(_npw_sieve, lod, lod + NP_WINDOW_BYTES - 1);
+  _npw_lod = lod;
+  _npw_hid = lod + NP_WINDOW_BYTES;
+}
+/* These return 0 if the answer isn't in the window. */
+static UV _npw_next(UV n) {
+  UV d = n/30, m = n - d*30;
+  if (d < _npw_lod || d >= _npw_hid) return 0;
+  do {
+    if (m != 29) {
+      m = nextwheel30[m];
+    } else {
+      d++; m = 1;
+      if (d >= _npw_hid) return 0;
+    }
+  } while (_npw_sieve[d-_npw_lod] & masktab30[m]);
+  return d*30+m;
+}
+static UV _npw_prev(UV n) {
+  UV d = n/30, m = n - d*30;
+  if (d < _npw_lod || d >= _npw_hid) return 0;
+  do {
+    m = prevwheel30[m];
+    if (m == 29) {
+      if (d == _npw_lod) return 0;
+      d--;
+    }
+  } while (_npw_sieve[d-_npw_lod] & masktab30[m]);
+  return d*30+m;
+}
+#endif
+
 UV next_prime(UV n)
 {
   UV m, sieve_size, next;
@@ -251,6 +614,15 @@ UV next_prime(UV n)
   release_prime_cache(sieve);
   if (next != 0) return next;
 
+#ifdef NP_WINDOW_TLS
+  next = _npw_next(n);
+  if (_npw_near(n) && next == 0) {
+    _npw_fill(n/30);
+    next = _npw_next(n);
+  }
+  if (next != 0) return next;
+#endif
+
   m = n % 30;
   do { /* Move forward one. */
     n += wheeladvance30[m];
@@ -275,6 +647,15 @@ UV prev_prime(UV n)
   }
   release_prime_cache(sieve);
 
+#ifdef NP_WINDOW_TLS
+  prev = _npw_prev(n);
+  if (_npw_near(n) && prev == 0) {
+    _npw_fill( (n/30 >= NP_WINDOW_BYTES) ? n/30 - NP_WINDOW_BYTES + 1 : 0 );
+    prev = _npw_prev(n);
+  }
+  if (prev != 0) return prev;
+#endif
+
   m = n % 30;
   do { /* Move back one. */
     n -= wheelretreat[m];
@@ -292,12 +673,10 @@ UV prev_prime(UV n)
  * (2) we hit maxcount: set position to the index of the maxcount'th prime
  *     and return count (which will be equal to maxcount).
  */
-static UV count_segment_maxcount(const unsigned char* sieve, UV base, UV nbytes, UV maxcount, UV* pos)
+static UV count_segment_maxcount(const unsigned char* sieve, UV nbytes, UV maxcount, UV* pos)
 {
   UV count = 0;
   UV byte = 0;
-  const unsigned char* sieveptr = sieve;
-  const unsigned char* maxsieve = sieve + nbytes;
 
   MPUassert(sieve != 0, "count_segment_maxcount incorrect args");
   MPUassert(pos != 0, "count_segment_maxcount incorrect args");
@@ -305,25 +684,7 @@ static UV count_segment_maxcount(const unsigned char* sieve, UV base, UV nbytes,
   if ( (nbytes == 0) || (maxcount == 0) )
     return 0;
 
-  /* Do fixed-length word counts to start, with possible overcounting */
-  while ((count+64) < maxcount && sieveptr < maxsieve) {
-    UV top = base + 3*maxcount;
-    UV div = (top <       8000) ? 8 :     /* 8 cannot overcount */
-             (top <    1000000) ? 4 :
-             (top <   10000000) ? 3 : 2;
-    UV minbytes = (maxcount-count)/div;
-    if (minbytes > (UV)(maxsieve-sieveptr)) minbytes = maxsieve-sieveptr;
-    count += count_zero_bits(sieveptr, minbytes);
-    sieveptr += minbytes;
-  }
-  /* Count until we reach the end or >= maxcount */
-  while ( (sieveptr < maxsieve) && (count < maxcount) )
-    count += byte_zeros[*sieveptr++];
-  /* If we went too far, back up. */
-  while (count >= maxcount)
-    count -= byte_zeros[*--sieveptr];
-  /* We counted this many bytes */
-  byte = sieveptr - sieve;
+  count = count_zero_bits_to(sieve, nbytes, maxcount, &byte);
 
   MPUassert(count < maxcount, "count_segment_maxcount wrong count");
 
@@ -402,6 +763,33 @@ static UV count_segment_ranged(const unsigned char* sieve, UV nbytes, UV lowp, U
   return count;
 }
 
+/* The reverse of count_segment_maxcount, for a segment from base holding
+ * low to high.  Counts primes down from high, and if it reaches maxcount,
+ * sets pos to that prime.  Returns the count. */
+static UV count_segment_maxcount_reverse(const unsigned char* sieve, UV base, UV low, UV high, UV maxcount, UV* pos)
+{
+  UV lo = low - base, hi = high - base, d, count;
+
+  MPUassert(sieve != 0 && pos != 0, "count_segment_maxcount_reverse incorrect args");
+  *pos = 0;
+  if (maxcount == 0 || hi < lo)
+    return 0;
+  count = count_segment_ranged(sieve, hi/30 + 1, lo, hi);
+  if (count < maxcount)
+    return count;
+
+  count = 0;
+  for (d = hi/30; ; d--) {
+    int b;
+    unsigned char s = ~sieve[d];
+    for (b = 7; b >= 0; b--) {
+      UV p = d*30 + wheel30[b];
+      if (!(s & (1 << b)) || p > hi || p < lo)  continue;
+      if (++count == maxcount)  { *pos = base + p; return count; }
+    }
+  }
+}
+
 
 /*
  * The pi(x) prime count functions.  prime_count(x) gives an exact number,
@@ -808,11 +1196,28 @@ UV nth_prime_approx(UV n)
 }
 
 
+/* The kth prime counting down from high, where the primes from low to high
+ * are known to hold at least k. */
+static UV _nth_prime_down(UV low, UV high, UV k)
+{
+  unsigned char* segment;
+  UV seg_base, seg_low, seg_high, p = 0;
+  void* ctx = start_segment_primes_reverse(low, high, &segment);
+  while (next_segment_primes(ctx, &seg_base, &seg_low, &seg_high)) {
+    UV c = count_segment_maxcount_reverse(segment, seg_base, seg_low, seg_high, k, &p);
+    if (c == k)  break;
+    k -= c;
+  }
+  end_segment_primes(ctx);
+  MPUassert(p != 0, "nth_prime went past its lower bound");
+  return p;
+}
+
 UV nth_prime(UV n)
 {
   const unsigned char* cache_sieve;
   unsigned char* segment;
-  UV upper_limit, segbase, segment_size;
+  UV upper_limit, lower_limit, segbase, segment_size;
   UV p = 0;
   UV target = n-3;
   UV count = 0;
@@ -835,31 +1240,30 @@ UV nth_prime(UV n)
     segment_size = get_prime_cache(upper_limit, &cache_sieve) / 30;
     /* Count up everything in the cached sieve. */
     if (segment_size > 0)
-      count += count_segment_maxcount(cache_sieve, 0, segment_size, target, &p);
+      count += count_segment_maxcount(cache_sieve, segment_size, target, &p);
     release_prime_cache(cache_sieve);
+  } else if (prime_count_table_nth(n, &lower_limit, &count)) {
+    /* The checkpoint is a multiple of 30, so it isn't prime and the sieve
+     * can start right at it. */
+    segment_size = lower_limit / 30;
+    count -= 3;
+    prime_precalc(isqrt(upper_limit));
   } else {
-    /* A binary search on RiemannR is nice, but ends up either often being
-     * being higher (requiring going backwards) or biased and then far too
-     * low.  Using the inverse Li is easier and more consistent. */
-    UV lower_limit = _XS_Inverse_Li(n);
-    /* For even better performance, add in half the usual correction, which
-     * will get us even closer, so even less sieving required.  However, it
-     * is now possible to get a result higher than the value, so we'll need
-     * to handle that case.  It still ends up being a better deal than R,
-     * given that we don't have a fast backward sieve. */
-    lower_limit += _XS_Inverse_Li(isqrt(n))/4;
+    /* Inverse Riemann R is our closest estimate, but about as often high
+     * as low.  Count to it, then sieve forwards or backwards.  One Newton
+     * step from inverse Li with the R correction gets there much faster
+     * than nth_prime_approx's binary search. */
+    double est;
+    lower_limit = _XS_Inverse_Li(n) + _XS_Inverse_Li(isqrt(n))/2;
+    est = (double)lower_limit + ((double)n - (double)_XS_RiemannR(lower_limit)) * log((double)lower_limit);
+    lower_limit = (est >= (double)upper_limit) ? upper_limit : (UV)est;
     segment_size = lower_limit / 30;
     lower_limit = 30 * segment_size - 1;
-    count = _XS_LMO_pi(lower_limit);
-
-    /* printf("We've estimated %lu too %s.\n", (count>n)?count-n:n-count, (count>n)?"FAR":"little"); */
-    /* printf("Our limit %lu %s a prime\n", lower_limit, _XS_is_prime(lower_limit) ? "is" : "is not"); */
+    count = _XS_pi(lower_limit);
 
-    if (count >= n) { /* Too far.  Walk backwards */
-      if (_XS_is_prime(lower_limit)) count--;
-      for (p = 0; p <= (count-n); p++)
-        lower_limit = prev_prime(lower_limit);
-      return lower_limit;
+    if (count >= n) { /* Too far.  Sieve backwards */
+      UV low = nth_prime_lower(n);
+      return _nth_prime_down((low < 7) ? 7 : low, lower_limit, count-n+1);
     }
     count -= 3;
 
@@ -883,7 +1287,7 @@ UV nth_prime(UV n)
     sieve_segment(segment, segbase, segbase + segment_size-1);
 
     /* Count up everything in this segment */
-    count += count_segment_maxcount(segment, 30*segbase, segment_size, target-count, &p);
+    count += count_segment_maxcount(segment, segment_size, target-count, &p);
 
     if (count < target)
       segbase += segment_size;
@@ -893,6 +1297,124 @@ UV nth_prime(UV n)
   return ( (segbase*30) + p );
 }
 
+/* The _multi functions answer sorted queries in runs.  Each run starts with
+ * one full answer, then sweeps a segment sieve to the rest.  A point joins
+ * the run if sieving to it is cheaper than starting over, which as in
+ * prime_count is when the gap is under 1% of the point, or short anyway. */
+#define MULTI_SIEVE_OK(a, b)  ((b)-(a) < 1000000 || (b)/((b)-(a)) > 100)
+
+typedef struct {
+  UV v;
+  UV i;       /* position in the caller's list */
+} multi_query_t;
+
+static int _multi_cmp(const void *a, const void *b) {
+  const multi_query_t *x = a, *y = b;
+  return (x->v > y->v) ? 1 : (x->v < y->v) ? -1 : 0;
+}
+
+static multi_query_t* _sorted_queries(UV n, const UV* v)
+{
+  multi_query_t* q;
+  UV i;
+  New(0, q, n, multi_query_t);
+  for (i = 0; i < n; i++) {
+    q[i].v = v[i];
+    q[i].i = i;
+  }
+  qsort(q, n, sizeof(multi_query_t), _multi_cmp);
+  return q;
+}
+
+void prime_count_multi(UV n, const UV* x, UV* counts)
+{
+  multi_query_t* q = _sorted_queries(n, x);
+  UV i = 0, j, k;
+
+  while (i < n) {
+    UV count = _XS_pi(q[i].v);
+    counts[q[i].i] = count;
+    for (j = i+1; j < n && q[i].v >= 7 && MULTI_SIEVE_OK(q[j-1].v, q[j].v); j++)
+      ;
+    for (k = i+1; k < j && q[k].v == q[i].v; k++)
+      counts[q[k].i] = count;
+    if (k < j) {
+      unsigned char* segment;
+      UV seg_base, seg_low, seg_high;
+      void* ctx = start_segment_primes(q[i].v+1, q[j-1].v, &segment);
+      while (next_segment_primes(ctx, &seg_base, &seg_low, &seg_high)) {
+        UV from = seg_low, nbytes = (seg_high - seg_base)/30 + 1;
+        for ( ; k < j && q[k].v <= seg_high; k++) {
+          if (q[k].v >= from) {
+            count += count_segment_ranged(segment, nbytes, from - seg_base, q[k].v - seg_base);
+            from = q[k].v + 1;
+          }
+          counts[q[k].i] = count;
+        }
+        if (from <= seg_high)
+          count += count_segment_ranged(segment, nbytes, from - seg_base, seg_high - seg_base);
+      }
+      end_segment_primes(ctx);
+    }
+    i = j;
+  }
+  Safefree(q);
+}
+
+void nth_prime_multi(UV n, const UV* k, UV* primes)
+{
+  multi_query_t* q = _sorted_queries(n, k);
+  UV i = 0, j;
+
+  while (i < n) {
+    UV first = nth_prime(q[i].v);
+    double est = (double) first, logp = log((double)first + 2);
+    primes[q[i].i] = first;
+    /* Primes are about log p apart, which is close enough for choosing. */
+    for (j = i+1; j < n && first >= 7; j++) {
+      double next = est + (double)(q[j].v - q[j-1].v) * logp;
+      if (next >= (double)MPU_MAX_PRIME || !MULTI_SIEVE_OK((UV)est, (UV)next))
+        break;
+      est = next;
+    }
+    if (j > i+1) {
+      unsigned char* segment;
+      UV seg_base, seg_low, seg_high, m = i+1, last = first, want;
+      void* ctx = start_segment_primes(first+1, nth_prime_upper(q[j-1].v), &segment);
+      want = q[m].v - q[i].v;
+      while (m < j) {
+        UV c;
+        if (want == 0) {              /* repeated index */
+          primes[q[m].i] = last;
+          if (++m < j)  want = q[m].v - q[m-1].v;
+          continue;
+        }
+        if (!next_segment_primes(ctx, &seg_base, &seg_low, &seg_high))
+          break;
+        c = count_segment_ranged(segment, (seg_high-seg_base)/30 + 1, seg_low - seg_base, seg_high - seg_base);
+        if (c < want) {
+          want -= c;
+          continue;
+        }
+        START_DO_FOR_EACH_SIEVE_PRIME(segment, seg_base, seg_low, seg_high)
+          if (--want == 0) {
+            last = p;
+            do {
+              primes[q[m++].i] = p;
+            } while (m < j && q[m].v == q[m-1].v);
+            if (m >= j)  break;
+            want = q[m].v - q[m-1].v;
+          }
+        END_DO_FOR_EACH_SIEVE_PRIME
+      }
+      end_segment_primes(ctx);
+      MPUassert(m == j, "nth_prime_multi sieved past the upper bound");
+    }
+    i = j;
+  }
+  Safefree(q);
+}
+
 #if BITS_PER_WORD < 64
 static const UV twin_steps[] =
   {58980,48427,45485,43861,42348,41457,40908,39984,39640,39222,
@@ -920,9 +1442,102 @@ static const unsigned int twin_num_exponents = 12;
 static const unsigned int twin_last_mult = 4;      /* 4e19 */
 #endif
 
+/* Wheel bits of a sieve byte for residues from r up, or up to r. */
+static unsigned int _wheel_bits_from(UV r) {
+  unsigned int m = 0;
+  for ( ; r < 30; r++)  m |= masktab30[r];
+  return m;
+}
+static unsigned int _wheel_bits_to(UV r) {
+  unsigned int m = 0;
+  do { m |= masktab30[r]; } while (r-- > 0);
+  return m;
+}
+
+/* Twin pairs whose lower member is at an offset from lowp to highp in the
+ * sieve.  The upper member of the top pair (30k+29, 30k+31) of the last
+ * byte is past the sieve, so that pair is not counted, and *last is set if
+ * its lower member is in range and prime. */
+static UV count_twin_segment(const unsigned char* sieve, UV nbytes, UV lowp, UV highp, int* last)
+{
+  UV d, lod, hid, count = 0;
+
+  *last = 0;
+  if (highp > 30*nbytes-1)  highp = 30*nbytes-1;
+  if (lowp > highp)  return 0;
+  lod = lowp / 30;
+  hid = highp / 30;
+  for (d = lod; d <= hid; d++) {
+    unsigned int mask = 0xFF, next;
+#ifdef TWIN_WORDS
+    if (d > lod && hid - d > sizeof(UV)) {
+      UV nwords = (hid - d) / sizeof(UV);    /* the next byte is still <= hid */
+      if (twin_pairs_words == 0)  _select_count_kernels();
+      count += twin_pairs_words(sieve + d, nwords);
+      d += nwords * sizeof(UV);
+    }
+#endif
+    if (d == lod)  mask &= _wheel_bits_from(lowp % 30);
+    if (d == hid)  mask &= _wheel_bits_to(highp % 30);
+    next = (d+1 < nbytes) ? sieve[d+1] : 0xFF;
+    count += popcnt(TWIN_BYTE_PAIRS(sieve[d], next) & mask);
+    if (d+1 == nbytes && (mask & 0x80) && !(sieve[d] & 0x80))
+      *last = 1;
+  }
+  return count;
+}
+
+typedef struct {
+  UV  count;    /* pairs with both members in the segment */
+  int first;    /* the first value of the segment, 30k+1, is prime */
+  int last;     /* the top lower member is prime and <= end */
+} twin_segment_t;
+
+/* Runs in the thread that sieved the segment.  arg is the last lower member
+ * wanted; the sieve goes two past it for its partner. */
+static void _twin_segment(void* arg, const unsigned char* segment, UV base, UV low, UV high, void* out)
+{
+  UV end = *(const UV*)arg;
+  twin_segment_t* res = (twin_segment_t*) out;
+  UV nbytes = (high - base)/30 + 1;
+  res->first = !(segment[0] & 0x01);
+  res->count = (low > end) ? 0 : count_twin_segment(segment, nbytes, low - base, ((high < end) ? high : end) - base, &res->last);
+  if (low > end)  res->last = 0;
+}
+
+static void* _start_twin_segments(UV beg, UV* end)
+{
+  UV high = (*end < UV_MAX-2) ? *end+2 : UV_MAX;
+  return start_segment_work(beg, high, _XS_get_segment_size(), sizeof(twin_segment_t), _twin_segment, end);
+}
+
+/* The nth twin pair with lower member from low to high, sieving the bytes
+ * again.  The pairs are known to be there. */
+static UV _nth_twin_in_range(UV low, UV high, UV n)
+{
+  static const unsigned char lower[3] = {11, 17, 29};
+  static const unsigned char lowerbit[3] = {0x04, 0x10, 0x80};
+  unsigned char* sieve;
+  UV d, lod = low/30, hid = high/30, nth = 0;
+
+  New(0, sieve, hid - lod + 2, unsigned char);
+  sieve_segment(sieve, lod, hid+1);
+  for (d = lod; d <= hid && nth == 0; d++) {
+    unsigned int i, pairs = TWIN_BYTE_PAIRS(sieve[d-lod], sieve[d-lod+1]);
+    if (d == lod)  pairs &= _wheel_bits_from(low % 30);
+    if (d == hid)  pairs &= _wheel_bits_to(high % 30);
+    for (i = 0; i < 3; i++)
+      if ((pairs & lowerbit[i]) && --n == 0) {
+        nth = 30*d + lower[i];
+        break;
+      }
+  }
+  Safefree(sieve);
+  return nth;
+}
+
 UV twin_prime_count(UV beg, UV end)
 {
-  unsigned char* segment;
   UV sum = 0;
 
   /* First use the tables of #e# from 1e7 to 2e16. */
@@ -939,39 +1554,15 @@ UV twin_prime_count(UV beg, UV end)
   }
   if (beg <= 3 && end >= 3) sum++;
   if (beg <= 5 && end >= 5) sum++;
-  if (beg < 11) beg = 7;
-  if (beg <= end) {
-    /* Make end points odd */
-    beg |= 1;
-    end = (end-1) | 1;
-    /* Cheesy way of counting the partial-byte edges */
-    while ((beg % 30) != 1) {
-      if (_XS_is_prime(beg) && _XS_is_prime(beg+2) && beg <= end) sum++;
-      beg += 2;
-    }
-    while ((end % 30) != 29) {
-      if (_XS_is_prime(end) && _XS_is_prime(end+2) && beg <= end) sum++;
-      end -= 2;  if (beg > end) break;
-    }
-  }
+  if (beg < 7) beg = 7;
   if (beg <= end) {
     UV seg_base, seg_low, seg_high;
-    void* ctx = start_segment_primes(beg, end, &segment);
+    int prev_last = 0;
+    void* ctx = _start_twin_segments(beg, &end);
     while (next_segment_primes(ctx, &seg_base, &seg_low, &seg_high)) {
-      UV bytes = (seg_high-seg_low+29)/30;
-      unsigned char s;
-      const unsigned char* sp = segment;
-      const unsigned char* const spend = segment + bytes - 1;
-      while (sp < spend) {
-        s = *sp++;
-        if (!(s & 0x0C)) sum++;
-        if (!(s & 0x30)) sum++;
-        if (!(s & 0x80) && !(*sp & 0x01)) sum++;
-      }
-      s = *sp;
-      if (!(s & 0x0C)) sum++;
-      if (!(s & 0x30)) sum++;
-      if (!(s & 0x80) && _XS_is_prime(seg_high+2)) sum++;
+      const twin_segment_t* res = (const twin_segment_t*) segment_work_output(ctx);
+      sum += res->count + (prev_last && res->first);
+      prev_last = res->last;
     }
     end_segment_primes(ctx);
   }
@@ -980,7 +1571,6 @@ UV twin_prime_count(UV beg, UV end)
 
 UV nth_twin_prime(UV n)
 {
-  unsigned char* segment;
   double dend;
   UV nth = 0;
   UV beg, end;
@@ -1018,19 +1608,20 @@ UV nth_twin_prime(UV n)
 
   {
     UV seg_base, seg_low, seg_high;
-    void* ctx = start_segment_primes(beg, end, &segment);
+    int prev_last = 0;
+    void* ctx = _start_twin_segments(beg, &end);
     while (next_segment_primes(ctx, &seg_base, &seg_low, &seg_high)) {
-      UV p, bytes = (seg_high-seg_low+29)/30;
-      UV s = ((UV)segment[0]) << 8;
-      for (p = 0; p < bytes; p++) {
-        s >>= 8;
-        if (p+1 < bytes)                    s |= (((UV)segment[p+1]) << 8);
-        else if (!_XS_is_prime(seg_high+2)) s |= 0xFF00;
-        if (!(s & 0x000C) && !--n) { nth=seg_base+p*30+11; break; }
-        if (!(s & 0x0030) && !--n) { nth=seg_base+p*30+17; break; }
-        if (!(s & 0x0180) && !--n) { nth=seg_base+p*30+29; break; }
+      const twin_segment_t* res = (const twin_segment_t*) segment_work_output(ctx);
+      if (prev_last && res->first && --n == 0) {
+        nth = seg_base - 1;
+        break;
       }
-      if (n == 0) break;
+      if (res->count >= n) {
+        nth = _nth_twin_in_range(seg_low, (seg_high < end) ? seg_high : end, n);
+        break;
+      }
+      n -= res->count;
+      prev_last = res->last;
     }
     end_segment_primes(ctx);
   }
@@ -1138,7 +1729,7 @@ UV* n_range_ramanujan_primes(UV nlo, UV nhi) {
   maxk = nth_ramanujan_prime_upper(nhi);
   if (mink < 15) mink = 15;
   if (mink % 2 == 0) mink--;
-  s = 1 + _XS_LMO_pi(mink-2) - _XS_LMO_pi((mink-1)>>1);
+  s = 1 + _XS_pi(mink-2) - _XS_pi((mink-1)>>1);
   if (verbose >= 2) printf("Generate Rn[%"UVuf"] to Rn[%"UVuf"]: search %"UVuf" to %"UVuf"\n", nlo, nhi, mink, maxk);
 
   seg1beg = 30 * (mink/30);
@@ -1201,9 +1792,14 @@ int is_ramanujan_prime(UV n) {
 }
 
 int sum_primes(UV low, UV high, UV *return_sum) {
-  UV sum = 0;
+  UV sum = 0, hisum;
   int overflow = 0;
 
+  if (sum_primes128(low, high, &hisum, &sum)) {
+    if (hisum == 0 && return_sum != 0)  *return_sum = sum;
+    return (hisum == 0);
+  }
+
   if ((low <= 2) && (high >= 2)) sum += 2;
   if ((low <= 3) && (high >= 3)) sum += 3;
   if ((low <= 5) && (high >= 5)) sum += 5;
@@ -1224,43 +1820,154 @@ int sum_primes(UV low, UV high, UV *return_sum) {
   if (!overflow && return_sum != 0)  *return_sum = sum;
   return !overflow;
 }
+static const char _digit_pairs[201] =
+  "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+  "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+  "8081828384858687888990919293949596979899";
+/* Writes val and a newline, two digits at a time from the end. */
 static int my_sprint(char* ptr, UV val) {
+  char tmp[24];
+  char *s = tmp + sizeof(tmp);
   int nchars;
-  UV t;
-  char *s = ptr;
-  do {
-    t = val / 10; *s++ = (char) ('0' + val - 10 * t);
-  } while ((val = t));
-  nchars = s - ptr + 1;  *s = '\n';
-  while (--s > ptr) { char c = *s; *s = *ptr; *ptr++ = c; }
+  *--s = '\n';
+  while (val >= 100) {
+    UV t = val / 100;
+    const char* d = _digit_pairs + 2*(val - 100*t);
+    *--s = d[1];  *--s = d[0];
+    val = t;
+  }
+  if (val >= 10) { const char* d = _digit_pairs + 2*val;  *--s = d[1];  *--s = d[0]; }
+  else           { *--s = (char) ('0' + val); }
+  nchars = (tmp + sizeof(tmp)) - s;
+  memcpy(ptr, s, nchars);
   return nchars;
 }
-static char* write_buf(int fd, char* buf, char* bend) {
-  int res = (int) write(fd, buf, bend-buf);
-  if (res == -1) croak("print_primes write error");
-  return buf;
-}
-void print_primes(UV low, UV high, int fd) {
-  char buf[8000+25];
-  char* bend = buf;
-  if ((low <= 2) && (high >= 2)) bend += my_sprint(bend,2);
-  if ((low <= 3) && (high >= 3)) bend += my_sprint(bend,3);
-  if ((low <= 5) && (high >= 5)) bend += my_sprint(bend,5);
+/* Big-endian base 128 with the high bit on all but the last byte, which
+ * is Perl's pack "w". */
+static int ber_sprint(unsigned char* ptr, UV val) {
+  unsigned char tmp[(BITS_PER_WORD+6)/7];
+  int i, n = 0;
+  do { tmp[n++] = val & 0x7F; } while ((val >>= 7));
+  for (i = 0; i < n; i++)
+    ptr[i] = tmp[n-1-i] | ((i < n-1) ? 0x80 : 0);
+  return n;
+}
+static int le64_sprint(unsigned char* ptr, UV val) {
+  int i;
+  for (i = 0; i < 8; i++) {
+    ptr[i] = (unsigned char) (val & 0xFF);
+    val >>= 8;
+  }
+  return 8;
+}
+static int print_sprint(unsigned char* ptr, UV val, UV prev, int format) {
+  switch (format) {
+    case PRINT_PRIMES_LE64:   return le64_sprint(ptr, val);
+    case PRINT_PRIMES_DELTA:  return ber_sprint(ptr, val-prev);
+    default:                  return my_sprint((char*)ptr, val);
+  }
+}
+static int write_all(int fd, const unsigned char* buf, UV nbytes) {
+  while (nbytes > 0) {
+    int res = (int) write(fd, buf, nbytes);
+    if (res == -1)  return 0;
+    buf += res;
+    nbytes -= res;
+  }
+  return 1;
+}
+
+/* Segments are sieved and formatted by the worker threads, then written in
+ * order.  The output of each follows this header, leaving room in front for
+ * the delta from the previous segment's last prime. */
+#define PRINT_SEGMENT_BYTES  65536
+#define PRINT_LEAD_BYTES     16
+typedef struct {
+  UV nbytes;
+  UV last;         /* last prime, for deltas */
+  UV firstbytes;   /* length of the first prime's delta, which is from 0 */
+} print_head_t;
+#define PRINT_DATA(h)  ((unsigned char*)((h)+1) + PRINT_LEAD_BYTES)
+
+static void _print_segment(void* arg, const unsigned char* segment, UV base, UV low, UV high, void* out)
+{
+  int format = *(const int*)arg;
+  print_head_t* h = (print_head_t*) out;
+  unsigned char *start = PRINT_DATA(h), *s = start;
+  UV prev = 0;
+  if (format == PRINT_PRIMES_DELTA) {
+    START_DO_FOR_EACH_SIEVE_PRIME( segment, base, low, high )
+      s += ber_sprint(s, p-prev);
+      if (prev == 0)  h->firstbytes = s-start;
+      prev = p;
+    END_DO_FOR_EACH_SIEVE_PRIME
+  } else if (format == PRINT_PRIMES_LE64) {
+    START_DO_FOR_EACH_SIEVE_PRIME( segment, base, low, high )
+      s += le64_sprint(s, p);
+    END_DO_FOR_EACH_SIEVE_PRIME
+  } else {
+    START_DO_FOR_EACH_SIEVE_PRIME( segment, base, low, high )
+      s += my_sprint((char*)s, p);
+    END_DO_FOR_EACH_SIEVE_PRIME
+  }
+  h->nbytes = s-start;
+  h->last = prev;
+}
+
+/* Room for any segment's output.  Montgomery and Vaughan (1973) show there
+ * are at most 2y/log(y) primes in any interval of length y. */
+static UV _print_out_bytes(UV high, int format)
+{
+  double span = 30.0 * PRINT_SEGMENT_BYTES;
+  UV maxprimes = (UV) (2.0 * span / log(span)) + 16;
+  UV each = 8;
+  if (format == PRINT_PRIMES_DELTA) {
+    each = 3;                           /* gaps under 2^21 */
+  } else if (format == PRINT_PRIMES_TEXT) {
+    for (each = 2; high >= 10; high /= 10)
+      each++;
+  }
+  return sizeof(print_head_t) + PRINT_LEAD_BYTES + maxprimes * each;
+}
+
+void print_primes(UV low, UV high, int fd, int format) {
+  unsigned char buf[4*32];
+  int nbytes = 0, ok = 1;
+  UV last = 0;
+  if ((low <= 2) && (high >= 2)) { nbytes += print_sprint(buf+nbytes,2,last,format); last = 2; }
+  if ((low <= 3) && (high >= 3)) { nbytes += print_sprint(buf+nbytes,3,last,format); last = 3; }
+  if ((low <= 5) && (high >= 5)) { nbytes += print_sprint(buf+nbytes,5,last,format); last = 5; }
+  if (nbytes > 0)  ok = write_all(fd, buf, nbytes);
   if (low < 7) low = 7;
 
-  if (low <= high) {
-    unsigned char* segment;
+  if (ok && low <= high) {
     UV seg_base, seg_low, seg_high;
-    void* ctx = start_segment_primes(low, high, &segment);
-    while (next_segment_primes(ctx, &seg_base, &seg_low, &seg_high)) {
-      START_DO_FOR_EACH_SIEVE_PRIME( segment, seg_base, seg_low, seg_high )
-        bend += my_sprint(bend,p);
-        if (bend-buf > 8000) { bend = write_buf(fd, buf, bend); }
-      END_DO_FOR_EACH_SIEVE_PRIME
+    void* ctx = start_segment_work(low, high, PRINT_SEGMENT_BYTES,
+                                   _print_out_bytes(high, format),
+                                   _print_segment, &format);
+    while (ok && next_segment_primes(ctx, &seg_base, &seg_low, &seg_high)) {
+      print_head_t* h = (print_head_t*) segment_work_output(ctx);
+      unsigned char* data = PRINT_DATA(h);
+      UV n = h->nbytes;
+      if (n == 0)  continue;
+      if (format == PRINT_PRIMES_DELTA) {
+        /* Replace the first delta, which is from 0, with the real one. */
+        UV first = 0, i;
+        for (i = 0; i < h->firstbytes; i++)
+          first = (first << 7) | (data[i] & 0x7F);
+        data += h->firstbytes;
+        n -= h->firstbytes;
+        i = ber_sprint(buf, first-last);
+        data -= i;
+        n += i;
+        memcpy(data, buf, i);
+        last = h->last;
+      }
+      ok = write_all(fd, data, n);
     }
     end_segment_primes(ctx);
   }
-  if (bend > buf) { bend = write_buf(fd, buf, bend); }
+  if (!ok)  croak("print_primes write error");
 }
 
 
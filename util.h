@@ -7,6 +7,14 @@ extern int  _XS_get_verbose(void);
 extern void _XS_set_verbose(int v);
 extern int  _XS_get_callgmp(void);
 extern void _XS_set_callgmp(int v);
+extern int  _XS_get_threads(void);
+extern void _XS_set_threads(int n);
+extern void _XS_detect_cache_sizes(void);
+extern UV   _XS_get_cache_size(int level);
+extern void _XS_set_cache_size(int level, UV size);
+extern UV   _XS_get_segment_size(void);
+extern void _XS_set_segment_size(UV size);
+extern UV   _XS_get_l2_scale(void);
 
 extern int _XS_is_prime(UV x);
 extern UV  next_prime(UV x);
@@ -14,6 +22,9 @@ extern UV  prev_prime(UV x);
 
 extern UV  _XS_prime_count(UV low, UV high);
 extern UV  nth_prime(UV x);
+  /* Set out[i] for each of the n values, sharing the work between them. */
+extern void prime_count_multi(UV n, const UV* x, UV* counts);
+extern void nth_prime_multi(UV n, const UV* k, UV* primes);
 extern UV  nth_prime_upper(UV x);
 extern UV  nth_prime_lower(UV x);
 extern UV  nth_prime_approx(UV x);
@@ -31,7 +42,10 @@ extern int is_ramanujan_prime(UV n);
 extern UV ramanujan_prime_count_lower(UV n);
 extern UV ramanujan_prime_count_upper(UV n);
 extern int sum_primes(UV low, UV high, UV *sum);
-extern void print_primes(UV low, UV high, int fd);
+#define PRINT_PRIMES_TEXT   0   /* one decimal number per line */
+#define PRINT_PRIMES_LE64   1   /* 64-bit little-endian integers */
+#define PRINT_PRIMES_DELTA  2   /* differences, in Perl's pack "w" format */
+extern void print_primes(UV low, UV high, int fd, int format);
 
 extern int powerof(UV n);
 extern int is_power(UV n, UV a);
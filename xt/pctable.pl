@@ -0,0 +1,51 @@
+#!/usr/bin/env perl
+use strict;
+use warnings;
+$| = 1;
+
+# Build a prime count table and verify it.
+#
+#   perl -Mblib xt/pctable.pl pi.table 0 1e12 30000000
+#
+# The table is written unless the file exists.  Every checkpoint is then
+# compared to an LMO count, or one in every <step> if given, and
+# random prime_count and nth_prime values in the table are checked.
+
+use Math::Prime::Util qw/:all/;
+use Time::HiRes qw/time/;
+
+my($file, $lo, $hi, $interval, $step) = @ARGV;
+die "Usage: $0 file lo hi [interval [step]]\n" unless defined $hi;
+$_ = sprintf("%.0f", $_) for grep { /e/i } ($lo, $hi);
+$interval = 30_000_000 unless defined $interval;
+$step = 1 unless defined $step;
+
+if (!-e $file) {
+  my $t = time;
+  prime_count_table_save($file, $lo, $hi, $interval) or die "Could not write $file\n";
+  printf "Wrote %s (%d bytes) in %.1fs\n", $file, -s $file, time - $t;
+}
+my $last = prime_count_table_load($file) or die "Could not load $file\n";
+
+my $first = $interval * int(($lo + $interval - 1) / $interval);
+my $ncheck = ($last - $first) / $interval + 1;
+print "Checkpoints $first to $last, $ncheck of them\n";
+
+my $nbad = 0;
+for (my $i = 0; $i < $ncheck; $i += $step) {
+  my $x = $first + $i * $interval;
+  my($got, $exp) = (prime_count($x), Math::Prime::Util::_XS_LMO_easy_pi($x));
+  if ($got != $exp) { $nbad++; print "pi($x) table $got, LMO $exp\n"; }
+  print "." if ($i / $step) % 1000 == 999;
+}
+print "\n";
+
+for (1 .. 100) {
+  my $n = $first + int(rand($last - $first + 1));
+  my($got, $exp) = (prime_count($n), Math::Prime::Util::_XS_LMO_easy_pi($n));
+  if ($got != $exp) { $nbad++; print "prime_count($n) $got, LMO $exp\n"; }
+  my $p = nth_prime($got);
+  if ($p > $n || next_prime($p) <= $n) { $nbad++; print "nth_prime($got) $p for $n\n"; }
+}
+print $nbad ? "$nbad BAD\n" : "ok\n";
+exit($nbad ? 1 : 0);